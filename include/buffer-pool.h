@@ -0,0 +1,73 @@
+#ifndef NETWORK_MONITOR_BUFFER_POOL_H
+#define NETWORK_MONITOR_BUFFER_POOL_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Pool of reusable message buffers.
+ *
+ *  A released buffer keeps its capacity, so a stream of messages of similar
+ *  size only allocates until the pool is warm. Buffers whose ownership passes
+ *  to the user are simply not released.
+ *
+ *  This class is thread-safe.
+ */
+class BufferPool {
+public:
+    /*! \brief Default number of buffers kept in the pool.
+     */
+    static constexpr size_t kDefaultMaxBuffers {64};
+
+    /*! \brief Default capacity above which a released buffer is freed.
+     */
+    static constexpr size_t kDefaultMaxBufferCapacity {1024 * 1024};
+
+    /*! \brief Construct an empty pool.
+     *
+     *  \param maxBuffers        Released buffers beyond this number are freed.
+     *  \param maxBufferCapacity Released buffers larger than this are freed,
+     *                           so that one large message does not pin its
+     *                           memory forever.
+     */
+    explicit BufferPool(
+        const size_t maxBuffers = kDefaultMaxBuffers,
+        const size_t maxBufferCapacity = kDefaultMaxBufferCapacity
+    );
+
+    /*! \brief Get an empty buffer with room for at least `size` bytes.
+     */
+    std::string Acquire(
+        const size_t size
+    );
+
+    /*! \brief Return a buffer to the pool.
+     *
+     *  Buffers that do not own heap memory are ignored.
+     */
+    void Release(
+        std::string&& buffer
+    );
+
+    /*! \brief Get the number of buffers in the pool.
+     */
+    size_t GetNBuffers() const;
+
+    /*! \brief Get the number of `Acquire` calls that had to allocate.
+     */
+    size_t GetNAllocations() const;
+
+private:
+    size_t maxBuffers_ {kDefaultMaxBuffers};
+    size_t maxBufferCapacity_ {kDefaultMaxBufferCapacity};
+
+    mutable std::mutex mutex_ {};
+    std::vector<std::string> buffers_ {};
+    size_t nAllocations_ {0};
+};
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_BUFFER_POOL_H
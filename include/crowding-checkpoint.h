@@ -0,0 +1,48 @@
+#ifndef NETWORK_MONITOR_CROWDING_CHECKPOINT_H
+#define NETWORK_MONITOR_CROWDING_CHECKPOINT_H
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Save the passenger count of every station to a checkpoint file.
+ *
+ *  The passenger counts are indexed by station handle. The checkpoint is
+ *  written to a temporary file through a memory mapping and then renamed
+ *  over the destination, so that a crash never leaves a partial checkpoint
+ *  behind.
+ *
+ *  \param layoutHash A hash of the network layout the counts refer to, as
+ *                    returned by `TransportNetwork::GetLayoutHash`.
+ *
+ *  \returns false if the checkpoint could not be written. In this case, any
+ *           previous checkpoint at the same path is left untouched.
+ */
+bool WriteCrowdingCheckpoint(
+    const std::filesystem::path& file,
+    const std::uint64_t layoutHash,
+    const std::vector<long long int>& passengerCounts
+);
+
+/*! \brief Load the passenger count of every station from a checkpoint file.
+ *
+ *  The file is memory-mapped and validated before any count is copied out.
+ *
+ *  \param layoutHash The hash of the current network layout. Checkpoints
+ *                    saved for a different layout are rejected.
+ *
+ *  \returns false if the file does not exist, is corrupted, or was saved for a
+ *           different network layout. In this case, `passengerCounts` is left
+ *           untouched.
+ */
+bool ReadCrowdingCheckpoint(
+    const std::filesystem::path& file,
+    const std::uint64_t layoutHash,
+    std::vector<long long int>& passengerCounts
+);
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_CROWDING_CHECKPOINT_H
@@ -0,0 +1,205 @@
+#ifndef NETWORK_MONITOR_CROWDING_TIME_SERIES_H
+#define NETWORK_MONITOR_CROWDING_TIME_SERIES_H
+
+#include "transport-network.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Passenger count recorded at a station at a point in time.
+ *
+ *  Timestamps are expressed in microseconds since the Unix epoch.
+ */
+struct CrowdingSample {
+    std::int64_t timestampUs {0};
+    long long int passengerCount {0};
+
+    bool operator==(const CrowdingSample& other) const;
+};
+
+/*! \brief Compressed in-memory history of the crowding of every station.
+ *
+ *  The store keeps at most one sample per station per resolution interval:
+ *  Multiple passenger events in the same interval overwrite each other, and
+ *  the sample timestamp is the start of the interval.
+ *
+ *  Samples are appended to fixed-size blocks, one chain of blocks per station.
+ *  The first sample of a block is stored verbatim. Subsequent samples store
+ *  the delta-of-delta of their timestamp and the XOR of their (zigzag-encoded)
+ *  value with the previous one, both as varints. With a 1-minute resolution,
+ *  a full day of history costs a few kilobytes per station.
+ *
+ *  Blocks that only contain samples older than the retention window are
+ *  dropped as new samples come in.
+ *
+ *  This class is not thread-safe: Concurrent reads are allowed, but they must
+ *  not overlap with a call to `Record`.
+ */
+class CrowdingTimeSeries {
+public:
+    /*! \brief Construct an empty store.
+     *
+     *  \param nStations    Number of stations to track. Stations are identified
+     *                      by their `StationHandle`.
+     *  \param resolution   Minimum distance between two samples of the same
+     *                      station.
+     *  \param retention    How much history to keep, relative to the most
+     *                      recent sample of a station.
+     */
+    CrowdingTimeSeries(
+        const size_t nStations = 0,
+        const std::chrono::microseconds resolution = std::chrono::minutes(1),
+        const std::chrono::microseconds retention = std::chrono::hours(24)
+    );
+
+    /*! \brief Get the number of tracked stations.
+     */
+    size_t GetNStations() const;
+
+    /*! \brief Record the passenger count of a station at a point in time.
+     *
+     *  Samples that are older than the latest one for the station are folded
+     *  into the latest resolution interval, so that the series stays ordered.
+     *
+     *  \returns false if the station handle is out of range.
+     */
+    bool Record(
+        const StationHandle station,
+        const std::int64_t timestampUs,
+        const long long int passengerCount
+    );
+
+    /*! \brief Move the history of each station to a new station handle.
+     *
+     *  Use this when the network is rebuilt and station handles change.
+     *
+     *  \param newHandles   The new handle of each station, indexed by its
+     *                      current handle. Stations mapped to
+     *                      `kInvalidStationHandle`, or to a handle out of
+     *                      range, lose their history.
+     *  \param nStations    Number of stations to track from now on. New
+     *                      stations start with an empty history.
+     */
+    void Remap(
+        const std::vector<StationHandle>& newHandles,
+        const size_t nStations
+    );
+
+    /*! \brief Get all the samples of a station in the [from, to] time range.
+     *
+     *  \returns An empty vector if the station handle is out of range.
+     */
+    std::vector<CrowdingSample> GetRange(
+        const StationHandle station,
+        const std::int64_t fromUs,
+        const std::int64_t toUs
+    ) const;
+
+    /*! \brief Get the passenger count of a station at regular intervals.
+     *
+     *  The returned samples are at times from, from + step, from + 2 * step, ...
+     *  up to and including `to`. The passenger count at a time is the one of
+     *  the latest sample at or before that time. Times before the first
+     *  available sample are skipped.
+     *
+     *  \returns An empty vector if the station handle is out of range, or if
+     *           the step is not positive.
+     */
+    std::vector<CrowdingSample> GetDownsampled(
+        const StationHandle station,
+        const std::int64_t fromUs,
+        const std::int64_t toUs,
+        const std::int64_t stepUs
+    ) const;
+
+    /*! \brief Get the passenger count of every station at a point in time.
+     *
+     *  Stations are scanned in parallel. Stations with no sample at or before
+     *  the requested time have a passenger count of 0.
+     *
+     *  \param nThreads Number of worker threads. If 0, we use the hardware
+     *                  concurrency.
+     *
+     *  \returns A vector indexed by station handle.
+     */
+    std::vector<long long int> GetNetworkLoadAt(
+        const std::int64_t timestampUs,
+        const size_t nThreads = 0
+    ) const;
+
+    /*! \brief Get the memory used by the samples of a station, in bytes.
+     */
+    size_t GetMemoryUsage(
+        const StationHandle station
+    ) const;
+
+    /*! \brief Get the memory used by the whole store, in bytes.
+     */
+    size_t GetMemoryUsage() const;
+
+private:
+    // Fixed size of the compressed payload of a block, in bytes.
+    static constexpr size_t kBlockSize {256};
+
+    // Worst case for a single encoded sample: two 10-byte varints.
+    static constexpr size_t kMaxSampleSize {20};
+
+    struct Block {
+        // The first sample is stored uncompressed.
+        std::int64_t firstTimestampUs {0};
+        long long int firstPassengerCount {0};
+
+        // Encoder state, which we also use to skip blocks in range queries.
+        std::int64_t lastTimestampUs {0};
+        std::int64_t lastDeltaUs {0};
+        long long int lastPassengerCount {0};
+
+        std::uint16_t nBytes {0};
+        std::uint16_t nSamples {0};
+        std::array<std::uint8_t, kBlockSize> data {};
+    };
+
+    struct Series {
+        std::deque<Block> blocks {};
+
+        // The sample for the current resolution interval. We only compress it
+        // once the interval is over.
+        bool hasPending {false};
+        CrowdingSample pending {};
+    };
+
+    std::int64_t resolutionUs_ {0};
+    std::int64_t retentionUs_ {0};
+    std::vector<Series> series_ {};
+
+    // Append a sample to the compressed blocks of a series.
+    void Append(
+        Series& series,
+        const CrowdingSample& sample
+    );
+
+    // Call the visitor on every sample of a series, in time order, until the
+    // visitor returns false. Blocks entirely before fromUs are skipped.
+    template <typename Visitor>
+    void Visit(
+        const Series& series,
+        const std::int64_t fromUs,
+        Visitor&& visitor
+    ) const;
+
+    // Find the latest sample at or before a time.
+    bool GetSampleAt(
+        const Series& series,
+        const std::int64_t timestampUs,
+        CrowdingSample& sample
+    ) const;
+};
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_CROWDING_TIME_SERIES_H
@@ -1,13 +1,21 @@
 #ifndef WEBSOCKET_CLIENT_FILE_DOWNLOADER_H
 #define WEBSOCKET_CLIENT_FILE_DOWNLOADER_H
 
+#include <boost/asio.hpp>
+
 #include <nlohmann/json.hpp>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <string>
+#include <thread>
 
 namespace NetworkMonitor {
 
 /*! \brief Download a file from a remote HTTPS URL.
+ *
+ *  The server may send the file gzip-compressed. The file is always saved
+ *  uncompressed.
  *
  *  \param destination The full path and filename of the output file. The path
  *                     to the file must exist.
@@ -20,6 +28,87 @@ bool DownloadFile(
     const std::filesystem::path& caCertFile = {}
 );
 
+/*! \brief Download a file from a remote HTTPS URL into memory.
+ *
+ *  The server may send the file gzip-compressed. `content` is always the
+ *  uncompressed file.
+ *
+ *  \returns false if the file could not be downloaded. In this case, `content`
+ *           is left untouched.
+ */
+bool DownloadFileToMemory(
+    const std::string& fileUrl,
+    std::string& content,
+    const std::filesystem::path& caCertFile = {}
+);
+
+/*! \brief Handler for `FetchFileAsync`.
+ *
+ *  \param ok      false if the file could not be downloaded.
+ *  \param content The file content.
+ */
+using FetchFileHandler = std::function<
+    void (bool ok, std::string&& content)
+>;
+
+/*! \brief Download a file from a remote HTTPS URL into memory, without
+ *         blocking the caller.
+ *
+ *  The transfer runs on a background thread, while the I/O context keeps
+ *  serving its other operations. The handler is then posted to the I/O
+ *  context. The I/O context does not run out of work until this happens.
+ *
+ *  \returns the background thread. The caller must join it before the I/O
+ *           context is destroyed.
+ */
+std::thread FetchFileAsync(
+    boost::asio::io_context& ioc,
+    const std::string& fileUrl,
+    const std::filesystem::path& caCertFile,
+    FetchFileHandler onFetched
+);
+
+/*! \brief Local copy of a file downloaded with `DownloadFileCached`.
+ */
+struct CachedDownload {
+    /*! \brief The up-to-date local copy of the file.
+     */
+    std::filesystem::path file {};
+
+    /*! \brief The hash of the file content, as returned by `HashFile`.
+     */
+    std::uint64_t contentHash {0};
+
+    /*! \brief false if the server confirmed that the cached copy was still
+     *         up to date, so nothing was downloaded.
+     */
+    bool downloaded {false};
+};
+
+/*! \brief Download a file from a remote HTTPS URL into a cache directory.
+ *
+ *  If the cache directory already has a copy of the file, the request carries
+ *  the `ETag` and `Last-Modified` validators of that copy. When the server
+ *  answers 304 Not Modified, the cached copy is kept and nothing is
+ *  downloaded. The server may send the file gzip-compressed.
+ *
+ *  Next to the file, the cache directory holds a `<file>.meta` JSON file with
+ *  the validators and the content hash.
+ *
+ *  \param cacheDirectory The cache directory. It is created if needed.
+ *  \param result         Set to the cached copy of the file, on success.
+ *  \param caCertFile     The path to a cacert.pem file to perform certificate
+ *                        verification in an HTTPS connection.
+ *
+ *  \returns false if the file could not be downloaded or revalidated.
+ */
+bool DownloadFileCached(
+    const std::string& fileUrl,
+    const std::filesystem::path& cacheDirectory,
+    CachedDownload& result,
+    const std::filesystem::path& caCertFile = {}
+);
+
 /*! \brief Parse a local file into a JSON object.
  *
  *  \param source The path to the JSON file to load and parse.
@@ -0,0 +1,115 @@
+#ifndef NETWORK_MONITOR_MESSAGE_DECODERS_H
+#define NETWORK_MONITOR_MESSAGE_DECODERS_H
+
+#include "transport-network.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Fields of a passenger event message, as views into the message.
+ *
+ *  The views are only valid as long as the original message buffer is alive.
+ */
+struct PassengerEventMessage {
+    std::string_view stationId {};
+    PassengerEvent::Type type {PassengerEvent::Type::In};
+    std::string_view datetime {};
+};
+
+/*! \brief Fields of a quiet-route request, as views into the message.
+ *
+ *  The views are only valid as long as the original message buffer is alive.
+ */
+struct QuietRouteRequestMessage {
+    std::string_view startStationId {};
+    std::string_view endStationId {};
+};
+
+/*! \brief Decode a passenger event message without building a JSON object.
+ *
+ *  This decoder only supports the message shape we receive from the network
+ *  events feed: A flat JSON object with string values and no escape
+ *  sequences. Unknown keys are ignored. It does not allocate.
+ *
+ *  \returns false if the message has a different shape or if a required field
+ *           is missing. This does not mean that the message is invalid JSON.
+ */
+bool DecodePassengerEventMessage(
+    const std::string_view message,
+    PassengerEventMessage& dst
+);
+
+/*! \brief Decode a quiet-route request without building a JSON object.
+ *
+ *  This decoder has the same limitations as `DecodePassengerEventMessage`.
+ *
+ *  \returns false if the message has a different shape or if a required field
+ *           is missing. This does not mean that the message is invalid JSON.
+ */
+bool DecodeQuietRouteRequestMessage(
+    const std::string_view message,
+    QuietRouteRequestMessage& dst
+);
+
+/*! \brief Parse a passenger event message.
+ *
+ *  We try the schema-specific decoder first and only fall back to a full JSON
+ *  parser for messages with an unusual formatting.
+ *
+ *  \returns false if the message is not a valid passenger event.
+ */
+bool ParsePassengerEvent(
+    const std::string_view message,
+    PassengerEvent& dst
+);
+
+/*! \brief Parse a passenger event message into its compact representation.
+ *
+ *  This is the ingestion fast path: We decode the message in place, parse the
+ *  datetime with `ParseIso8601Timestamp` and look up the station handle in
+ *  the network. Messages with an unusual formatting fall back to a full JSON
+ *  parser.
+ *
+ *  If the station is not in the network, the message is still parsed, but
+ *  the record station handle is `kInvalidStationHandle`.
+ *
+ *  \returns false if the message is not a valid passenger event.
+ */
+bool ParsePassengerEvent(
+    const std::string_view message,
+    const TransportNetwork& network,
+    PassengerEventRecord& dst
+);
+
+/*! \brief Parse an ISO 8601 UTC datetime into microseconds since the Unix
+ *         epoch.
+ *
+ *  The `YYYY-MM-DDTHH:MM:SS.ffffffZ` layout used by the network events feed is
+ *  parsed by a fixed-format parser that does not allocate. Other layouts fall
+ *  back to `boost::posix_time::from_iso_extended_string`.
+ *
+ *  \returns false if the datetime is not valid.
+ */
+bool ParseIso8601Timestamp(
+    const std::string_view datetime,
+    std::int64_t& timestampUs
+);
+
+/*! \brief Parse a quiet-route request.
+ *
+ *  We try the schema-specific decoder first and only fall back to a full JSON
+ *  parser for messages with an unusual formatting.
+ *
+ *  \returns false if the message is not a valid quiet-route request.
+ */
+bool ParseQuietRouteRequest(
+    const std::string_view message,
+    Id& startStationId,
+    Id& endStationId
+);
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_MESSAGE_DECODERS_H
@@ -1,8 +1,16 @@
 #ifndef NETWORK_MONITOR_NETWORK_MONITOR_H
 #define NETWORK_MONITOR_NETWORK_MONITOR_H
 
+#include "crowding-checkpoint.h"
+#include "crowding-time-series.h"
 #include "file-downloader.h"
+#include "message-decoders.h"
+#include "network-snapshot.h"
+#include "passenger-event-batcher.h"
+#include "passenger-event-journal.h"
+#include "passenger-event-pipeline.h"
 #include "stomp-client.h"
+#include "stomp-frame.h"
 #include "stomp-server.h"
 #include "test-server-certificate.h"
 #include "transport-network.h"
@@ -15,16 +23,26 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 #include <ostream>
+#include <shared_mutex>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace NetworkMonitor {
 
@@ -44,6 +62,19 @@ struct NetworkMonitorConfig {
     double quietRouteMaxSlowdownPc {0.1};
     double quietRouteMinQuietnessPc {0.1};
     size_t quietRouteMaxNPaths {20};
+    size_t crowdedStationsMaxN {100};
+    std::chrono::seconds crowdingHistoryResolution {60};
+    std::chrono::hours crowdingHistoryRetention {24};
+    std::filesystem::path crowdingCheckpointFile {};
+    std::chrono::seconds crowdingCheckpointInterval {60};
+    std::filesystem::path passengerEventJournalDirectory {};
+    size_t ingestionMaxBatchSize {1024};
+    std::chrono::microseconds ingestionMaxLatency {1000};
+    size_t ingestionRingCapacity {0};
+    BackpressurePolicy ingestionBackpressurePolicy {BackpressurePolicy::kBlock};
+    std::filesystem::path networkLayoutCacheDirectory {};
+    bool networkLayoutAsyncFetch {false};
+    std::chrono::seconds networkLayoutReloadInterval {0};
 };
 
 /*! \brief Error codes for the Metro Network Monitor process.
@@ -52,6 +83,8 @@ enum class NetworkMonitorError {
     kOk = 0,
     kUndefinedError,
     kCouldNotConnectToStompClient,
+    kCouldNotOpenPassengerEventJournal,
+    kCouldNotParseCrowdedStationsRequest,
     kCouldNotParsePassengerEvent,
     kCouldNotParseQuietRouteRequest,
     kCouldNotRecordPassengerEvent,
@@ -76,10 +109,31 @@ std::ostream& operator<<(
 
 /*! \brief Convert `NetworkMonitorError` to string.
  */
-std::string ToString(
+std::string_view ToString(
     const NetworkMonitorError& m
 );
 
+} // namespace NetworkMonitor
+
+/*! \brief fmt formatter for `NetworkMonitorError`.
+ */
+template <>
+struct fmt::formatter<NetworkMonitor::NetworkMonitorError>:
+    fmt::formatter<fmt::string_view> {
+    template <typename FormatContext>
+    auto format(
+        const NetworkMonitor::NetworkMonitorError& error,
+        FormatContext& ctx
+    )
+    {
+        const auto name {NetworkMonitor::ToString(error)};
+        return formatter<fmt::string_view>::format({name.data(), name.size()},
+                                                   ctx);
+    }
+};
+
+namespace NetworkMonitor {
+
 /*! \brief Metro Network Monitor
  *
  *  \tparam WsClient Type compatible with WebSocketClient.
@@ -92,13 +146,28 @@ public:
     NetworkMonitor() = default;
 
     /*! \brief Destructor.
+     *
+     *  Waits for the background network layout fetch or reload to complete,
+     *  if any.
      */
-    ~NetworkMonitor() = default;
+    ~NetworkMonitor()
+    {
+        if (layoutFetchThread_.joinable()) {
+            layoutFetchThread_.join();
+        }
+        if (reloadThread_.joinable()) {
+            reloadThread_.join();
+        }
+    }
 
     /*! \brief Setup the Metro Network Monitor.
      *
      *  This function only sets up the connection and performs error checks.
      *  It does not run the STOMP client.
+     *
+     *  With `networkLayoutAsyncFetch`, the network layout is downloaded and
+     *  loaded in the background instead. Errors in this step are reported by
+     *  `GetLastErrorCode` once the I/O context runs.
      */
     NetworkMonitorError Configure(
         const NetworkMonitorConfig& config
@@ -120,53 +189,43 @@ public:
             return NetworkMonitorError::kMissingNetworkLayoutFile;
         }
 
-        // Download the network-layout.json file if the config does not contain
-        // a local filename, then parse the file.
-        auto networkLayoutFile {config.networkLayoutFile.empty() ?
-            std::filesystem::temp_directory_path() / "network-layout.json" :
-            config.networkLayoutFile
+        configureStart_ = std::chrono::steady_clock::now();
+        config_ = config;
+
+        // Network representation
+        // We can download and parse the network layout file in the background
+        // while the STOMP client connects and the STOMP server starts.
+        // Passenger events and client requests wait until the network is
+        // ready.
+        const bool fetchLayoutAsync {
+            config.networkLayoutAsyncFetch &&
+            config.networkLayoutFile.empty() &&
+            config.networkLayoutCacheDirectory.empty()
         };
-        if (config.networkLayoutFile.empty()) {
-            spdlog::info(
-                "NetworkMonitor: Downloading the network layout file to {}",
-                networkLayoutFile
-            );
+        if (fetchLayoutAsync) {
             const std::string fileUrl {
                 "https://" + config.networkEventsUrl + networkLayoutEndpoint_
             };
-            bool downloaded {DownloadFile(
+            spdlog::info("NetworkMonitor: Fetching {} in the background",
+                         fileUrl);
+            layoutFetchThread_ = FetchFileAsync(
+                ioc_,
                 fileUrl,
-                networkLayoutFile,
-                config.caCertFile
-            )};
-            if (!downloaded) {
-                spdlog::error("NetworkMonitor: Could not download {}. Exiting",
-                              fileUrl);
-                return NetworkMonitorError::kFailedNetworkLayoutFileDownload;
+                config.caCertFile,
+                [this](auto ok, auto&& content) {
+                    OnNetworkLayoutFetched(ok, std::move(content));
+                }
+            );
+        } else {
+            bool loaded {false};
+            auto ec {LoadNetworkLayout(config, network_, loaded)};
+            if (ec != NetworkMonitorError::kOk) {
+                return ec;
             }
-        }
-        spdlog::info("NetworkMonitor: Loading the network layout file");
-        auto parsed = ParseJsonFile(networkLayoutFile);
-        if (parsed.empty()) {
-            spdlog::error("NetworkMonitor: Could not parse {}. Exiting",
-                          networkLayoutFile);
-            return NetworkMonitorError::kFailedNetworkLayoutFileParsing;
-        }
-
-        // Network representation
-        spdlog::info("NetworkMonitor: Constructing the network representation");
-        try {
-            bool networkLoaded {network_.FromJson(std::move(parsed))};
-            if (!networkLoaded) {
-                spdlog::error("NetworkMonitor: Could not construct the "
-                              "TransportNetwork. Exiting");
-                return NetworkMonitorError::kFailedTransportNetworkConstruction;
+            ec = SetUpNetworkState();
+            if (ec != NetworkMonitorError::kOk) {
+                return ec;
             }
-        } catch (const std::exception& e) {
-            spdlog::error("NetworkMonitor: Exception while constructing the "
-                          "TransportNetwork: {}. Exiting",
-                          e.what());
-            return NetworkMonitorError::kFailedTransportNetworkConstruction;
         }
 
         // STOMP client
@@ -208,8 +267,8 @@ public:
             [this](auto ec, auto id) {
                 OnQuietRouteClientConnect(ec, id);
             },
-            [this](auto ec, auto id, auto dest, auto reqId, auto&& msg) {
-                OnQuietRouteClientMessage(ec, id, dest, reqId, std::move(msg));
+            [this](auto ec, auto id, auto&& frame) {
+                OnQuietRouteClientMessage(ec, id, std::move(frame));
             },
             [this](auto ec, auto id) {
                 OnQuietRouteClientDisconnect(ec, id);
@@ -226,7 +285,6 @@ public:
         // Note: At this stage nothing runs until someone calls the run()
         //       function on the I/O context object.
         spdlog::info("NetworkMonitor: Successfully configured");
-        config_ = config;
         return NetworkMonitorError::kOk;
     }
 
@@ -238,7 +296,10 @@ public:
     {
         spdlog::info("NetworkMonitor: Running");
         lastErrorCode_ = NetworkMonitorError::kOk;
+        StartPassengerEventPipeline();
         ioc_.run();
+        FlushPassengerEvents();
+        SaveCrowdingCheckpoint();
     }
 
     /*! \brief Run the I/O context for a maximum amount of time.
@@ -255,7 +316,10 @@ public:
     {
         spdlog::info("NetworkMonitor: Running for {}", runFor);
         lastErrorCode_ = NetworkMonitorError::kOk;
+        StartPassengerEventPipeline();
         ioc_.run_for(runFor);
+        FlushPassengerEvents();
+        SaveCrowdingCheckpoint();
     }
 
     /*! \brief Stop any computation.
@@ -270,6 +334,11 @@ public:
         // know what was the last error code before the network monitor was
         // stoppped.
         spdlog::info("NetworkMonitor: Stopping");
+        std::shared_lock<std::shared_mutex> lock {networkMutex_};
+        spdlog::info("NetworkMonitor: Crowding history memory usage: {} B "
+                     "({} stations)",
+                     crowdingHistory_.GetMemoryUsage(),
+                     crowdingHistory_.GetNStations());
         ioc_.stop();
     }
 
@@ -292,6 +361,40 @@ public:
         return lastTravelRoute_;
     }
 
+    /*! \brief Get the latest list of crowded stations sent to a client.
+     *
+     *  This is the last crowded stations list calculated — if any.
+     */
+    std::vector<StationCrowding> GetLastCrowdedStations() const
+    {
+        return lastCrowdedStations_;
+    }
+
+    /*! \brief Access the crowding history of the network stations.
+     *
+     *  The history is indexed by station handle, as returned by
+     *  `TransportNetwork::GetStationHandle`.
+     */
+    const CrowdingTimeSeries& GetCrowdingHistory() const
+    {
+        return crowdingHistory_;
+    }
+
+    /*! \brief Get the metrics of the passenger event ingestion stage.
+     *
+     *  \throws std::runtime_error if the network monitor is not configured.
+     */
+    IngestionMetrics GetIngestionMetrics() const
+    {
+        if (pipeline_ != nullptr) {
+            return pipeline_->GetMetrics();
+        }
+        if (batcher_ == nullptr) {
+            throw std::runtime_error("NetworkMonitor is not configured");
+        }
+        return batcher_->GetMetrics();
+    }
+
     /*! \brief Access the internal network representation.
      *
      *  \returns a reference to the internal `TransportNetwork` object instance.
@@ -321,6 +424,44 @@ public:
         return connectedClients_;
     }
 
+    /*! \brief Reload the network layout without stopping the monitor.
+     *
+     *  The new network is loaded in a background thread, from the same source
+     *  used by `Configure`. It is then swapped in on the I/O thread, between
+     *  two client requests: Requests being served finish on the old network.
+     *  Passenger counts and crowding history are carried over by station ID.
+     *  Stations that are no longer in the layout lose them.
+     *
+     *  Reloads also run every `networkLayoutReloadInterval`, when the local
+     *  layout file or the cached download changed, and when a client sends a
+     *  message to `/reload-network`.
+     *
+     *  This function can be called from any thread. It does nothing if a
+     *  reload is already in progress. Errors are reported by
+     *  `GetLastErrorCode`, and the monitor keeps the old network.
+     */
+    void ReloadNetworkLayout()
+    {
+        boost::asio::post(ioc_, [this]() {
+            StartNetworkLayoutReload(true);
+        });
+    }
+
+    /*! \brief Get the number of times the network layout was reloaded.
+     */
+    size_t GetNNetworkReloads() const
+    {
+        return nNetworkReloads_;
+    }
+
+    /*! \brief Get how long the I/O thread was paused to swap the network in,
+     *         during the last reload.
+     */
+    std::chrono::microseconds GetLastNetworkReloadPause() const
+    {
+        return lastNetworkReloadPause_;
+    }
+
 private:
     // We maintain our own instance of the I/O and TLS contexts.
     boost::asio::io_context ioc_ {};
@@ -338,18 +479,56 @@ private:
 
     NetworkMonitorConfig config_ {};
 
+    // Background fetch of the network layout. Until the network is ready, we
+    // do not subscribe to passenger events and we hold client requests back.
+    std::thread layoutFetchThread_ {};
+    bool networkReady_ {false};
+    bool clientConnected_ {false};
+    std::vector<std::function<void ()>> pendingRequests_ {};
+    std::chrono::steady_clock::time_point configureStart_ {};
+    std::chrono::steady_clock::time_point networkReadyAt_ {};
+    std::chrono::steady_clock::time_point clientConnectedAt_ {};
+
+    // Network layout reloads. The new network is built in reloadThread_, one
+    // reload at a time, and swapped in on the I/O thread.
+    std::thread reloadThread_ {};
+    bool reloadInProgress_ {false};
+    boost::asio::steady_timer reloadTimer_ {ioc_};
+    std::filesystem::file_time_type layoutFileWriteTime_ {};
+    size_t nNetworkReloads_ {0};
+    std::chrono::microseconds lastNetworkReloadPause_ {0};
+
     TransportNetwork network_ {};
+    CrowdingTimeSeries crowdingHistory_ {};
+    std::uint64_t layoutHash_ {0};
+    boost::asio::steady_timer checkpointTimer_ {ioc_};
+    std::unique_ptr<PassengerEventJournal> journal_ {nullptr};
+    std::unique_ptr<PassengerEventBatcher> batcher_ {nullptr};
+    std::unique_ptr<PassengerEventPipeline> pipeline_ {nullptr};
+    std::vector<PassengerEventRecord> aggregatedEvents_ {};
+
+    // Guards the passenger counts and the crowding history, which the
+    // aggregation thread updates while the I/O thread serves requests. It
+    // also guards network_ itself, which a reload replaces.
+    mutable std::shared_mutex networkMutex_ {};
+
+    // Incremented every time network_ is replaced, which invalidates the
+    // station handles of the events parsed against the old network.
+    size_t networkGeneration_ {0};
 
     std::unordered_set<std::string> connectedClients_ {};
 
     NetworkMonitorError lastErrorCode_ {NetworkMonitorError::kUndefinedError};
     TravelRoute lastTravelRoute_ {};
+    std::vector<StationCrowding> lastCrowdedStations_ {};
 
     // Remote endpoints
     const std::string networkEventsEndpoint_ {"/network-events"};
     const std::string networkLayoutEndpoint_ {"/network-layout.json"};
     const std::string subscriptionDestination_ {"/passengers"};
     const std::string quietRouteDestination {"/quiet-route"};
+    const std::string crowdedStationsDestination_ {"/crowded-stations"};
+    const std::string reloadNetworkDestination_ {"/reload-network"};
 
     // Handlers
 
@@ -367,6 +546,21 @@ private:
             return;
         }
         spdlog::info("NetworkMonitor: STOMP client connected");
+        clientConnected_ = true;
+        clientConnectedAt_ = std::chrono::steady_clock::now();
+        if (!networkReady_) {
+            spdlog::info("NetworkMonitor: Waiting for the network layout "
+                         "before subscribing to {}",
+                         subscriptionDestination_);
+            lastErrorCode_ = Error::kOk;
+            return;
+        }
+        SubscribeToPassengerEvents();
+    }
+
+    void SubscribeToPassengerEvents()
+    {
+        using Error = NetworkMonitorError;
 
         // Subscribe to the passenger events
         spdlog::info("NetworkMonitor: Subscribing to {}",
@@ -376,14 +570,12 @@ private:
             [this](auto ec, auto&& id) {
                 OnSubscribe(ec, std::move(id));
             },
-            [this](auto ec, auto&& msg) {
-                OnNetworkEventsMessage(ec, std::move(msg));
+            [this](auto ec, auto&& frame) {
+                OnNetworkEventsMessage(ec, std::move(frame));
             }
         )};
         if (id.empty()) {
-            spdlog::error(
-                "NetworkMonitor: STOMP client subscription failed: {}", ec
-            );
+            spdlog::error("NetworkMonitor: STOMP client subscription failed");
             lastErrorCode_ = Error::kCouldNotSubscribeToPassengerEvents;
             client_->Close();
             server_->Stop();
@@ -412,20 +604,36 @@ private:
         } else {
             spdlog::info("NetworkMonitor: STOMP client subscribed to {}",
                          subscriptionDestination_);
+            const auto now {std::chrono::steady_clock::now()};
+            spdlog::info("NetworkMonitor: Ready in {} (network ready after {}, "
+                         "STOMP client connected after {})",
+                         GetTimeSinceConfigure(now),
+                         GetTimeSinceConfigure(networkReadyAt_),
+                         GetTimeSinceConfigure(clientConnectedAt_));
         lastErrorCode_ = Error::kOk;
         }
     }
 
     void OnNetworkEventsMessage(
         StompClientError ec,
-        std::string&& msg
+        StompFrame&& frame
     )
     {
         using Error = NetworkMonitorError;
-        PassengerEvent event {};
-        try {
-            event = nlohmann::json::parse(msg);
-        } catch (...) {
+
+        // The aggregation thread takes the message buffer. Otherwise, we parse
+        // the message in place and the frame buffer is reused.
+        if (pipeline_ != nullptr) {
+            if (!pipeline_->Push(std::move(frame).TakeBody())) {
+                spdlog::debug("NetworkMonitor: Passenger event ring is full");
+            }
+            lastErrorCode_ = Error::kOk;
+            return;
+        }
+
+        const auto msg {frame.GetBody()};
+        PassengerEventRecord event {};
+        if (!ParsePassengerEvent(msg, network_, event)) {
             spdlog::error(
                 "NetworkMonitor: Could not parse passenger event:\n{}{}",
                 std::setw(4), msg
@@ -433,9 +641,8 @@ private:
             lastErrorCode_ = Error::kCouldNotParsePassengerEvent;
             return;
         }
-        auto ok {network_.RecordPassengerEvent(event)};
         spdlog::debug("NetworkMonitor: Message:\n{}{}", std::setw(4), msg);
-        if (!ok) {
+        if (event.station == kInvalidStationHandle) {
             spdlog::error(
                 "NetworkMonitor: Could not record new passenger event:\n{}{}",
                 std::setw(4), msg
@@ -443,13 +650,102 @@ private:
             lastErrorCode_ = Error::kCouldNotRecordPassengerEvent;
             return;
         }
-        spdlog::debug(
-            "NetworkMonitor: New event: {}",
-            boost::posix_time::to_iso_extended_string(event.timestamp)
-        );
+
+        // The event is applied with the rest of its batch.
+        batcher_->Push(event);
         lastErrorCode_ = Error::kOk;
     }
 
+    // Runs in the aggregation thread. Error codes are handed back to the I/O
+    // thread.
+    void OnPassengerEventMessages(
+        std::vector<std::string>& messages
+    )
+    {
+        using Error = NetworkMonitorError;
+
+        // We parse the events under a shared lock, so that the I/O thread can
+        // still serve requests. If the network is reloaded before we apply
+        // them, their station handles are stale and we parse them again.
+        std::shared_lock<std::shared_mutex> readLock {networkMutex_};
+        const auto generation {networkGeneration_};
+        bool parsed {ParsePassengerEvents(messages, aggregatedEvents_)};
+        readLock.unlock();
+        std::unique_lock<std::shared_mutex> lock {networkMutex_};
+        if (networkGeneration_ != generation) {
+            parsed = ParsePassengerEvents(messages, aggregatedEvents_);
+        }
+        const bool recorded {ApplyPassengerEvents(aggregatedEvents_)};
+        lock.unlock();
+        if (!parsed || !recorded) {
+            const auto error {parsed ? Error::kCouldNotRecordPassengerEvent :
+                                       Error::kCouldNotParsePassengerEvent};
+            boost::asio::post(ioc_, [this, error]() {
+                lastErrorCode_ = error;
+            });
+        }
+    }
+
+    // Returns false if at least one message could not be parsed.
+    bool ParsePassengerEvents(
+        const std::vector<std::string>& messages,
+        std::vector<PassengerEventRecord>& events
+    ) const
+    {
+        bool ok {true};
+        events.clear();
+        for (const auto& message: messages) {
+            PassengerEventRecord event {};
+            if (!ParsePassengerEvent(message, network_, event)) {
+                spdlog::error(
+                    "NetworkMonitor: Could not parse passenger event:\n{}{}",
+                    std::setw(4), message
+                );
+                ok = false;
+                continue;
+            }
+            events.push_back(event);
+        }
+        return ok;
+    }
+
+    // Returns false if at least one event could not be recorded.
+    bool OnPassengerEventBatch(
+        const std::vector<PassengerEventRecord>& events
+    )
+    {
+        std::unique_lock<std::shared_mutex> lock {networkMutex_};
+        return ApplyPassengerEvents(events);
+    }
+
+    // Must be called with networkMutex_ held exclusively.
+    bool ApplyPassengerEvents(
+        const std::vector<PassengerEventRecord>& events
+    )
+    {
+        bool ok {true};
+        for (const auto& event: events) {
+            if (!network_.RecordPassengerEvent(event)) {
+                spdlog::error("NetworkMonitor: Could not record new passenger "
+                              "event at station {}",
+                              event.station);
+                ok = false;
+                continue;
+            }
+            crowdingHistory_.Record(
+                event.station,
+                event.timestampUs,
+                network_.GetPassengerCount(event.station)
+            );
+        }
+        if (journal_ != nullptr) {
+            journal_->Append(events);
+        }
+        spdlog::debug("NetworkMonitor: Applied a batch of {} events",
+                      events.size());
+        return ok;
+    }
+
     void OnQuietRouteClientConnect(
         StompServerError ec,
         const std::string& connectionId
@@ -464,29 +760,55 @@ private:
     void OnQuietRouteClientMessage(
         StompServerError ec,
         const std::string& connectionId,
-        const std::string& destination,
-        const std::string& requestId,
-        std::string&& message
+        StompFrame&& frame
     )
     {
-        using Error = NetworkMonitorError;
-        if (destination != quietRouteDestination) {
-            spdlog::error("NetworkMonitor: [{}] Unsupported destination: {}",
-                          connectionId, destination);
-            server_->Close(connectionId);
-            connectedClients_.erase(connectionId);
+        if (!networkReady_) {
+            pendingRequests_.push_back([
+                this, ec, connectionId, frame = std::move(frame)
+            ]() mutable {
+                OnQuietRouteClientMessage(ec, connectionId, std::move(frame));
+            });
+            return;
+        }
+
+        // The request is parsed in place, in the frame buffer.
+        const auto destination {
+            frame.GetHeaderValue(StompHeader::kDestination)
+        };
+        const std::string requestId {frame.GetHeaderValue(StompHeader::kId)};
+        const auto message {frame.GetBody()};
+        if (destination == quietRouteDestination) {
+            OnQuietRouteRequest(connectionId, requestId, message);
             return;
         }
+        if (destination == crowdedStationsDestination_) {
+            OnCrowdedStationsRequest(connectionId, requestId, message);
+            return;
+        }
+        if (destination == reloadNetworkDestination_) {
+            OnReloadNetworkRequest(connectionId, requestId);
+            return;
+        }
+        spdlog::error("NetworkMonitor: [{}] Unsupported destination: {}",
+                      connectionId, destination);
+        server_->Close(connectionId);
+        connectedClients_.erase(connectionId);
+    }
+
+    void OnQuietRouteRequest(
+        const std::string& connectionId,
+        const std::string& requestId,
+        const std::string_view message
+    )
+    {
+        using Error = NetworkMonitorError;
         spdlog::info("NetworkMonitor: [{}] New message to {}",
-                     connectionId, destination);
+                     connectionId, quietRouteDestination);
         spdlog::debug("NetworkMonitor: Message:\n{}{}", std::setw(4), message);
         Id startStationId {};
         Id endStationId {};
-        try {
-            auto messageJson = nlohmann::json::parse(message);
-            startStationId = messageJson.at("start_station_id").get<Id>();
-            endStationId = messageJson.at("end_station_id").get<Id>();
-        } catch (...) {
+        if (!ParseQuietRouteRequest(message, startStationId, endStationId)) {
             spdlog::error(
                 "NetworkMonitor: Could not parse quiet-route request:\n{}{}",
                 std::setw(4), message
@@ -496,6 +818,7 @@ private:
             lastErrorCode_ = Error::kCouldNotParseQuietRouteRequest;
             return;
         }
+        std::shared_lock<std::shared_mutex> lock {networkMutex_};
         auto travelRoute {network_.GetQuietTravelRoute(
             startStationId,
             endStationId,
@@ -503,6 +826,7 @@ private:
             config_.quietRouteMinQuietnessPc,
             config_.quietRouteMaxNPaths
         )};
+        lock.unlock();
         nlohmann::json travelRouteJson = travelRoute;
         server_->Send(
             connectionId,
@@ -515,6 +839,72 @@ private:
         lastTravelRoute_ = travelRoute;
     }
 
+    void OnCrowdedStationsRequest(
+        const std::string& connectionId,
+        const std::string& requestId,
+        const std::string_view message
+    )
+    {
+        using Error = NetworkMonitorError;
+        spdlog::info("NetworkMonitor: [{}] New message to {}",
+                     connectionId, crowdedStationsDestination_);
+        spdlog::debug("NetworkMonitor: Message:\n{}{}", std::setw(4), message);
+
+        // The number of stations is optional. We cap it to protect the server
+        // from clients asking for the whole network every second.
+        size_t nStations {config_.crowdedStationsMaxN};
+        try {
+            auto messageJson = nlohmann::json::parse(message);
+            if (messageJson.contains("n_stations")) {
+                nStations = messageJson.at("n_stations").get<size_t>();
+            }
+        } catch (...) {
+            spdlog::error(
+                "NetworkMonitor: Could not parse crowded-stations "
+                "request:\n{}{}",
+                std::setw(4), message
+            );
+            server_->Close(connectionId);
+            connectedClients_.erase(connectionId);
+            lastErrorCode_ = Error::kCouldNotParseCrowdedStationsRequest;
+            return;
+        }
+        std::shared_lock<std::shared_mutex> lock {networkMutex_};
+        auto stations {network_.GetMostCrowdedStations(
+            std::min(nStations, config_.crowdedStationsMaxN)
+        )};
+        lock.unlock();
+        nlohmann::json stationsJson = stations;
+        server_->Send(
+            connectionId,
+            crowdedStationsDestination_,
+            stationsJson.dump(),
+            nullptr,
+            requestId
+        );
+        lastErrorCode_ = Error::kOk;
+        lastCrowdedStations_ = std::move(stations);
+    }
+
+    void OnReloadNetworkRequest(
+        const std::string& connectionId,
+        const std::string& requestId
+    )
+    {
+        spdlog::info("NetworkMonitor: [{}] New message to {}",
+                     connectionId, reloadNetworkDestination_);
+        nlohmann::json response {};
+        response["reloading"] = StartNetworkLayoutReload(true);
+        server_->Send(
+            connectionId,
+            reloadNetworkDestination_,
+            response.dump(),
+            nullptr,
+            requestId
+        );
+        lastErrorCode_ = NetworkMonitorError::kOk;
+    }
+
     void OnQuietRouteClientDisconnect(
         StompServerError ec,
         const std::string& connectionId
@@ -534,6 +924,570 @@ private:
                       ec);
         lastErrorCode_ = NetworkMonitorError::kStompServerDisconnected;
     }
+
+    void StartPassengerEventPipeline()
+    {
+        if (pipeline_ != nullptr) {
+            pipeline_->Start();
+        }
+    }
+
+    // Apply the events still waiting in the ingestion stage, if the I/O
+    // context stopped before their batch was flushed.
+    void FlushPassengerEvents()
+    {
+        if (pipeline_ != nullptr) {
+            pipeline_->Stop();
+        }
+        if (batcher_ != nullptr) {
+            batcher_->Flush();
+        }
+    }
+
+    // Network layout
+
+    // Download the network layout file if needed, then load it into network.
+    // With onlyIfChanged, we do not load a local file or a cached download
+    // that did not change since the last load, and we set loaded to false.
+    NetworkMonitorError LoadNetworkLayout(
+        const NetworkMonitorConfig& config,
+        TransportNetwork& network,
+        bool& loaded,
+        const bool onlyIfChanged = false
+    )
+    {
+        loaded = false;
+        // Download the network-layout.json file if the config does not contain
+        // a local filename, then parse the file.
+        auto networkLayoutFile {config.networkLayoutFile.empty() ?
+            std::filesystem::temp_directory_path() / "network-layout.json" :
+            config.networkLayoutFile
+        };
+        // With a cache directory, we only download the file if it changed
+        // since the last download, and we keep a snapshot of the network next
+        // to it, so that we only parse the file again when it changed.
+        std::filesystem::path snapshotCacheFile {};
+        std::uint64_t layoutContentHash {0};
+        if (config.networkLayoutFile.empty() &&
+                !config.networkLayoutCacheDirectory.empty()) {
+            const std::string fileUrl {
+                "https://" + config.networkEventsUrl + networkLayoutEndpoint_
+            };
+            spdlog::info("NetworkMonitor: Revalidating the network layout "
+                         "file in {}",
+                         config.networkLayoutCacheDirectory);
+            CachedDownload download {};
+            bool downloaded {DownloadFileCached(
+                fileUrl,
+                config.networkLayoutCacheDirectory,
+                download,
+                config.caCertFile
+            )};
+            if (!downloaded) {
+                spdlog::error("NetworkMonitor: Could not download {}. Exiting",
+                              fileUrl);
+                return NetworkMonitorError::kFailedNetworkLayoutFileDownload;
+            }
+            if (download.downloaded) {
+                spdlog::info("NetworkMonitor: Downloaded a new network layout");
+            } else if (onlyIfChanged) {
+                return NetworkMonitorError::kOk;
+            } else {
+                spdlog::info("NetworkMonitor: The network layout has not "
+                             "changed since the last download");
+            }
+            networkLayoutFile = download.file;
+            snapshotCacheFile = config.networkLayoutCacheDirectory /
+                                "network-layout.snapshot";
+            layoutContentHash = download.contentHash;
+        } else if (config.networkLayoutFile.empty()) {
+            spdlog::info(
+                "NetworkMonitor: Downloading the network layout file to {}",
+                networkLayoutFile
+            );
+            const std::string fileUrl {
+                "https://" + config.networkEventsUrl + networkLayoutEndpoint_
+            };
+            bool downloaded {DownloadFile(
+                fileUrl,
+                networkLayoutFile,
+                config.caCertFile
+            )};
+            if (!downloaded) {
+                spdlog::error("NetworkMonitor: Could not download {}. Exiting",
+                              fileUrl);
+                return NetworkMonitorError::kFailedNetworkLayoutFileDownload;
+            }
+        } else {
+            std::error_code ec {};
+            const auto writeTime {
+                std::filesystem::last_write_time(networkLayoutFile, ec)
+            };
+            if (onlyIfChanged && !ec && writeTime == layoutFileWriteTime_) {
+                return NetworkMonitorError::kOk;
+            }
+            layoutFileWriteTime_ = writeTime;
+        }
+        // Network representation
+        // The layout file is either a compiled network snapshot, or a JSON
+        // file that we stream straight into the network representation.
+        spdlog::info("NetworkMonitor: Loading the network layout file");
+        const auto loadStart {std::chrono::steady_clock::now()};
+        try {
+            if (!snapshotCacheFile.empty() &&
+                    LoadCachedNetworkSnapshot(snapshotCacheFile,
+                                              layoutContentHash, network)) {
+                spdlog::info("NetworkMonitor: Loaded the cached snapshot {}",
+                             snapshotCacheFile);
+            } else if (IsNetworkSnapshot(networkLayoutFile)) {
+                std::uint64_t sourceHash {0};
+                if (!ReadNetworkSnapshot(networkLayoutFile, network,
+                                         sourceHash)) {
+                    spdlog::error("NetworkMonitor: Could not load the network "
+                                  "snapshot {}. Exiting",
+                                  networkLayoutFile);
+                    return NetworkMonitorError::kFailedNetworkLayoutFileParsing;
+                }
+            } else {
+                std::ifstream file {networkLayoutFile};
+                bool networkLoaded {network.FromJsonStream(file)};
+                if (!networkLoaded) {
+                    spdlog::error("NetworkMonitor: Could not construct the "
+                                  "TransportNetwork. Exiting");
+                    return NetworkMonitorError::
+                        kFailedTransportNetworkConstruction;
+                }
+                if (!snapshotCacheFile.empty() &&
+                        !WriteNetworkSnapshot(snapshotCacheFile, network,
+                                              layoutContentHash)) {
+                    spdlog::warn("NetworkMonitor: Could not write the "
+                                 "snapshot {}",
+                                 snapshotCacheFile);
+                }
+            }
+        } catch (const nlohmann::json::parse_error& e) {
+            spdlog::error("NetworkMonitor: Could not parse {}: {}. Exiting",
+                          networkLayoutFile, e.what());
+            return NetworkMonitorError::kFailedNetworkLayoutFileParsing;
+        } catch (const std::exception& e) {
+            spdlog::error("NetworkMonitor: Exception while constructing the "
+                          "TransportNetwork: {}. Exiting",
+                          e.what());
+            return NetworkMonitorError::kFailedTransportNetworkConstruction;
+        }
+        spdlog::info("NetworkMonitor: Loaded {} stations in {}",
+                     network.GetNStations(),
+                     std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - loadStart
+                     ));
+        loaded = true;
+        return NetworkMonitorError::kOk;
+    }
+
+    // Runs in the I/O thread, once the background fetch completes.
+    void OnNetworkLayoutFetched(
+        bool ok,
+        std::string&& content
+    )
+    {
+        using Error = NetworkMonitorError;
+        if (!ok) {
+            spdlog::error("NetworkMonitor: Could not download the network "
+                          "layout file. Exiting");
+            OnNetworkLayoutError(Error::kFailedNetworkLayoutFileDownload);
+            return;
+        }
+        spdlog::info("NetworkMonitor: Fetched the network layout ({} B) in {}",
+                     content.size(),
+                     GetTimeSinceConfigure(std::chrono::steady_clock::now()));
+        const auto loadStart {std::chrono::steady_clock::now()};
+        try {
+            std::istringstream stream {content};
+            if (!network_.FromJsonStream(stream)) {
+                spdlog::error("NetworkMonitor: Could not construct the "
+                              "TransportNetwork. Exiting");
+                OnNetworkLayoutError(
+                    Error::kFailedTransportNetworkConstruction
+                );
+                return;
+            }
+        } catch (const nlohmann::json::parse_error& e) {
+            spdlog::error("NetworkMonitor: Could not parse the network layout: "
+                          "{}. Exiting",
+                          e.what());
+            OnNetworkLayoutError(Error::kFailedNetworkLayoutFileParsing);
+            return;
+        } catch (const std::exception& e) {
+            spdlog::error("NetworkMonitor: Exception while constructing the "
+                          "TransportNetwork: {}. Exiting",
+                          e.what());
+            OnNetworkLayoutError(Error::kFailedTransportNetworkConstruction);
+            return;
+        }
+        spdlog::info("NetworkMonitor: Loaded {} stations in {}",
+                     network_.GetNStations(),
+                     std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - loadStart
+                     ));
+        auto ec {SetUpNetworkState()};
+        if (ec != Error::kOk) {
+            OnNetworkLayoutError(ec);
+            return;
+        }
+        StartPassengerEventPipeline();
+
+        // Serve the requests that arrived while the network was loading, then
+        // start receiving passenger events.
+        auto pendingRequests {std::move(pendingRequests_)};
+        pendingRequests_.clear();
+        for (auto& request: pendingRequests) {
+            request();
+        }
+        if (clientConnected_) {
+            SubscribeToPassengerEvents();
+        }
+    }
+
+    // The monitor cannot run without a network.
+    void OnNetworkLayoutError(
+        NetworkMonitorError ec
+    )
+    {
+        lastErrorCode_ = ec;
+        ioc_.stop();
+    }
+
+    std::chrono::milliseconds GetTimeSinceConfigure(
+        std::chrono::steady_clock::time_point time
+    ) const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            time - configureStart_
+        );
+    }
+
+    // Set up everything that depends on the network layout: The crowding
+    // history, the passenger counts, the journal and the ingestion stage.
+    NetworkMonitorError SetUpNetworkState()
+    {
+        crowdingHistory_ = CrowdingTimeSeries {
+            network_.GetNStations(),
+            config_.crowdingHistoryResolution,
+            config_.crowdingHistoryRetention,
+        };
+        layoutHash_ = network_.GetLayoutHash();
+
+        // Crowding checkpoint
+        // Passenger counts are cumulative, so we restore them from the last
+        // checkpoint, if it matches the current network layout.
+        bool crowdingRestored {false};
+        if (!config_.crowdingCheckpointFile.empty()) {
+            std::vector<long long int> passengerCounts {};
+            crowdingRestored = (
+                ReadCrowdingCheckpoint(config_.crowdingCheckpointFile,
+                                       layoutHash_, passengerCounts) &&
+                network_.SetPassengerCounts(passengerCounts)
+            );
+            if (crowdingRestored) {
+                spdlog::info("NetworkMonitor: Restored crowding from {}",
+                             config_.crowdingCheckpointFile.string());
+            } else {
+                spdlog::warn("NetworkMonitor: No valid crowding checkpoint in "
+                             "{}. Starting from empty stations",
+                             config_.crowdingCheckpointFile.string());
+            }
+        }
+
+        // Passenger event journal
+        // Without a checkpoint, we rebuild the passenger counts by replaying
+        // the whole journal. We then start a new journal segment.
+        if (!config_.passengerEventJournalDirectory.empty()) {
+            const auto& journalDirectory {
+                config_.passengerEventJournalDirectory
+            };
+            if (!crowdingRestored) {
+                std::vector<long long int> passengerCounts(
+                    network_.GetNStations(), 0
+                );
+                auto start {std::chrono::steady_clock::now()};
+                auto nEvents {ReplayPassengerEventJournal(
+                    journalDirectory, layoutHash_, passengerCounts
+                )};
+                network_.SetPassengerCounts(passengerCounts);
+                spdlog::info("NetworkMonitor: Replayed {} passenger events "
+                             "from {} in {}",
+                             nEvents, journalDirectory.string(),
+                             std::chrono::duration_cast<
+                                 std::chrono::milliseconds
+                             >(std::chrono::steady_clock::now() - start));
+            }
+            journal_ = std::make_unique<PassengerEventJournal>(
+                journalDirectory
+            );
+            if (!journal_->Open(layoutHash_)) {
+                spdlog::error("NetworkMonitor: Could not open the passenger "
+                              "event journal in {}. Exiting",
+                              journalDirectory.string());
+                return NetworkMonitorError::kCouldNotOpenPassengerEventJournal;
+            }
+        }
+
+        // Ingestion stage
+        // With a ring capacity, raw messages are handed over to a dedicated
+        // aggregation thread. Otherwise, events are parsed and applied in
+        // batches on the I/O thread.
+        batcher_ = std::make_unique<PassengerEventBatcher>(
+            ioc_,
+            [this](const auto& events) {
+                if (!OnPassengerEventBatch(events)) {
+                    lastErrorCode_ =
+                        NetworkMonitorError::kCouldNotRecordPassengerEvent;
+                }
+            },
+            config_.ingestionMaxBatchSize,
+            config_.ingestionMaxLatency
+        );
+        if (config_.ingestionRingCapacity > 0) {
+            spdlog::info("NetworkMonitor: Aggregating passenger events in a "
+                         "separate thread (ring capacity: {}, policy: {})",
+                         config_.ingestionRingCapacity,
+                         config_.ingestionBackpressurePolicy);
+            pipeline_ = std::make_unique<PassengerEventPipeline>(
+                [this](auto& messages) {
+                    OnPassengerEventMessages(messages);
+                },
+                config_.ingestionRingCapacity,
+                config_.ingestionBackpressurePolicy,
+                config_.ingestionMaxBatchSize
+            );
+        }
+        if (!config_.crowdingCheckpointFile.empty()) {
+            ScheduleCrowdingCheckpoint();
+        }
+        if (config_.networkLayoutReloadInterval.count() > 0) {
+            ScheduleNetworkLayoutReload();
+        }
+        networkReady_ = true;
+        networkReadyAt_ = std::chrono::steady_clock::now();
+        return NetworkMonitorError::kOk;
+    }
+
+    // Load the network from a cached snapshot, only if the snapshot was built
+    // from the layout file with the given content hash.
+    bool LoadCachedNetworkSnapshot(
+        const std::filesystem::path& snapshotFile,
+        const std::uint64_t layoutContentHash,
+        TransportNetwork& network
+    )
+    {
+        if (!IsNetworkSnapshot(snapshotFile)) {
+            return false;
+        }
+        TransportNetwork snapshotNetwork {};
+        std::uint64_t sourceHash {0};
+        if (!ReadNetworkSnapshot(snapshotFile, snapshotNetwork, sourceHash) ||
+                sourceHash != layoutContentHash) {
+            return false;
+        }
+        network = std::move(snapshotNetwork);
+        return true;
+    }
+
+    // Network layout reload
+
+    void ScheduleNetworkLayoutReload()
+    {
+        reloadTimer_.expires_after(config_.networkLayoutReloadInterval);
+        reloadTimer_.async_wait([this](auto ec) {
+            if (ec) {
+                return;
+            }
+            StartNetworkLayoutReload(false);
+            ScheduleNetworkLayoutReload();
+        });
+    }
+
+    // Runs in the I/O thread. Returns false if a reload is already in
+    // progress.
+    bool StartNetworkLayoutReload(
+        const bool force
+    )
+    {
+        if (!networkReady_ || reloadInProgress_) {
+            return false;
+        }
+        reloadInProgress_ = true;
+
+        // The previous reload thread already handed its result over, so this
+        // does not block.
+        if (reloadThread_.joinable()) {
+            reloadThread_.join();
+        }
+        auto work {boost::asio::make_work_guard(ioc_)};
+        reloadThread_ = std::thread {[this, force, work = std::move(work)]()
+                                     mutable {
+            BuildReloadedNetwork(force);
+            work.reset();
+        }};
+        return true;
+    }
+
+    // Runs in the reload thread.
+    void BuildReloadedNetwork(
+        const bool force
+    )
+    {
+        auto network {std::make_shared<TransportNetwork>()};
+        bool loaded {false};
+        auto ec {LoadNetworkLayout(config_, *network, loaded, !force)};
+        if (ec != NetworkMonitorError::kOk || !loaded) {
+            boost::asio::post(ioc_, [this, ec]() {
+                OnNetworkLayoutNotReloaded(ec);
+            });
+            return;
+        }
+
+        // Map the old station handles to the new ones. Only the I/O thread
+        // replaces network_, and it waits for us to do so.
+        std::vector<StationHandle> newHandles {};
+        {
+            std::shared_lock<std::shared_mutex> lock {networkMutex_};
+            const auto stations {network_.GetStations()};
+            newHandles.reserve(stations.size());
+            for (const auto& station: stations) {
+                newHandles.push_back(network->FindStationHandle(station.id));
+            }
+        }
+        boost::asio::post(ioc_, [
+            this,
+            network,
+            newHandles = std::move(newHandles)
+        ]() {
+            SwapNetwork(std::move(*network), newHandles);
+        });
+    }
+
+    // Runs in the I/O thread, so no request is being served. The aggregation
+    // thread is held off by the network lock.
+    void SwapNetwork(
+        TransportNetwork&& network,
+        const std::vector<StationHandle>& newHandles
+    )
+    {
+        const auto pauseStart {std::chrono::steady_clock::now()};
+
+        // Events that were parsed against the old network are applied to it.
+        if (batcher_ != nullptr) {
+            batcher_->Flush();
+        }
+        std::unique_lock<std::shared_mutex> lock {networkMutex_};
+        const auto passengerCounts {network_.GetPassengerCounts()};
+        std::vector<long long int> newPassengerCounts(
+            network.GetNStations(), 0
+        );
+        size_t nCarriedOver {0};
+        const auto nMapped {
+            std::min(newHandles.size(), passengerCounts.size())
+        };
+        for (size_t station {0}; station < nMapped; ++station) {
+            if (newHandles[station] < newPassengerCounts.size()) {
+                newPassengerCounts[newHandles[station]] =
+                    passengerCounts[station];
+                ++nCarriedOver;
+            }
+        }
+        network.SetPassengerCounts(newPassengerCounts);
+        crowdingHistory_.Remap(newHandles, network.GetNStations());
+        network_ = std::move(network);
+        ++networkGeneration_;
+
+        // Journal records refer to station handles, so a new layout needs a
+        // new journal segment.
+        bool journalOpen {true};
+        const auto layoutHash {network_.GetLayoutHash()};
+        if (layoutHash != layoutHash_) {
+            layoutHash_ = layoutHash;
+            if (journal_ != nullptr) {
+                journalOpen = journal_->Open(layoutHash_);
+            }
+        }
+        lock.unlock();
+        lastNetworkReloadPause_ =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - pauseStart
+            );
+        ++nNetworkReloads_;
+        reloadInProgress_ = false;
+        spdlog::info("NetworkMonitor: Reloaded the network layout ({} "
+                     "stations, {} carried over). Paused for {}",
+                     network_.GetNStations(), nCarriedOver,
+                     lastNetworkReloadPause_);
+        if (!journalOpen) {
+            spdlog::error("NetworkMonitor: Could not open the passenger event "
+                          "journal in {}",
+                          config_.passengerEventJournalDirectory.string());
+            lastErrorCode_ = NetworkMonitorError::
+                kCouldNotOpenPassengerEventJournal;
+        }
+
+        // The last checkpoint refers to the old layout.
+        SaveCrowdingCheckpoint();
+    }
+
+    // Runs in the I/O thread. We keep serving requests with the old network.
+    void OnNetworkLayoutNotReloaded(
+        NetworkMonitorError ec
+    )
+    {
+        reloadInProgress_ = false;
+        if (ec == NetworkMonitorError::kOk) {
+            spdlog::debug("NetworkMonitor: The network layout did not change");
+            return;
+        }
+        spdlog::error("NetworkMonitor: Could not reload the network layout: "
+                      "{}. Keeping the current network",
+                      ec);
+        lastErrorCode_ = ec;
+    }
+
+    // Crowding checkpoint
+
+    void ScheduleCrowdingCheckpoint()
+    {
+        checkpointTimer_.expires_after(config_.crowdingCheckpointInterval);
+        checkpointTimer_.async_wait([this](auto ec) {
+            if (ec) {
+                return;
+            }
+            SaveCrowdingCheckpoint();
+            ScheduleCrowdingCheckpoint();
+        });
+    }
+
+    void SaveCrowdingCheckpoint()
+    {
+        // Without a network, we would overwrite the last checkpoint with an
+        // empty one.
+        if (config_.crowdingCheckpointFile.empty() || !networkReady_) {
+            return;
+        }
+        std::shared_lock<std::shared_mutex> lock {networkMutex_};
+        auto passengerCounts {network_.GetPassengerCounts()};
+        lock.unlock();
+        bool ok {WriteCrowdingCheckpoint(
+            config_.crowdingCheckpointFile,
+            layoutHash_,
+            passengerCounts
+        )};
+        if (!ok) {
+            spdlog::error("NetworkMonitor: Could not write crowding checkpoint "
+                          "to {}",
+                          config_.crowdingCheckpointFile.string());
+            return;
+        }
+        spdlog::debug("NetworkMonitor: Wrote crowding checkpoint to {}",
+                      config_.crowdingCheckpointFile.string());
+    }
 };
 
 } // namespace NetworkMonitor
@@ -0,0 +1,73 @@
+#ifndef NETWORK_MONITOR_NETWORK_SNAPSHOT_H
+#define NETWORK_MONITOR_NETWORK_SNAPSHOT_H
+
+#include "transport-network.h"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace NetworkMonitor {
+
+/*! \brief Compute a 64-bit FNV-1a hash of the content of a file.
+ *
+ *  \returns false if the file could not be read. In this case, `hash` is left
+ *           untouched.
+ */
+bool HashFile(
+    const std::filesystem::path& file,
+    std::uint64_t& hash
+);
+
+/*! \brief Save a fully built network to a binary snapshot file.
+ *
+ *  The snapshot stores the stations, lines, routes and travel times of the
+ *  network in flat, fixed-size record sections. All strings are interned in a
+ *  single string table. The file carries a version, a checksum of its content
+ *  and a hash of the source layout it was built from.
+ *
+ *  The snapshot is written to a temporary file and then renamed over the
+ *  destination.
+ *
+ *  \param sourceHash A hash of the source network layout file, as returned by
+ *                    `HashFile`.
+ *
+ *  \returns false if the snapshot could not be written.
+ */
+bool WriteNetworkSnapshot(
+    const std::filesystem::path& file,
+    const TransportNetwork& network,
+    const std::uint64_t sourceHash
+);
+
+/*! \brief Check whether a file starts like a network snapshot.
+ *
+ *  This only checks the magic bytes at the start of the file. Use it to tell
+ *  a snapshot apart from a JSON network layout.
+ */
+bool IsNetworkSnapshot(
+    const std::filesystem::path& file
+);
+
+/*! \brief Load a network from a binary snapshot file.
+ *
+ *  The file is memory-mapped and validated (version, sizes, checksum, string
+ *  references and station indices) before the network is built from it. No
+ *  text is parsed.
+ *
+ *  \param network      Replaced with the network in the snapshot, on success.
+ *  \param sourceHash   Set to the hash of the source network layout file, on
+ *                      success.
+ *
+ *  \returns false if the file does not exist, is corrupted or was written by
+ *           an incompatible version. In this case, `network` and `sourceHash`
+ *           are left untouched.
+ */
+bool ReadNetworkSnapshot(
+    const std::filesystem::path& file,
+    TransportNetwork& network,
+    std::uint64_t& sourceHash
+);
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_NETWORK_SNAPSHOT_H
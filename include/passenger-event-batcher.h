@@ -0,0 +1,107 @@
+#ifndef NETWORK_MONITOR_PASSENGER_EVENT_BATCHER_H
+#define NETWORK_MONITOR_PASSENGER_EVENT_BATCHER_H
+
+#include "transport-network.h"
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Metrics of the passenger event ingestion stage.
+ */
+struct IngestionMetrics {
+    // Total number of events and batches applied so far.
+    size_t nEvents {0};
+    size_t nBatches {0};
+
+    // Size of the last batch and of the largest batch.
+    size_t lastBatchSize {0};
+    size_t maxBatchSize {0};
+
+    // Time between the arrival of the first event of a batch and the moment
+    // the batch was applied.
+    std::chrono::microseconds lastBatchLatency {0};
+    std::chrono::microseconds maxBatchLatency {0};
+
+    // Events waiting to be applied, now and at most.
+    size_t queueDepth {0};
+    size_t maxQueueDepth {0};
+
+    // Events dropped because the ingestion queue was full.
+    size_t nDropped {0};
+
+    /*! \brief Get the average number of events per batch.
+     */
+    double GetMeanBatchSize() const;
+};
+
+/*! \brief Collect passenger events and apply them in batches.
+ *
+ *  Events pushed while the I/O context drains its ready handlers are grouped
+ *  together: The first event of a batch posts a flush to the I/O context, and
+ *  the flush only runs after all the handlers that were already queued. A
+ *  batch is also flushed as soon as it reaches the maximum batch size, or
+ *  when an event arrives after the latency cap has expired.
+ *
+ *  All methods must be called from the I/O context thread.
+ */
+class PassengerEventBatcher {
+public:
+    /*! \brief Callback to apply a batch of events.
+     */
+    using OnBatch = std::function<
+        void (const std::vector<PassengerEventRecord>&)
+    >;
+
+    /*! \brief Construct a batcher.
+     *
+     *  \param ioc          The I/O context that runs the flushes.
+     *  \param onBatch      Callback that applies a batch of events.
+     *  \param maxBatchSize Maximum number of events in a batch. A value of 1
+     *                      disables batching.
+     *  \param maxLatency   Maximum time the first event of a batch waits
+     *                      before the batch is applied, as long as events
+     *                      keep coming.
+     */
+    PassengerEventBatcher(
+        boost::asio::io_context& ioc,
+        OnBatch onBatch,
+        const size_t maxBatchSize = 1024,
+        const std::chrono::microseconds maxLatency =
+            std::chrono::microseconds(1000)
+    );
+
+    /*! \brief Queue an event.
+     */
+    void Push(
+        const PassengerEventRecord& event
+    );
+
+    /*! \brief Apply all the queued events now.
+     */
+    void Flush();
+
+    /*! \brief Get the ingestion metrics.
+     */
+    const IngestionMetrics& GetMetrics() const;
+
+private:
+    boost::asio::io_context& ioc_;
+    OnBatch onBatch_ {};
+    size_t maxBatchSize_ {0};
+    std::chrono::microseconds maxLatency_ {};
+
+    std::vector<PassengerEventRecord> pending_ {};
+    std::chrono::steady_clock::time_point batchStart_ {};
+    bool isFlushScheduled_ {false};
+
+    IngestionMetrics metrics_ {};
+};
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_PASSENGER_EVENT_BATCHER_H
@@ -0,0 +1,147 @@
+#ifndef NETWORK_MONITOR_PASSENGER_EVENT_JOURNAL_H
+#define NETWORK_MONITOR_PASSENGER_EVENT_JOURNAL_H
+
+#include "transport-network.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Append-only journal of passenger events.
+ *
+ *  Records are written to a sequence of segment files in the journal
+ *  directory, named `journal-<sequence number>.bin`. A new segment is started
+ *  every time the journal is opened and when the current segment exceeds the
+ *  maximum segment size. Each segment starts with a header that stores the
+ *  hash of the network layout the station handles refer to.
+ *
+ *  `Append` only copies the record into an in-memory buffer. A background
+ *  thread writes the buffered records to disk in groups, at most once every
+ *  flush interval, so the caller never blocks on file I/O.
+ *
+ *  `Append` is thread-safe.
+ */
+class PassengerEventJournal {
+public:
+    /*! \brief Construct a closed journal.
+     *
+     *  \param directory        Directory that contains the segment files. It
+     *                          is created if it does not exist.
+     *  \param maxSegmentSize   Size after which we start a new segment, in
+     *                          bytes.
+     *  \param flushInterval    Maximum time a record waits in memory before it
+     *                          is written to disk.
+     */
+    PassengerEventJournal(
+        const std::filesystem::path& directory,
+        const size_t maxSegmentSize = 64 * 1024 * 1024,
+        const std::chrono::milliseconds flushInterval =
+            std::chrono::milliseconds(10)
+    );
+
+    /*! \brief Destructor.
+     *
+     *  Outstanding records are written to disk before the journal is closed.
+     */
+    ~PassengerEventJournal();
+
+    PassengerEventJournal(const PassengerEventJournal&) = delete;
+    PassengerEventJournal& operator=(const PassengerEventJournal&) = delete;
+
+    /*! \brief Start a new segment and launch the writer thread.
+     *
+     *  \returns false if the journal directory or the segment file could not
+     *           be created.
+     */
+    bool Open(
+        const std::uint64_t layoutHash
+    );
+
+    /*! \brief Write the outstanding records to disk and stop the writer
+     *         thread.
+     */
+    void Close();
+
+    /*! \brief Queue a record to be written to the journal.
+     *
+     *  Records appended while the journal is closed are dropped.
+     */
+    void Append(
+        const PassengerEventRecord& record
+    );
+
+    /*! \brief Queue a batch of records to be written to the journal.
+     *
+     *  Records appended while the journal is closed are dropped.
+     */
+    void Append(
+        const std::vector<PassengerEventRecord>& records
+    );
+
+    /*! \brief Get the number of records written to disk so far.
+     */
+    size_t GetNRecordsWritten() const;
+
+    /*! \brief Get the number of group commits performed so far.
+     */
+    size_t GetNFlushes() const;
+
+private:
+    std::filesystem::path directory_ {};
+    size_t maxSegmentSize_ {0};
+    std::chrono::milliseconds flushInterval_ {};
+
+    std::uint64_t layoutHash_ {0};
+    size_t segmentNumber_ {0};
+    size_t segmentSize_ {0};
+    std::ofstream segment_ {};
+
+    // Records are appended to pending_ by the caller and swapped out by the
+    // writer thread.
+    mutable std::mutex mutex_ {};
+    std::condition_variable cv_ {};
+    std::vector<PassengerEventRecord> pending_ {};
+    bool isOpen_ {false};
+    bool stopping_ {false};
+    std::thread writer_ {};
+
+    size_t nRecordsWritten_ {0};
+    size_t nFlushes_ {0};
+
+    void RunWriter();
+
+    bool OpenNextSegment();
+
+    void WriteRecords(
+        const std::vector<PassengerEventRecord>& records
+    );
+};
+
+/*! \brief Rebuild the passenger counts from a journal.
+ *
+ *  All segments in the journal directory are replayed in sequence order.
+ *  Segments are memory-mapped and scanned linearly.
+ *
+ *  \param layoutHash       The hash of the current network layout. Segments
+ *                          saved for a different layout are skipped.
+ *  \param passengerCounts  The counts to update, indexed by station handle.
+ *                          Events for out-of-range stations are skipped.
+ *
+ *  \returns The number of replayed events.
+ */
+size_t ReplayPassengerEventJournal(
+    const std::filesystem::path& directory,
+    const std::uint64_t layoutHash,
+    std::vector<long long int>& passengerCounts
+);
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_PASSENGER_EVENT_JOURNAL_H
@@ -0,0 +1,142 @@
+#ifndef NETWORK_MONITOR_PASSENGER_EVENT_PIPELINE_H
+#define NETWORK_MONITOR_PASSENGER_EVENT_PIPELINE_H
+
+#include "passenger-event-batcher.h"
+#include "spsc-ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief What to do with a new message when the pipeline ring is full.
+ */
+enum class BackpressurePolicy {
+    kBlock,
+    kCountAndDrop,
+    kDropOldest,
+};
+
+/*! \brief Print a backpressure policy, for example "block" or "drop-oldest".
+ */
+std::ostream& operator<<(
+    std::ostream& os,
+    const BackpressurePolicy& policy
+);
+
+/*! \brief Parse a backpressure policy: "block", "count-and-drop" or
+ *         "drop-oldest".
+ *
+ *  \returns false if the string is not a known policy. In that case, the
+ *           policy is left untouched.
+ */
+bool ParseBackpressurePolicy(
+    const std::string& name,
+    BackpressurePolicy& policy
+);
+
+/*! \brief Hand raw passenger event messages over to an aggregation thread.
+ *
+ *  The I/O thread pushes the raw messages into a bounded lock-free ring. A
+ *  dedicated aggregation thread pops them in batches and passes them to a
+ *  callback, which parses them and updates the counters.
+ *
+ *  When the ring is full, the backpressure policy decides what happens:
+ *  - kBlock: The producer waits for the aggregation thread to make room.
+ *  - kCountAndDrop: The new message is dropped.
+ *  - kDropOldest: The oldest message in the ring is dropped.
+ *
+ *  `Push` must always be called from the same thread.
+ */
+class PassengerEventPipeline {
+public:
+    /*! \brief Callback to process a batch of raw messages.
+     *
+     *  The callback runs in the aggregation thread. It may move the messages
+     *  out of the vector.
+     */
+    using OnMessages = std::function<void (std::vector<std::string>&)>;
+
+    /*! \brief Construct a pipeline. The aggregation thread is not started.
+     *
+     *  \param onMessages   Callback that processes a batch of messages.
+     *  \param capacity     Number of messages the ring can hold. Rounded up to
+     *                      the next power of two.
+     *  \param policy       What to do when the ring is full.
+     *  \param maxBatchSize Maximum number of messages passed to a single call
+     *                      of the callback.
+     */
+    PassengerEventPipeline(
+        OnMessages onMessages,
+        const size_t capacity = 65536,
+        const BackpressurePolicy policy = BackpressurePolicy::kBlock,
+        const size_t maxBatchSize = 1024
+    );
+
+    /*! \brief Destructor. Stops the aggregation thread.
+     */
+    ~PassengerEventPipeline();
+
+    PassengerEventPipeline(const PassengerEventPipeline&) = delete;
+    PassengerEventPipeline& operator=(const PassengerEventPipeline&) = delete;
+
+    /*! \brief Launch the aggregation thread.
+     *
+     *  Calling this function on a running pipeline has no effect.
+     */
+    void Start();
+
+    /*! \brief Process the messages left in the ring and join the aggregation
+     *         thread.
+     */
+    void Stop();
+
+    /*! \brief Queue a raw message.
+     *
+     *  If the aggregation thread is not running, the kBlock policy behaves
+     *  like kCountAndDrop, so that the producer never waits forever.
+     *
+     *  \returns false if a message had to be dropped to honor the
+     *           backpressure policy.
+     */
+    bool Push(
+        std::string&& message
+    );
+
+    /*! \brief Get a snapshot of the ingestion metrics.
+     *
+     *  Batch latencies are measured from the moment the oldest message of the
+     *  batch was pushed to the moment the callback returned.
+     */
+    IngestionMetrics GetMetrics() const;
+
+private:
+    struct Entry {
+        std::string message {};
+        std::chrono::steady_clock::time_point pushedAt {};
+    };
+
+    OnMessages onMessages_ {};
+    SpscRing<Entry> ring_;
+    BackpressurePolicy policy_ {BackpressurePolicy::kBlock};
+    size_t maxBatchSize_ {0};
+
+    std::thread aggregator_ {};
+    std::atomic<bool> isRunning_ {false};
+
+    std::atomic<size_t> nDropped_ {0};
+    mutable std::mutex metricsMutex_ {};
+    IngestionMetrics metrics_ {};
+
+    void RunAggregator();
+};
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_PASSENGER_EVENT_PIPELINE_H
@@ -0,0 +1,144 @@
+#ifndef NETWORK_MONITOR_SPSC_RING_H
+#define NETWORK_MONITOR_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace NetworkMonitor {
+
+/*! \brief Bounded lock-free ring buffer with a single producer.
+ *
+ *  Only one thread may push. Pops are usually done by a single consumer
+ *  thread, but the producer may also pop, for example to discard the oldest
+ *  element when the ring is full. To allow this, every slot carries a sequence
+ *  number and pops claim their slot with a compare-and-swap on the read index.
+ *
+ *  The capacity is rounded up to the next power of two.
+ */
+template <typename T>
+class SpscRing {
+public:
+    /*! \brief Construct an empty ring.
+     *
+     *  \param capacity Minimum number of elements the ring can hold. A value
+     *                  of 0 is treated as 1.
+     */
+    explicit SpscRing(
+        const size_t capacity
+    ) : capacity_ {RoundUpToPowerOfTwo(capacity)},
+        slots_ {std::make_unique<Slot[]>(capacity_)}
+    {
+        for (size_t idx {0}; idx < capacity_; ++idx) {
+            slots_[idx].sequence.store(idx, std::memory_order_relaxed);
+        }
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /*! \brief Push an element at the back of the ring.
+     *
+     *  Must only be called from the producer thread.
+     *
+     *  \returns false if the ring is full. In that case the element is left
+     *           untouched.
+     */
+    bool TryPush(
+        T&& value
+    )
+    {
+        const auto index {writeIndex_.load(std::memory_order_relaxed)};
+        auto& slot {slots_[index & (capacity_ - 1)]};
+        if (slot.sequence.load(std::memory_order_acquire) != index) {
+            return false;
+        }
+        slot.value = std::move(value);
+        slot.sequence.store(index + 1, std::memory_order_release);
+        writeIndex_.store(index + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*! \brief Pop the element at the front of the ring.
+     *
+     *  \returns false if the ring is empty.
+     */
+    bool TryPop(
+        T& value
+    )
+    {
+        auto index {readIndex_.load(std::memory_order_relaxed)};
+        while (true) {
+            auto& slot {slots_[index & (capacity_ - 1)]};
+            const auto sequence {slot.sequence.load(std::memory_order_acquire)};
+            const auto diff {static_cast<std::intptr_t>(sequence) -
+                             static_cast<std::intptr_t>(index + 1)};
+            if (diff < 0) {
+                return false;
+            }
+            if (diff > 0) {
+                // Another thread popped this slot in the meantime.
+                index = readIndex_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (readIndex_.compare_exchange_weak(index, index + 1,
+                                                 std::memory_order_relaxed)) {
+                value = std::move(slot.value);
+                slot.sequence.store(index + capacity_,
+                                    std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    /*! \brief Get the number of elements the ring can hold.
+     */
+    size_t GetCapacity() const
+    {
+        return capacity_;
+    }
+
+    /*! \brief Get an estimate of the number of elements in the ring.
+     *
+     *  The value is exact when no other thread is pushing or popping.
+     */
+    size_t GetSize() const
+    {
+        const auto readIndex {readIndex_.load(std::memory_order_relaxed)};
+        const auto writeIndex {writeIndex_.load(std::memory_order_relaxed)};
+        return writeIndex > readIndex ? writeIndex - readIndex : 0;
+    }
+
+private:
+    // Keep the indices on separate cache lines, so that the producer and the
+    // consumer do not invalidate each other's cache at every operation.
+    static constexpr size_t kCacheLineSize {64};
+
+    struct Slot {
+        std::atomic<size_t> sequence {0};
+        T value {};
+    };
+
+    static size_t RoundUpToPowerOfTwo(
+        const size_t value
+    )
+    {
+        size_t result {1};
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_ {0};
+    std::unique_ptr<Slot[]> slots_ {nullptr};
+
+    alignas(kCacheLineSize) std::atomic<size_t> writeIndex_ {0};
+    alignas(kCacheLineSize) std::atomic<size_t> readIndex_ {0};
+};
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_SPSC_RING_H
@@ -1,6 +1,7 @@
 #ifndef NETWORK_MONITOR_STOMP_CLIENT_H
 #define NETWORK_MONITOR_STOMP_CLIENT_H
 
+#include "stomp-decoder.h"
 #include "stomp-frame.h"
 
 #include <boost/asio.hpp>
@@ -12,13 +13,17 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/ostr.h>
 
+#include <cstddef>
 #include <functional>
 #include <iomanip>
+#include <memory_resource>
 #include <iostream>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace NetworkMonitor {
 
@@ -45,7 +50,28 @@ std::ostream& operator<<(std::ostream& os, const StompClientError& m);
 
 /*! \brief Convert StompClientError to string.
  */
-std::string ToString(const StompClientError& m);
+std::string_view ToString(const StompClientError& m);
+
+} // namespace NetworkMonitor
+
+/*! \brief fmt formatter for `StompClientError`.
+ */
+template <>
+struct fmt::formatter<NetworkMonitor::StompClientError>:
+    fmt::formatter<fmt::string_view> {
+    template <typename FormatContext>
+    auto format(
+        const NetworkMonitor::StompClientError& error,
+        FormatContext& ctx
+    )
+    {
+        const auto name {NetworkMonitor::ToString(error)};
+        return formatter<fmt::string_view>::format({name.data(), name.size()},
+                                                   ctx);
+    }
+};
+
+namespace NetworkMonitor {
 
 /*! \brief STOMP client implementing the subset of commands needed by the
  *         network-events service.
@@ -81,7 +107,7 @@ public:
     {
         spdlog::info("StompClient: Creating STOMP client for {}:{}{}",
                      url, port, endpoint);
-             
+        RenderTemplates();
     }
 
     /*! \brief The copy constructor is deleted.
@@ -113,11 +139,12 @@ public:
      *                      connection.
      *  \param onMessage    This handler is called when the connected client
      *                      or server sends us a message as a SEND frame. The
-     *                      handler contains an error code, the message
-     *                      destination and content. Ownership of the
-     *                      message content is passed to the receiver. It is
-     *                      assumed that the message is received with
-     *                      application/json content type.
+     *                      handler contains an error code and the frame, from
+     *                      which it can read the message destination and
+     *                      content. The handler can take ownership of the
+     *                      frame; otherwise, its buffer is reused for the next
+     *                      messages. It is assumed that the message is
+     *                      received with application/json content type.
      *  \param onDisconnect This handler is called when the STOMP or the
      *                      WebSocket connection is suddenly closed. In the
      *                      STOMP protocol, this may happen also in response to
@@ -131,7 +158,7 @@ public:
         const std::string& password,
         std::function<void (StompClientError)> onConnect = nullptr,
         std::function<
-            void (StompClientError, const std::string&, std::string&&)
+            void (StompClientError, StompFrame&&)
         > onMessage = nullptr,
         std::function<void (StompClientError)> onDisconnect = nullptr
     )
@@ -142,6 +169,7 @@ public:
         onConnect_ = onConnect;
         onMessage_ = onMessage;
         onDisconnect_ = onDisconnect;
+        decoder_.Reset();
         ws_.Connect(
             [this](auto ec) {
                 OnWsConnect(ec);
@@ -192,9 +220,13 @@ public:
      *                      automatically closes the WebSocket connection on a
      *                      STOMP protocol failure.
      *  \param onMessage    This handler is called on every new message from the
-     *                      subscription destination. It is assumed that the
-     *                      message is received with application/json content
-     *                      type.
+     *                      subscription destination, with the MESSAGE frame.
+     *                      The message content is the frame body. The handler
+     *                      can take ownership of the frame, e.g. with
+     *                      `std::move(frame).TakeBody()`; otherwise, its
+     *                      buffer is reused for the next messages. It is
+     *                      assumed that the message is received with
+     *                      application/json content type.
      *
      *  All handlers run in a separate I/O execution context from the WebSocket
      *  one.
@@ -202,7 +234,7 @@ public:
     std::string Subscribe(
         const std::string& destination,
         std::function<void (StompClientError, std::string&&)> onSubscribe,
-        std::function<void (StompClientError, std::string&&)> onMessage
+        std::function<void (StompClientError, StompFrame&&)> onMessage
     )
     {
         spdlog::info("StompClient: Subscribing to {}", destination);
@@ -217,16 +249,10 @@ public:
         // We use the subscription ID to also request a receipt, so the server
         // will confirm if we are subscribed.
         StompError error {};
-        StompFrame frame {
+        auto frame {subscribeTemplate_.Render(
             error,
-            StompCommand::kSubscribe,
-            {
-                {StompHeader::kId, subscriptionId},
-                {StompHeader::kDestination, destination},
-                {StompHeader::kAck, "auto"},
-                {StompHeader::kReceipt, subscriptionId},
-            }
-        };
+            {subscriptionId, destination, subscriptionId}
+        )};
         if (error != StompError::kOk) {
             spdlog::error("StompClient: Could not create a valid frame: {}",
                           error);
@@ -282,21 +308,14 @@ public:
         spdlog::info("StompClient: Sending message to {}", destination);
 
         auto requestId {GenerateId()};
-        auto messageSize {messageContent.size()};
 
         // Assemble the SEND frame.
         StompError error {};
-        StompFrame frame {
+        auto frame {sendTemplate_.Render(
             error,
-            StompCommand::kSend,
-            {
-                {StompHeader::kId, requestId},
-                {StompHeader::kDestination, destination},
-                {StompHeader::kContentType, "application/json"},
-                {StompHeader::kContentLength, std::to_string(messageSize)},
-            },
-            messageContent,
-        };
+            {requestId, destination},
+            messageContent
+        )};
         if (error != StompError::kOk) {
             spdlog::error("StompClient: Could not create a valid frame: {}",
                           error);
@@ -305,10 +324,10 @@ public:
 
         // Send the WebSocket message.
         if (onSend == nullptr) {
-            ws_.Send(frame.ToString());
+            ws_.Send(std::move(frame).ToString());
         } else {
             ws_.Send(
-                frame.ToString(),
+                std::move(frame).ToString(),
                 [requestId, onSend](auto ec) mutable {
                     auto error {ec ? StompClientError::kCouldNotSendMessage :
                                      StompClientError::kOk};
@@ -320,6 +339,11 @@ public:
     }
 
 private:
+    // Scratch memory for the frames of one WebSocket message. A message
+    // usually holds a single frame, so this is enough in practice.
+    static constexpr size_t kMessageArenaSize {4096};
+    static constexpr size_t kMaxFramesInArena {4};
+
     // This strand handles all the STOMP subscription messages. These operations
     // are decoupled from the WebSocket operations.
     // We leave it uninitialized because it does not support a default
@@ -333,13 +357,20 @@ private:
     WsClient ws_;
 
     std::function<void (StompClientError)> onConnect_ {nullptr};
-    std::function<
-        void (StompClientError, const std::string&, std::string&&)
-    > onMessage_ {nullptr};
+    std::function<void (StompClientError, StompFrame&&)> onMessage_ {nullptr};
     std::function<void (StompClientError)> onDisconnect_ {nullptr};
     std::string username_ {};
     std::string password_ {};
 
+    // Frames may be batched in a WebSocket message or split across several
+    // messages.
+    StompDecoder decoder_ {};
+
+    // The frames we send are pre-rendered when the client is created. Only
+    // the per-message fields are filled in later.
+    StompFrameTemplate subscribeTemplate_ {};
+    StompFrameTemplate sendTemplate_ {};
+
     struct Subscription {
         std::string destination {};
         std::function<void (
@@ -348,7 +379,7 @@ private:
         )> onSubscribe {nullptr};
         std::function<void (
             StompClientError,
-            std::string&&
+            StompFrame&&
         )> onMessage {nullptr};
     };
 
@@ -470,13 +501,30 @@ private:
     )
     {
         // Parse the message.
-        StompError error {};
-        StompFrame frame {error, std::move(msg)};
+        // The frames live in an arena scoped to this message, whose memory we
+        // do not need to initialize.
+        alignas(StompFrame) std::byte arenaBuffer[kMessageArenaSize];
+        std::pmr::monotonic_buffer_resource arena {
+            arenaBuffer,
+            kMessageArenaSize
+        };
+        std::pmr::vector<StompFrame> frames {&arena};
+        frames.reserve(kMaxFramesInArena);
+        auto error {decoder_.Decode(std::move(msg), frames)};
+        for (auto& frame: frames) {
+            HandleFrame(std::move(frame));
+
+            // Frames the handlers did not take give their buffer back.
+            ws_.ReleaseBuffer(std::move(frame).ToString());
+        }
         if (error != StompError::kOk) {
             spdlog::error(
                 "StompClient: Could not parse message as STOMP frame: {}",
                 error
             );
+            // The original behavior is kept: we report the error and carry on
+            // with the next message.
+            decoder_.Reset();
             if (onConnect_) {
                 boost::asio::post(
                     context_,
@@ -487,9 +535,13 @@ private:
                     }
                 );
             }
-            return;
         }
+    }
 
+    void HandleFrame(
+        StompFrame&& frame
+    )
+    {
         // Decide what to do based on the STOMP command.
         spdlog::debug("StompClient: Received {}", frame.GetCommand());
         switch (frame.GetCommand()) {
@@ -619,14 +671,21 @@ private:
         }
 
         // Send the message to the user handler.
+        // The frame buffer is the one the WebSocket message was read into, so
+        // the message reaches the user without being copied.
         if (subscription.onMessage) {
             boost::asio::post(
                 context_,
                 [
+                    this,
                     onMessage = subscription.onMessage,
-                    message = std::string(frame.GetBody())
+                    frame = std::move(frame)
                 ]() mutable {
-                    onMessage(StompClientError::kOk, std::move(message));
+                    onMessage(StompClientError::kOk, std::move(frame));
+
+                    // If the user did not take the frame, its buffer goes back
+                    // to the pool.
+                    ws_.ReleaseBuffer(std::move(frame).ToString());
                 }
             );
         }
@@ -674,22 +733,57 @@ private:
             boost::asio::post(
                 context_,
                 [
+                    this,
                     onMessage = onMessage_,
-                    destination = std::string(frame.GetHeaderValue(
-                        StompHeader::kDestination
-                    )),
-                    message = std::string(frame.GetBody())
+                    frame = std::move(frame)
                 ]() mutable {
-                    onMessage(
-                        StompClientError::kOk,
-                        destination,
-                        std::move(message)
-                    );
+                    onMessage(StompClientError::kOk, std::move(frame));
+
+                    // If the user did not take the frame, its buffer goes back
+                    // to the pool.
+                    ws_.ReleaseBuffer(std::move(frame).ToString());
                 }
             );
         }
     }
     
+    void RenderTemplates()
+    {
+        StompError error {};
+        subscribeTemplate_ = StompFrameTemplate {
+            error,
+            StompCommand::kSubscribe,
+            {
+                {StompHeader::kAck, "auto"},
+            },
+            {
+                StompHeader::kId,
+                StompHeader::kDestination,
+                StompHeader::kReceipt,
+            }
+        };
+        if (error != StompError::kOk) {
+            spdlog::error("StompClient: Could not create a valid frame: {}",
+                          error);
+        }
+        sendTemplate_ = StompFrameTemplate {
+            error,
+            StompCommand::kSend,
+            {
+                {StompHeader::kContentType, "application/json"},
+            },
+            {
+                StompHeader::kId,
+                StompHeader::kDestination,
+                StompHeader::kContentLength,
+            }
+        };
+        if (error != StompError::kOk) {
+            spdlog::error("StompClient: Could not create a valid frame: {}",
+                          error);
+        }
+    }
+
     std::string GenerateId()
     {
         std::stringstream ss {};
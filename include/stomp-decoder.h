@@ -0,0 +1,126 @@
+#ifndef NETWORK_MONITOR_STOMP_DECODER_H
+#define NETWORK_MONITOR_STOMP_DECODER_H
+
+#include "stomp-frame.h"
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Incremental STOMP decoder.
+ *
+ *  The decoder accepts a byte stream in chunks of any size and emits the
+ *  STOMP frames as soon as they are complete. A chunk may hold several frames,
+ *  and a frame may span several chunks. New lines between frames, which STOMP
+ *  uses as heart-beats, are skipped.
+ *
+ *  Frames that are entirely contained in a chunk are built directly from the
+ *  chunk. Only the start of a frame that continues in the next chunk is
+ *  buffered, and the buffer is then handed over to the frame without copying
+ *  it.
+ *
+ *  The decoder finds the end of a frame from its content-length header or, if
+ *  there is none, from the first NULL octet after the headers. Each frame is
+ *  then parsed and validated by `StompFrame`.
+ *
+ *  After an error, the decoder rejects all input until `Reset` is called.
+ */
+class StompDecoder {
+public:
+    /*! \brief Default limit on the size of a single frame, in bytes.
+     */
+    static constexpr size_t kDefaultMaxFrameSize {16 * 1024 * 1024};
+
+    /*! \brief Construct a decoder with no buffered data.
+     *
+     *  \param maxFrameSize Frames larger than this are rejected with
+     *                      `StompError::kParsingFrameTooLarge`, so that a peer
+     *                      cannot make us buffer an unbounded amount of data.
+     */
+    explicit StompDecoder(
+        const size_t maxFrameSize = kDefaultMaxFrameSize
+    );
+
+    /*! \brief Decode a chunk of data.
+     *
+     *  Complete frames are appended to the output vector, in order. The
+     *  vector can use any memory resource, e.g. an arena scoped to the
+     *  message.
+     *
+     *  \returns The first error in the stream, or StompError::kOk. The frames
+     *           decoded before the error are still appended to the output.
+     */
+    StompError Decode(
+        const std::string_view chunk,
+        std::pmr::vector<StompFrame>& frames
+    );
+
+    /*! \brief Decode a chunk of data that we can take ownership of.
+     *
+     *  If the chunk holds exactly one frame, which is the common case for
+     *  WebSocket messages, the frame takes over the chunk string.
+     */
+    StompError Decode(
+        std::string&& chunk,
+        std::pmr::vector<StompFrame>& frames
+    );
+
+    /*! \brief Check if the decoder holds the start of a frame.
+     */
+    bool HasPartialFrame() const;
+
+    /*! \brief Drop any buffered data and clear the error state.
+     */
+    void Reset();
+
+private:
+    enum class Stage {
+        kHeaders,
+        kBody,
+    };
+
+    size_t maxFrameSize_ {kDefaultMaxFrameSize};
+    StompError error_ {StompError::kOk};
+
+    // The start of the frame that continues in the next chunk, and where we
+    // are in that frame.
+    std::string pending_ {};
+    Stage stage_ {Stage::kHeaders};
+    size_t bodyStart_ {0};
+    bool hasContentLength_ {false};
+    size_t contentLength_ {0};
+
+    // Find the end of the frame that starts at the beginning of the data.
+    // Returns the frame size, including the NULL octet, or 0 if the frame is
+    // incomplete. In that case, stage_ and the body information describe how
+    // far we got.
+    size_t FindFrameEnd(
+        const std::string_view data
+    );
+
+    // Consume the bytes of a chunk that belong to the pending frame.
+    // Returns the number of bytes consumed. Sets frameComplete if the pending
+    // buffer now holds a complete frame.
+    size_t ContinuePendingFrame(
+        const std::string_view chunk,
+        bool& frameComplete
+    );
+
+    // Read the content-length header, if any, from the headers of a frame.
+    StompError ReadContentLength(
+        const std::string_view headers
+    );
+
+    // Parse a complete frame and append it to the output.
+    StompError EmitFrame(
+        std::string&& plain,
+        std::pmr::vector<StompFrame>& frames
+    );
+};
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_STOMP_DECODER_H
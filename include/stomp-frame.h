@@ -1,10 +1,17 @@
 #ifndef NETWORK_MONITOR_STOMP_FRAME_H
 #define NETWORK_MONITOR_STOMP_FRAME_H
 
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
+
+#include <spdlog/fmt/fmt.h>
 
 namespace NetworkMonitor {
 
@@ -35,7 +42,7 @@ std::ostream& operator<<(std::ostream& os, const StompCommand& command);
 
 /*! \brief Convert `StompCommand` to string.
  */
-std::string ToString(const StompCommand& command);
+std::string_view ToString(const StompCommand& command);
 
 /*! \brief Available STOMP headers, from the STOMP protocol v1.2.
  */
@@ -68,7 +75,7 @@ std::ostream& operator<<(std::ostream& os, const StompHeader& header);
 
 /*! \brief Convert `StompHeader` to string.
  */
-std::string ToString(const StompHeader& header);
+std::string_view ToString(const StompHeader& header);
 
 /*! \brief Error codes for the STOMP protocol
  *
@@ -83,6 +90,7 @@ enum class StompError {
     kUndefinedError,
     kParsingEmptyHeaderValue,
     kParsingContentLengthExceedsFrameLength,
+    kParsingFrameTooLarge,
     kParsingInvalidContentLength,
     kParsingJunkAfterBody,
     kParsingMissingBlankLineAfterHeaders,
@@ -104,14 +112,17 @@ std::ostream& operator<<(std::ostream& os, const StompError& error);
 
 /*! \brief Convert `StompError` to string.
  */
-std::string ToString(const StompError& error);
+std::string_view ToString(const StompError& error);
 
 /* \brief STOMP frame representation, supporting STOMP v1.2.
  */
 class StompFrame {
 public:
-    // Type aliases
-    using Headers = std::unordered_map<StompHeader, std::string_view>;
+    /*! \brief Number of slots in the header table, one per `StompHeader`.
+     */
+    static constexpr size_t kNHeaders {
+        static_cast<size_t>(StompHeader::kVersion) + 1
+    };
 
     /*! \brief Default constructor. Corresponds to an empty, invalid STOMP
      *         frame.
@@ -147,6 +158,9 @@ public:
     );
 
     /*! \brief Copy constructor.
+     *
+     *  The frame is not re-parsed: This is a copy of the frame string and of
+     *  the header table.
      */
     StompFrame(const StompFrame& other);
 
@@ -174,37 +188,291 @@ public:
      *
      *  \returns An empty std::string_view if the header is not in the frame.
      */
-    const std::string_view& GetHeaderValue(const StompHeader& header) const;
+    std::string_view GetHeaderValue(const StompHeader& header) const;
 
     /*! \brief Get the frame body.
      */
-    const std::string_view& GetBody() const;
+    std::string_view GetBody() const;
+
+    /*! \brief Get the frame string, without copying it.
+     *
+     *  The reference is valid as long as the frame is alive and not modified.
+     */
+    const std::string& AsString() const;
 
     /*! \brief Dump the frame to string.
      */
-    std::string ToString() const;
+    std::string ToString() const&;
+
+    /*! \brief Hand out the frame string without copying it.
+     *
+     *  The frame is left empty.
+     */
+    std::string ToString() &&;
+
+    /*! \brief Hand out the body without allocating.
+     *
+     *  The body is moved to the front of the frame buffer, which is then
+     *  handed out. The frame is left empty.
+     */
+    std::string TakeBody() &&;
 
 private:
+    friend class StompFrameBuilder;
+    friend class StompFrameTemplate;
+
+    // Location of a header value or of the body in the plain data.
+    struct Span {
+        size_t offset {0};
+        size_t size {0};
+    };
+
+    using Headers = std::array<Span, kNHeaders>;
+
     std::string plain_ {};
 
-    // These are mostly views into the plain data; the storage overhead is
-    // limited.
+    // We store offsets into the plain data rather than views, so that the
+    // frame can be copied and moved without re-parsing. There is one fixed
+    // slot per header, so parsing a frame does not allocate. A header is
+    // present if its bit is set in the mask.
     StompCommand command_ {StompCommand::kInvalid};
     Headers headers_ {};
-    std::string_view body_ {};
+    std::uint32_t headerMask_ {0};
+    Span body_ {};
+
+    // Reset the frame to an empty, invalid frame.
+    void Clear();
 
     // Helper function to parse and validate a STOMP frame.
     StompError ParseAndValidateFrame(const std::string_view frame);
 
-    // This function parses a string view into separate items: A command, a map
-    // of headers, a body view.
+    // This function parses a string view into separate items: A command, a
+    // table of headers, a body location.
     StompError ParseFrame(const std::string_view frame);
 
     // This function validates the STOMP frame based on the parsed data
-    // (command, headers map, body view).
+    // (command, headers table, body location).
     StompError ValidateFrame();
 };
 
+/*! \brief Immutable, reference-counted STOMP frame.
+ *
+ *  Copies share the same frame buffer. Use this for frames that go to many
+ *  recipients, or that sit in queues and retry buffers.
+ */
+using SharedStompFrame = std::shared_ptr<const StompFrame>;
+
+/*! \brief Turn a frame into a shared, immutable frame, without copying it.
+ */
+SharedStompFrame MakeSharedStompFrame(StompFrame&& frame);
+
+/*! \brief Build a STOMP frame directly from its components.
+ *
+ *  The builder only stores views into the header values and the body, so they
+ *  must outlive the call to `Build`. `Build` computes the exact frame size,
+ *  writes the frame into a single buffer and records the header and body
+ *  locations as it writes. The frame is valid by construction: It is never
+ *  re-parsed.
+ *
+ *  Headers are written in the order they are added. If a header is added more
+ *  than once, only the first value is kept, as the parser would do.
+ */
+class StompFrameBuilder {
+public:
+    /*! \brief Start a frame for the specified command.
+     */
+    StompFrameBuilder(
+        const StompCommand& command
+    );
+
+    /*! \brief Add a header.
+     */
+    StompFrameBuilder& AddHeader(
+        const StompHeader& header,
+        const std::string_view value
+    );
+
+    /*! \brief Add a header with a numeric value, e.g. content-length.
+     *
+     *  The number is rendered without going through a temporary string.
+     */
+    StompFrameBuilder& AddHeader(
+        const StompHeader& header,
+        const size_t value
+    );
+
+    /*! \brief Set the frame body.
+     */
+    StompFrameBuilder& SetBody(
+        const std::string_view body
+    );
+
+    /*! \brief Write the frame.
+     *
+     *  On failure, the error code matches the one the parser would return for
+     *  the same frame, and the returned frame is empty. We check:
+     *  - Unrecognized headers and empty header values.
+     *  - Header values that contain an end of line. The parser would read the
+     *    rest of the value as a header line without a colon.
+     *  - NULL octets in the body, without a content-length header.
+     *  - The headers required by the command, and the content-length value.
+     */
+    StompFrame Build(
+        StompError& ec
+    ) const;
+
+private:
+    // Longest decimal rendering of a size_t.
+    static constexpr size_t kMaxDigits {20};
+
+    struct Header {
+        StompHeader header {StompHeader::kInvalid};
+        std::string_view value {};
+
+        // Numeric values are rendered here, and value is left empty.
+        std::array<char, kMaxDigits> digits {};
+        size_t nDigits {0};
+    };
+
+    StompCommand command_ {StompCommand::kInvalid};
+    std::array<Header, StompFrame::kNHeaders> headers_ {};
+    size_t nHeaders_ {0};
+    std::uint32_t headerMask_ {0};
+    std::string_view body_ {};
+
+    // The first error found while adding headers, reported by Build.
+    StompError error_ {StompError::kOk};
+
+    // Reserve the slot for a new header.
+    // Returns nullptr if the header should not be added.
+    Header* NewHeader(
+        const StompHeader& header
+    );
+};
+
+/*! \brief Pre-rendered STOMP frame with variable header values and body.
+ *
+ *  A template is made once, e.g. when a server or client is created. The
+ *  command line and the fixed headers are rendered and checked at that point.
+ *  `Render` then only writes the variable header values and the body after the
+ *  pre-rendered text.
+ *
+ *  If content-length is one of the variable headers, its value is not passed
+ *  to `Render`: It is computed from the body.
+ *
+ *  A template with no variable headers and no body renders a constant frame.
+ */
+class StompFrameTemplate {
+public:
+    /*! \brief Default constructor. The template renders invalid frames.
+     */
+    StompFrameTemplate() = default;
+
+    /*! \brief Pre-render the fixed part of a frame.
+     *
+     *  On failure, the error code matches the one `StompFrameBuilder` would
+     *  report, and the template renders invalid frames.
+     *
+     *  \param fixedHeaders    Headers with the same value in every frame.
+     *  \param variableHeaders Headers whose value is passed to `Render`, in
+     *                         this order.
+     */
+    StompFrameTemplate(
+        StompError& ec,
+        const StompCommand& command,
+        std::initializer_list<
+            std::pair<StompHeader, std::string_view>
+        > fixedHeaders,
+        std::initializer_list<StompHeader> variableHeaders = {}
+    );
+
+    /*! \brief Render a frame.
+     *
+     *  \param values One value for each variable header, except content-length,
+     *                in the order they were given to the constructor.
+     *
+     *  On failure, the error code matches the one `StompFrameBuilder` would
+     *  report for the same frame, and the returned frame is empty. A wrong
+     *  number of values is reported as `StompError::kValidationMissingHeader`.
+     */
+    StompFrame Render(
+        StompError& ec,
+        std::initializer_list<std::string_view> values = {},
+        const std::string_view body = {}
+    ) const;
+
+private:
+    // Longest decimal rendering of a size_t.
+    static constexpr size_t kMaxDigits {20};
+
+    StompCommand command_ {StompCommand::kInvalid};
+    StompError error_ {StompError::kValidationInvalidCommand};
+
+    // The command line and the fixed headers, with the location of their
+    // values.
+    std::string prefix_ {};
+    StompFrame::Headers fixedHeaders_ {};
+
+    // All headers, fixed and variable.
+    std::uint32_t headerMask_ {0};
+
+    std::array<StompHeader, StompFrame::kNHeaders> variableHeaders_ {};
+    size_t nVariableHeaders_ {0};
+    bool hasContentLength_ {false};
+};
+
 } // namespace NetworkMonitor
 
+/*! \brief fmt formatter for `StompCommand`, so that logging a command does not
+ *         go through an ostream.
+ */
+template <>
+struct fmt::formatter<NetworkMonitor::StompCommand>:
+    fmt::formatter<fmt::string_view> {
+    template <typename FormatContext>
+    auto format(
+        const NetworkMonitor::StompCommand& command,
+        FormatContext& ctx
+    )
+    {
+        const auto name {NetworkMonitor::ToString(command)};
+        return formatter<fmt::string_view>::format({name.data(), name.size()},
+                                                   ctx);
+    }
+};
+
+/*! \brief fmt formatter for `StompHeader`.
+ */
+template <>
+struct fmt::formatter<NetworkMonitor::StompHeader>:
+    fmt::formatter<fmt::string_view> {
+    template <typename FormatContext>
+    auto format(
+        const NetworkMonitor::StompHeader& header,
+        FormatContext& ctx
+    )
+    {
+        const auto name {NetworkMonitor::ToString(header)};
+        return formatter<fmt::string_view>::format({name.data(), name.size()},
+                                                   ctx);
+    }
+};
+
+/*! \brief fmt formatter for `StompError`.
+ */
+template <>
+struct fmt::formatter<NetworkMonitor::StompError>:
+    fmt::formatter<fmt::string_view> {
+    template <typename FormatContext>
+    auto format(
+        const NetworkMonitor::StompError& error,
+        FormatContext& ctx
+    )
+    {
+        const auto name {NetworkMonitor::ToString(error)};
+        return formatter<fmt::string_view>::format({name.data(), name.size()},
+                                                   ctx);
+    }
+};
+
 #endif // NETWORK_MONITOR_STOMP_FRAME_H
\ No newline at end of file
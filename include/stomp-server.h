@@ -1,6 +1,7 @@
 #ifndef NETWORK_MONITOR_STOMP_SERVER_H
 #define NETWORK_MONITOR_STOMP_SERVER_H
 
+#include <stomp-decoder.h>
 #include <stomp-frame.h>
 
 #include <boost/asio.hpp>
@@ -12,13 +13,17 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/ostr.h>
 
+#include <cstddef>
 #include <iomanip>
 #include <iostream>
 #include <functional>
+#include <memory_resource>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace NetworkMonitor {
 
@@ -45,7 +50,28 @@ std::ostream& operator<<(std::ostream& os, const StompServerError& m);
 
 /*! \brief Convert `StompServerError` to string.
  */
-std::string ToString(const StompServerError& m);
+std::string_view ToString(const StompServerError& m);
+
+} // namespace NetworkMonitor
+
+/*! \brief fmt formatter for `StompServerError`.
+ */
+template <>
+struct fmt::formatter<NetworkMonitor::StompServerError>:
+    fmt::formatter<fmt::string_view> {
+    template <typename FormatContext>
+    auto format(
+        const NetworkMonitor::StompServerError& error,
+        FormatContext& ctx
+    )
+    {
+        const auto name {NetworkMonitor::ToString(error)};
+        return formatter<fmt::string_view>::format({name.data(), name.size()},
+                                                   ctx);
+    }
+};
+
+namespace NetworkMonitor {
 
 /*! \brief STOMP server implementing the subset of commands needed by the
  *         quiet-route service.
@@ -74,20 +100,20 @@ public:
      *
      *  The user receives:
      *  - The ID of the connection that received the message.
-     *  - The message destination endpoint.
-     *  - The message request ID (optional, non-standard). The user may re-use
-     *    this request ID to send a response back to the client.
-     *  - The message content.
-     *  Owenship of the message content is passed to the caller. We assume
-     *  that the message content type is application/json.
+     *  - The SEND frame, as it was read from the WebSocket connection. The
+     *    destination endpoint, the request ID (id header, optional,
+     *    non-standard) and the message content are views into the frame. The
+     *    user may re-use the request ID to send a response back to the client.
+     *  The user can take ownership of the frame, e.g. with
+     *  `std::move(frame).TakeBody()`. If the frame is left alone, its buffer is
+     *  reused for the next messages. We assume that the message content type
+     *  is application/json.
      */
     using ClientMsgHandler = std::function<
         void (
             StompServerError ec,
             const std::string& clientConnectionId,
-            const std::string& destination,
-            const std::string& requestId,
-            std::string&& msgContent
+            StompFrame&& frame
         )
     >;
 
@@ -115,6 +141,7 @@ public:
         context_ {boost::asio::make_strand(ioc)}
     {
         spdlog::info("StompServer: New server on port {}", port);
+        RenderTemplates();
     }
 
     /*! \brief The copy constructor is deleted.
@@ -261,21 +288,14 @@ public:
         }
 
         auto requestId {userRequestId.empty() ? GenerateId() : userRequestId};
-        auto messageSize {messageContent.size()};
 
         // Assemble the SEND frame.
         StompError error {};
-        StompFrame frame {
+        auto frame {sendTemplate_.Render(
             error,
-            StompCommand::kSend,
-            {
-                {StompHeader::kId, requestId},
-                {StompHeader::kDestination, destination},
-                {StompHeader::kContentType, "application/json"},
-                {StompHeader::kContentLength, std::to_string(messageSize)},
-            },
-            messageContent,
-        };
+            {requestId, destination},
+            messageContent
+        )};
         if (error != StompError::kOk) {
             spdlog::error("StompServer: Could not create a valid frame: {}",
                           error);
@@ -286,10 +306,10 @@ public:
         spdlog::info("StompServer: [{}] Sending message to {}",
                      connectionId, destination);
         if (onSend == nullptr) {
-            wsSession->Send(frame.ToString());
+            wsSession->Send(std::move(frame).ToString());
         } else {
             wsSession->Send(
-                frame.ToString(),
+                std::move(frame).ToString(),
                 [requestId, onSend](auto ec) mutable {
                     auto error {ec ? StompServerError::kCouldNotSendMessage :
                                      StompServerError::kOk};
@@ -391,11 +411,23 @@ private:
     struct Connection {
         std::string id {};
         ConnectionStatus status {ConnectionStatus::kInvalid};
+        StompDecoder decoder {};
     };
 
+    // Scratch memory for the frames of one WebSocket message. A message
+    // usually holds a single frame, so this is enough in practice.
+    static constexpr size_t kMessageArenaSize {4096};
+    static constexpr size_t kMaxFramesInArena {4};
+
     const std::string kVersion_ {"1.2"};
     const std::string kHost_ {""};
 
+    // The frames we send are pre-rendered when the server is created. Only
+    // the per-connection and per-message fields are filled in later.
+    StompFrameTemplate connectedTemplate_ {};
+    StompFrameTemplate sendTemplate_ {};
+    std::vector<StompFrame> errorFrames_ {};
+
     // This strand handles all the STOMP-specific callbacks. These operations
     // are decoupled from the WebSocket operations.
     // We leave it uninitialized because it does not support a default
@@ -479,18 +511,44 @@ private:
             return;
         }
 
-        // Parse the message.
-        StompError error {};
-        StompFrame frame {error, std::move(msg)};
+        // Parse the message. A message usually holds a single frame, but the
+        // client may also batch frames or split them across messages.
+        // The frames live in an arena scoped to this message, whose memory we
+        // do not need to initialize.
+        alignas(StompFrame) std::byte arenaBuffer[kMessageArenaSize];
+        std::pmr::monotonic_buffer_resource arena {
+            arenaBuffer,
+            kMessageArenaSize
+        };
+        std::pmr::vector<StompFrame> frames {&arena};
+        frames.reserve(kMaxFramesInArena);
+        auto error {connection.decoder.Decode(std::move(msg), frames)};
+        for (auto& frame: frames) {
+            HandleFrame(wsSession, connection, std::move(frame));
+
+            // Frames the handlers did not take give their buffer back.
+            wsSession->ReleaseBuffer(std::move(frame).ToString());
+
+            // The frame handlers may close the connection.
+            if (connections_.find(wsSession) == connections_.end()) {
+                return;
+            }
+        }
         if (error != StompError::kOk) {
             CloseConnection(
                 connection,
                 wsSession,
                 StompServerError::kCouldNotParseFrame
             );
-            return;
         }
+    }
 
+    void HandleFrame(
+        std::shared_ptr<typename WsServer::Session> wsSession,
+        Connection& connection,
+        StompFrame&& frame
+    )
+    {
         // Decide what to do based on the STOMP command.
         auto command {frame.GetCommand()};
         spdlog::info("StompServer: [{}] Received {} frame",
@@ -510,7 +568,7 @@ private:
                     wsSession,
                     StompServerError::kUnsupportedFrame
                 );
-                return;
+                break;
             }
         }
     }
@@ -585,9 +643,8 @@ private:
         sessions_.erase(connection.id);
         connections_.erase(wsSession);
         if (error != StompServerError::kUndefinedError) {
-            wsSession->Send(MakeErrorFrame(
-                StompServerError::kUnsupportedFrame
-            ).ToString());
+            const auto& frame {errorFrames_[static_cast<size_t>(error)]};
+            wsSession->Send(frame.AsString());
         }
         wsSession->Close(onClose);
     }
@@ -637,14 +694,7 @@ private:
 
         // Send a CONNECTED frame.
         StompError error {};
-        StompFrame response {
-            error,
-            StompCommand::kConnected,
-            {
-                {StompHeader::kVersion, "1.2"},
-                {StompHeader::kSession, connection.id},
-            }
-        };
+        auto response {connectedTemplate_.Render(error, {connection.id})};
         if (error != StompError::kOk) {
             spdlog::error(
                 "StompServer: [{}] Unexpected: Could not create frame: {}",
@@ -652,7 +702,7 @@ private:
             );
             return;
         }
-        wsSession->Send(response.ToString());
+        wsSession->Send(std::move(response).ToString());
 
         // Call the user callback.
         if (onClientConnect_) {
@@ -686,53 +736,91 @@ private:
         }
 
         // Call the user callback.
+        // The frame buffer is the one the WebSocket message was read into, so
+        // the message reaches the user without being copied.
         if (onClientMessage_) {
             boost::asio::post(
                 context_,
                 [
                     onClientMessage = onClientMessage_,
+                    wsSession,
                     id = connection.id,
-                    destination = std::string(frame.GetHeaderValue(
-                        StompHeader::kDestination
-                    )),
-                    requestId = std::string(frame.GetHeaderValue(
-                        StompHeader::kId
-                    )),
-                    message = std::string(frame.GetBody())
+                    frame = std::move(frame)
                 ]() mutable {
                     onClientMessage(
                         StompServerError::kOk,
                         id,
-                        destination,
-                        requestId,
-                        std::move(message)
+                        std::move(frame)
                     );
+
+                    // If the user did not take the frame, its buffer goes back
+                    // to the pool.
+                    wsSession->ReleaseBuffer(std::move(frame).ToString());
                 }
             );
         }
     }
 
-    StompFrame MakeErrorFrame(
-        const StompServerError error
-    )
+    void RenderTemplates()
     {
-        StompError frameError {};
-        StompFrame frame {
-            frameError,
+        StompError error {};
+        connectedTemplate_ = StompFrameTemplate {
+            error,
+            StompCommand::kConnected,
+            {
+                {StompHeader::kVersion, kVersion_},
+            },
+            {StompHeader::kSession}
+        };
+        if (error != StompError::kOk) {
+            spdlog::error("StompServer: Unexpected: Could not create frame: {}",
+                          error);
+        }
+        sendTemplate_ = StompFrameTemplate {
+            error,
+            StompCommand::kSend,
+            {
+                {StompHeader::kContentType, "application/json"},
+            },
+            {
+                StompHeader::kId,
+                StompHeader::kDestination,
+                StompHeader::kContentLength,
+            }
+        };
+        if (error != StompError::kOk) {
+            spdlog::error("StompServer: Unexpected: Could not create frame: {}",
+                          error);
+        }
+
+        // The ERROR frames are constant, so we render one for each error.
+        // kWebSocketServerDisconnected is the last StompServerError.
+        StompFrameTemplate errorTemplate {
+            error,
             StompCommand::kError,
             {
                 {StompHeader::kContentType, "text/plain"},
                 {StompHeader::kVersion, kVersion_},
-            },
-            ToString(error)
+            }
         };
-        if (frameError != StompError::kOk) {
-            spdlog::error(
-                "StompServer: [{}] Unexpected: Could not create frame: {}",
-                error
-            );
+        const auto nErrors {static_cast<size_t>(
+            StompServerError::kWebSocketServerDisconnected
+        ) + 1};
+        errorFrames_.clear();
+        errorFrames_.reserve(nErrors);
+        for (size_t idx {0}; idx < nErrors; ++idx) {
+            errorFrames_.push_back(errorTemplate.Render(
+                error,
+                {},
+                ToString(static_cast<StompServerError>(idx))
+            ));
+            if (error != StompError::kOk) {
+                spdlog::error(
+                    "StompServer: Unexpected: Could not create frame: {}",
+                    error
+                );
+            }
         }
-        return frame;
     }
 
     std::string GenerateId()
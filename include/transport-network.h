@@ -5,10 +5,13 @@
 
 #include <nlohmann/json.hpp>
 
+#include <cstdint>
+#include <istream>
 #include <limits>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -20,6 +23,20 @@ namespace NetworkMonitor {
  */
 using Id = std::string;
 
+/*! \brief Dense station index.
+ *
+ *  Stations are numbered from 0 in the order in which they are added to a
+ *  `TransportNetwork`. A handle is only meaningful for the network that issued
+ *  it.
+ */
+using StationHandle = std::uint32_t;
+
+/*! \brief Handle value that does not refer to any station.
+ */
+constexpr StationHandle kInvalidStationHandle {
+    std::numeric_limits<StationHandle>::max()
+};
+
 /*! \brief Network station
  *
  *  A Station struct is well formed if:
@@ -93,7 +110,7 @@ struct Line {
 /*! \brief Passenger event
  */
 struct PassengerEvent {
-    enum class Type {
+    enum class Type : std::uint8_t {
         In,
         Out
     };
@@ -108,6 +125,44 @@ void from_json(
     PassengerEvent& dst
 );
 
+/*! \brief Compact passenger event record
+ *
+ *  This is the representation we use internally to ingest, store and replay
+ *  passenger events. The station is identified by its handle and the
+ *  timestamp is expressed in microseconds since the Unix epoch.
+ */
+struct PassengerEventRecord {
+    StationHandle station {kInvalidStationHandle};
+    PassengerEvent::Type type {PassengerEvent::Type::In};
+    std::int64_t timestampUs {0};
+};
+
+static_assert(sizeof(PassengerEventRecord) == 16,
+              "PassengerEventRecord should fit in 16 bytes");
+
+/*! \brief Number of passengers recorded at a station.
+ */
+struct StationCrowding {
+    Id stationId {};
+    long long int passengerCount {0};
+
+    bool operator==(const StationCrowding& other) const;
+};
+
+/* \brief Serialize StationCrowding to JSON.
+ */
+void to_json(
+    nlohmann::json& dst,
+    const StationCrowding& src
+);
+
+/* \brief Serialize StationCrowding from JSON.
+ */
+void from_json(
+    const nlohmann::json& src,
+    StationCrowding& dst
+);
+
 /*! \brief Travel plan between two stations.
  *
  *  If startStationId and endStationId are the same station, the travel steps
@@ -168,6 +223,61 @@ void from_json(
     TravelRoute& dst
 );
 
+/*! \brief Incremental change to a network layout
+ *
+ *  A delta is applied with `TransportNetwork::ApplyDelta`, in this order: New
+ *  stations, new lines, new routes of existing lines, travel times, closed
+ *  stations, reopened stations.
+ *
+ *  A closed station stays in the network, with its handle and its passenger
+ *  count, but travel routes cannot start at, end at, or go through it until
+ *  it is reopened.
+ */
+struct NetworkLayoutDelta {
+    /*! \brief Travel time between 2 adjacent stations
+     */
+    struct TravelTime {
+        Id startStationId {};
+        Id endStationId {};
+        unsigned int travelTime {0};
+    };
+
+    std::vector<Station> addedStations {};
+    std::vector<Line> addedLines {};
+    std::vector<Route> addedRoutes {};
+    std::vector<TravelTime> travelTimes {};
+    std::vector<Id> closedStations {};
+    std::vector<Id> reopenedStations {};
+};
+
+/*! \brief Deserialize NetworkLayoutDelta from JSON.
+ *
+ *  The delta uses the same item format as the network layout file. All keys
+ *  are optional:
+ *
+ *      {
+ *          "stations": [ <station>, ... ],
+ *          "lines": [ <line>, ... ],
+ *          "routes": [ <route>, ... ],
+ *          "travel_times": [ <travel time>, ... ],
+ *          "closed_stations": [ "<station_id>", ... ],
+ *          "reopened_stations": [ "<station_id>", ... ]
+ *      }
+ */
+void from_json(
+    const nlohmann::json& src,
+    NetworkLayoutDelta& dst
+);
+
+/*! \brief Stations and routes affected by a network layout delta
+ *
+ *  Both lists are sorted and do not contain duplicates.
+ */
+struct NetworkLayoutChanges {
+    std::vector<Id> stations {};
+    std::vector<Id> routes {};
+};
+
 /*! \brief Underground network representation
  */
 class TransportNetwork {
@@ -221,6 +331,28 @@ public:
         nlohmann::json&& src
     );
 
+    /*! \brief Populate the network from a JSON document, without building an
+     *         intermediate JSON object.
+     *
+     *  Stations, lines and travel times are added to the network as soon as
+     *  they are parsed. The sections of the document can come in any order:
+     *  Lines that appear before the stations, and travel times that appear
+     *  before the stations or the lines, are kept aside until they can be
+     *  added.
+     *
+     *  \returns false if stations and lines where parsed successfully, but not
+     *           the travel times.
+     *
+     *  \throws std::runtime_error This method throws if the document misses
+     *                             some required items, or if there was an
+     *                             issue adding new stations or lines to the
+     *                             network.
+     *  \throws nlohmann::json::parse_error If the document is not valid JSON.
+     */
+    bool FromJsonStream(
+        std::istream& src
+    );
+
     /*! \brief Add a station to the network.
      *
      *  \returns false if there was an error while adding the station to the
@@ -248,6 +380,40 @@ public:
         const Line& line
     );
 
+    /*! \brief Apply an incremental change to the network layout.
+     *
+     *  Only the stations, edges and indexes touched by the delta are updated.
+     *  Travel times that do not change a value, and closures of stations that
+     *  are already closed, are not reported as changes.
+     *
+     *  Station closures are not saved in network snapshots.
+     *
+     *  \param changes  Set to the stations and routes that changed, on
+     *                  success. A station changes if it was added, if one of
+     *                  its edges changed or if it was closed or reopened. A
+     *                  route changes if it was added, if one of its travel
+     *                  times changed or if one of its stops was closed or
+     *                  reopened.
+     *
+     *  \returns false if the delta is not consistent with the network: For
+     *           example, a new station or route that already exists, a stop
+     *           or a line that does not exist, or a travel time between
+     *           stations that are not adjacent. In this case, the network is
+     *           left untouched.
+     */
+    bool ApplyDelta(
+        const NetworkLayoutDelta& delta,
+        NetworkLayoutChanges& changes
+    );
+
+    /*! \brief Check whether a station was closed by a network layout delta.
+     *
+     *  \returns false if the station is not in the network.
+     */
+    bool IsStationClosed(
+        const Id& station
+    ) const;
+
     /*! \brief Record a passenger event at a station.
      *
      *  \returns false if the station is not in the network or if the passenger
@@ -257,6 +423,18 @@ public:
         const PassengerEvent& event
     );
 
+    /*! \brief Record a passenger event at a station, by station handle.
+     *
+     *  This is the ingestion fast path: It does not need to look up the
+     *  station by ID.
+     *
+     *  \returns false if the station handle is not valid for this network or
+     *           if the passenger event is not reconized.
+     */
+    bool RecordPassengerEvent(
+        const PassengerEventRecord& event
+    );
+
     /*! \brief Get the number of passengers currently recorded at a station.
      *
      *  The returned number can be negative: This happens if we start recording
@@ -268,7 +446,119 @@ public:
     long long int GetPassengerCount(
         const Id& station
     ) const;
-    
+
+    /*! \brief Get the number of passengers currently recorded at a station,
+     *         by station handle.
+     *
+     *  \throws std::runtime_error if the station handle is not valid for this
+     *          network.
+     */
+    long long int GetPassengerCount(
+        const StationHandle station
+    ) const;
+
+    /*! \brief Get the handle of a station.
+     *
+     *  Station handles are dense: They go from 0 to the number of stations in
+     *  the network, in the order in which stations were added.
+     *
+     *  \throws std::runtime_error if the station is not in the network.
+     */
+    StationHandle GetStationHandle(
+        const Id& station
+    ) const;
+
+    /*! \brief Get the handle of a station, if it is in the network.
+     *
+     *  \returns `kInvalidStationHandle` if the station is not in the network.
+     */
+    StationHandle FindStationHandle(
+        const std::string_view station
+    ) const;
+
+    /*! \brief Get the number of stations in the network.
+     */
+    size_t GetNStations() const;
+
+    /*! \brief Get all the stations in the network, ordered by station handle.
+     */
+    std::vector<Station> GetStations() const;
+
+    /*! \brief Get all the lines in the network, with their routes.
+     *
+     *  Lines and routes are sorted by ID. The network does not keep the route
+     *  directions, so they are left empty.
+     */
+    std::vector<Line> GetLines() const;
+
+    /*! \brief Get the number of passengers currently recorded across all the
+     *         stations served by a line route.
+     *
+     *  The count is maintained incrementally as passenger events are recorded,
+     *  so this is a constant-time lookup.
+     *
+     *  \throws std::runtime_error if the line or route is not in the network.
+     */
+    long long int GetRoutePassengerCount(
+        const Id& line,
+        const Id& route
+    ) const;
+
+    /*! \brief Get the number of passengers currently recorded across all the
+     *         stations served by a line.
+     *
+     *  Each station is counted once, even if it is served by multiple routes
+     *  of the same line. The count is maintained incrementally as passenger
+     *  events are recorded, so this is a constant-time lookup.
+     *
+     *  \throws std::runtime_error if the line is not in the network.
+     */
+    long long int GetLinePassengerCount(
+        const Id& line
+    ) const;
+
+    /*! \brief Get the k stations with the highest passenger count.
+     *
+     *  Stations are sorted by decreasing passenger count. Stations with the
+     *  same passenger count are sorted in the order in which they were added to
+     *  the network.
+     *
+     *  The ranking is maintained incrementally as passenger events are
+     *  recorded, so this method only costs O(k log k).
+     */
+    std::vector<StationCrowding> GetMostCrowdedStations(
+        const size_t k
+    ) const;
+
+    /*! \brief Get the passenger count of every station.
+     *
+     *  \returns A vector indexed by station handle.
+     */
+    std::vector<long long int> GetPassengerCounts() const;
+
+    /*! \brief Overwrite the passenger count of every station.
+     *
+     *  Route and line aggregates and the crowding ranking are updated
+     *  accordingly. Stations with an unchanged count cost nothing.
+     *
+     *  \param passengerCounts A vector indexed by station handle, as returned
+     *                         by `GetPassengerCounts`.
+     *
+     *  \returns false if the vector size does not match the number of stations
+     *           in the network. In this case, no count is changed.
+     */
+    bool SetPassengerCounts(
+        const std::vector<long long int>& passengerCounts
+    );
+
+    /*! \brief Get a hash of the network stations.
+     *
+     *  Two networks have the same hash if they have the same stations, added
+     *  in the same order, so that station handles are interchangeable between
+     *  them.
+     */
+    std::uint64_t GetLayoutHash() const;
+
     /*! \brief Set the network representation crowding..
      *
      *  This method can be used when testing to pre-seed the network with the
@@ -380,9 +670,19 @@ private:
     struct GraphNode {
         Id id {};
         std::string name {};
+        StationHandle handle {0};
         long long int passengerCount {0};
         std::vector<std::shared_ptr<GraphEdge>> edges {};
 
+        // Closed stations are skipped by the path-finding algorithms.
+        bool closed {false};
+
+        // Fan-out lists of the routes and lines serving this station, including
+        // the routes that end here. We use them to keep the route and line
+        // crowding aggregates up to date on every passenger event.
+        std::vector<std::shared_ptr<RouteInternal>> routes {};
+        std::vector<std::shared_ptr<LineInternal>> lines {};
+
         // Find the edge for a specific line route.
         std::vector<
             std::shared_ptr<GraphEdge>
@@ -405,6 +705,9 @@ private:
         Id id {};
         std::shared_ptr<LineInternal> line {nullptr};
         std::vector<std::shared_ptr<GraphNode>> stops {};
+
+        // Sum of the passenger counts of all stops.
+        long long int passengerCount {0};
     };
 
     // Internal line representation
@@ -413,6 +716,9 @@ private:
         Id id {};
         std::string name {};
         std::unordered_map<Id, std::shared_ptr<RouteInternal>> routes {};
+
+        // Sum of the passenger counts of all the stations served by the line.
+        long long int passengerCount {0};
     };
 
     // A PathStop object represents a stop and the network edge to get to it.
@@ -459,6 +765,20 @@ private:
     std::unordered_map<Id, std::shared_ptr<GraphNode>> stations_ {};
     std::unordered_map<Id, std::shared_ptr<LineInternal>> lines_ {};
 
+    // All stations, indexed by their handle.
+    std::vector<std::shared_ptr<GraphNode>> stationsByHandle_ {};
+
+    // Indexed max-heap of station handles, ordered by passenger count. We keep
+    // the position of each station in the heap so that we can restore the
+    // heap property in O(log n) after every passenger event.
+    std::vector<StationHandle> crowdingHeap_ {};
+    std::vector<size_t> crowdingHeapPos_ {};
+
+    // Number of stations with a negative passenger count. As long as this is
+    // zero, the partial crowding of a path is a lower bound for its total
+    // crowding, which lets us prune quiet route candidates early.
+    size_t nNegativeStations_ {0};
+
     // Get station by ID.
     std::shared_ptr<GraphNode> GetStation(
         const Id& stationId
@@ -480,7 +800,41 @@ private:
         const Route& route,
         const std::shared_ptr<LineInternal>& lineInternal
     );
+
+    // Register a line with all the stops of one of its routes.
+    void AddLineToStops(
+        const std::shared_ptr<LineInternal>& lineInternal,
+        const std::shared_ptr<RouteInternal>& routeInternal
+    );
+
+    // Check a network layout delta against the network, without changing it.
+    bool IsValidDelta(
+        const NetworkLayoutDelta& delta
+    ) const;
     
+    // Apply a passenger count change to a station and to the crowding
+    // aggregates of all the routes and lines serving it.
+    void UpdatePassengerCount(
+        const std::shared_ptr<GraphNode>& station,
+        const long long int delta
+    );
+
+    // Crowding heap helpers.
+    bool IsMoreCrowded(
+        const StationHandle a,
+        const StationHandle b
+    ) const;
+    void SwapInCrowdingHeap(
+        const size_t posA,
+        const size_t posB
+    );
+    void SiftUpInCrowdingHeap(
+        size_t pos
+    );
+    void SiftDownInCrowdingHeap(
+        size_t pos
+    );
+
     // Internal version of GetFastestTravelRoute.
     // We pass station A as a PathStopDist instance instead of as a GraphNode
     // pointer to allow for warm starts, i.e. paths that start with a pre-set
@@ -504,8 +858,12 @@ private:
     ) const;
 
     // Get the total crowding over a given path.
+    // If the partial crowding exceeds stopAbove and it is known to be a lower
+    // bound for the total crowding, we stop early and return the partial
+    // crowding.
     unsigned int GetPathCrowding(
-        const Path& path
+        const Path& path,
+        const unsigned int stopAbove = std::numeric_limits<unsigned int>::max()
     ) const;
 };
 
@@ -1,8 +1,13 @@
 #ifndef WEBSOCKET_CLIENT_HPP
 #define WEBSOCKET_CLIENT_HPP
 
+#include "buffer-pool.h"
+
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 
 #include <boost/asio.hpp>
 #include <boost/system/error_code.hpp>
@@ -112,6 +117,18 @@ public:
         );
     }
 
+    /*! \brief Give a received message buffer back once it is consumed.
+     *
+     *  The next received messages reuse the buffer memory. Releasing a buffer
+     *  is optional.
+     */
+    void ReleaseBuffer(
+        std::string&& buffer
+    )
+    {
+        m_bufferPool->Release(std::move(buffer));
+    }
+
     /*! \brief Close the WebSocket connection.
      *
      *  \param onClose Called when the connection is closed, successfully or
@@ -143,7 +160,15 @@ public:
     boost::system::error_code m_ec;
     WebSocketStream m_ws;
     Resolver m_resolver;
-    boost::beast::flat_buffer m_readBuffer;
+    // Messages are read straight into a pooled buffer, which is then handed
+    // over to the user. The dynamic buffer only wraps the string during a
+    // read.
+    using ReadBuffer = decltype(boost::asio::dynamic_buffer(
+        std::declval<std::string&>()
+    ));
+    std::shared_ptr<BufferPool> m_bufferPool {std::make_shared<BufferPool>()};
+    std::string m_readMessage;
+    std::optional<ReadBuffer> m_readBuffer;
 
     private:
     std::function<void (boost::system::error_code)> m_onConnect {nullptr};
@@ -289,15 +314,16 @@ public:
         size_t size
     )
     {
+        m_readBuffer.reset();
+        auto message {std::move(m_readMessage)};
         if(ec)
         {
+            m_bufferPool->Release(std::move(message));
             return;
         }
         
         spdlog::debug("WebSocketClient: Received {}-byte message", size);
 
-        std::string message(boost::beast::buffers_to_string(m_readBuffer.data()));
-        m_readBuffer.consume(size);
         if (m_onMessage)
         {
             m_onMessage(ec, std::move(message));
@@ -320,7 +346,9 @@ public:
             return;
         }
         
-        m_ws.async_read(m_readBuffer, 
+        m_readMessage = m_bufferPool->Acquire(0);
+        m_readBuffer.emplace(m_readMessage);
+        m_ws.async_read(*m_readBuffer, 
             [this](auto ec, auto size)
             {
                 OnRead(ec, size);
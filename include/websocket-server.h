@@ -7,6 +7,8 @@
 #include <boost/beast/ssl.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "buffer-pool.h"
+
 #include <openssl/ssl.h>
 
 #include <spdlog/spdlog.h>
@@ -16,7 +18,9 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 
 namespace NetworkMonitor {
 
@@ -59,13 +63,18 @@ public:
      *
      *  \note This constructor is mostly used by the WebSocketServer class.
      *
-     *  \param socket   A socket object with an active TCP connection.
-     *  \param ctx      The TLS context to setup a TLS socket stream.
+     *  \param socket     A socket object with an active TCP connection.
+     *  \param ctx        The TLS context to setup a TLS socket stream.
+     *  \param bufferPool The pool of buffers for the received messages. If not
+     *                    provided, the session uses its own pool.
      */
     WebSocketSession(
         boost::asio::ip::tcp::socket&& socket,
-        boost::asio::ssl::context& ctx
-    ) : ws_ {std::move(socket), ctx}
+        boost::asio::ssl::context& ctx,
+        std::shared_ptr<BufferPool> bufferPool = nullptr
+    ) : ws_ {std::move(socket), ctx},
+        bufferPool_ {bufferPool ? std::move(bufferPool) :
+                                  std::make_shared<BufferPool>()}
     {
     }
 
@@ -95,6 +104,18 @@ public:
         });
     }
 
+    /*! \brief Give a received message buffer back once it is consumed.
+     *
+     *  The next received messages reuse the buffer memory. Releasing a buffer
+     *  is optional.
+     */
+    void ReleaseBuffer(
+        std::string&& buffer
+    )
+    {
+        bufferPool_->Release(std::move(buffer));
+    }
+
     /*! \brief Close the WebSocket connection.
      *
      *  \param onClose Called when the connection is closed, successfully or
@@ -128,7 +149,15 @@ private:
     MsgHandler onMessage_ {nullptr};
     Handler onDisconnect_ {nullptr};
 
-    boost::beast::flat_buffer rBuffer_ {};
+    // Messages are read straight into a pooled buffer, which is then handed
+    // over to the user. The dynamic buffer only wraps the string during a
+    // read.
+    using ReadBuffer = decltype(boost::asio::dynamic_buffer(
+        std::declval<std::string&>()
+    ));
+    std::shared_ptr<BufferPool> bufferPool_ {nullptr};
+    std::string rMessage_ {};
+    std::optional<ReadBuffer> rBuffer_ {};
 
     bool closed_ {false};
 
@@ -276,7 +305,9 @@ private:
         // Note: Here we copy `self` (std::shared_ptr) into the lambda,
         //       effectively prolonging the lifetime of this object at least
         //       until the async_read callback is called.
-        ws_.async_read(rBuffer_, [self](auto ec, auto nBytes) {
+        rMessage_ = bufferPool_->Acquire(0);
+        rBuffer_.emplace(rMessage_);
+        ws_.async_read(*rBuffer_, [self](auto ec, auto nBytes) {
             self->OnRead(ec, nBytes);
             self->ListenToIncomingMessage(ec);
         });
@@ -288,18 +319,19 @@ private:
     )
     {
         auto self {this->shared_from_this()};
+        rBuffer_.reset();
+        auto message {std::move(rMessage_)};
 
         // We just ignore messages that failed to read.
         if (ec) {
+            bufferPool_->Release(std::move(message));
             return;
         }
         spdlog::debug("WebSocketSession: [{}] Received {}-byte message",
                       self, nBytes);
 
-        // Parse the message and forward it to the user callback.
+        // Forward the message to the user callback.
         // Note: This call is synchronous and will block the WebSocket strand.
-        std::string message {boost::beast::buffers_to_string(rBuffer_.data())};
-        rBuffer_.consume(nBytes);
         if (onMessage_) {
             onMessage_(ec, self, std::move(message));
         }
@@ -464,6 +496,9 @@ private:
 
     bool stopped_ {false};
 
+    // All sessions share the pool of buffers for the received messages.
+    std::shared_ptr<BufferPool> bufferPool_ {std::make_shared<BufferPool>()};
+
     typename Session::Handler onSessionConnect_ {nullptr};
     typename Session::MsgHandler onSessionMessage_ {nullptr};
     typename Session::Handler onSessionDisconnect_ {nullptr};
@@ -508,7 +543,11 @@ private:
 
         // Create a new WebSocket session. We pass ownership of the socket to
         // the new WebSocket session.
-        auto session {std::make_shared<Session>(std::move(socket), ctx_)};
+        auto session {std::make_shared<Session>(
+            std::move(socket),
+            ctx_,
+            bufferPool_
+        )};
         spdlog::info("WebSocketServer: Creating new session: [{}]", session);
         session->Connect(
             onSessionConnect_,
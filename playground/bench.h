@@ -0,0 +1,78 @@
+#ifndef NETWORK_MONITOR_PLAYGROUND_BENCH_H
+#define NETWORK_MONITOR_PLAYGROUND_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace NetworkMonitor::Bench {
+
+/*! \brief Prevent the compiler from optimizing away a computed value.
+ */
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/*! \brief Run a function repeatedly and return the best time per run, in
+ *         seconds.
+ *
+ *  The first run is a warm-up and is not measured.
+ */
+template <typename Function>
+double Measure(
+    Function&& function,
+    const size_t nRuns = 5
+)
+{
+    function();
+    double best {1e300};
+    for (size_t run {0}; run < nRuns; ++run) {
+        const auto start {std::chrono::steady_clock::now()};
+        function();
+        const std::chrono::duration<double> elapsed {
+            std::chrono::steady_clock::now() - start
+        };
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/*! \brief Print a throughput line, for example: "json  1.2e+06 events/s".
+ */
+inline void Report(
+    const std::string& name,
+    const size_t nItems,
+    const double seconds,
+    const std::string& unit
+)
+{
+    std::printf("%-32s %12.4g %s/s  (%.1f ns/%s)\n",
+                name.c_str(), nItems / seconds, unit.c_str(),
+                seconds * 1e9 / nItems, unit.c_str());
+}
+
+/*! \brief Print a throughput line with the data rate and the allocations per
+ *         item, for example:
+ *         "parse  85.2 ns/frame  610.3 MB/s  1.0 allocs/frame".
+ */
+inline void Report(
+    const std::string& name,
+    const size_t nItems,
+    const size_t nBytes,
+    const double seconds,
+    const size_t nAllocations,
+    const std::string& unit
+)
+{
+    std::printf("%-40s %10.1f ns/%s %10.1f MB/s %6.1f allocs/%s\n",
+                name.c_str(), seconds * 1e9 / nItems, unit.c_str(),
+                nBytes / seconds / 1e6,
+                static_cast<double>(nAllocations) / nItems, unit.c_str());
+}
+
+} // namespace NetworkMonitor::Bench
+
+#endif // NETWORK_MONITOR_PLAYGROUND_BENCH_H
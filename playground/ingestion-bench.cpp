@@ -0,0 +1,106 @@
+#include "bench.h"
+
+#include <crowding-time-series.h>
+#include <file-downloader.h>
+#include <passenger-event-batcher.h>
+#include <passenger-event-journal.h>
+#include <transport-network.h>
+
+#include <boost/asio.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NetworkMonitor;
+
+// Apply a burst of passenger events through the ingestion stage, with
+// different maximum batch sizes. A batch size of 1 is the event-at-a-time
+// behavior.
+int main()
+{
+    TransportNetwork network {};
+    if (!network.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))) {
+        std::cerr << "Could not load the network layout\n";
+        return -1;
+    }
+    const auto nStations {network.GetNStations()};
+
+    // A burst of events, all arriving in the same I/O drain.
+    constexpr size_t nEvents {200'000};
+    std::vector<PassengerEventRecord> events(nEvents);
+    std::mt19937 rng {42};
+    std::uniform_int_distribution<StationHandle> station {
+        0, static_cast<StationHandle>(nStations - 1)
+    };
+    std::int64_t timestampUs {1'604'215'080'000'000};
+    for (auto& event: events) {
+        event.station = station(rng);
+        event.type = rng() % 2 == 0 ? PassengerEvent::Type::In :
+                                      PassengerEvent::Type::Out;
+        event.timestampUs = timestampUs;
+        timestampUs += 1000;
+    }
+
+    const auto journalDir {
+        std::filesystem::temp_directory_path() / "mnm-ingestion-bench"
+    };
+    std::cout << nEvents << " passenger events, " << nStations
+              << " stations\n";
+
+    for (const size_t maxBatchSize: {1, 16, 256, 1024}) {
+        std::filesystem::remove_all(journalDir);
+        PassengerEventJournal journal {journalDir};
+        if (!journal.Open(network.GetLayoutHash())) {
+            std::cerr << "Could not open the journal in " << journalDir
+                      << "\n";
+            return -1;
+        }
+        CrowdingTimeSeries history {nStations};
+        IngestionMetrics metrics {};
+
+        auto time {Bench::Measure([&]() {
+            boost::asio::io_context ioc {};
+            PassengerEventBatcher batcher {
+                ioc,
+                [&](const auto& batch) {
+                    for (const auto& event: batch) {
+                        network.RecordPassengerEvent(event);
+                        history.Record(
+                            event.station,
+                            event.timestampUs,
+                            network.GetPassengerCount(event.station)
+                        );
+                    }
+                    if (batch.size() == 1) {
+                        journal.Append(batch.front());
+                    } else {
+                        journal.Append(batch);
+                    }
+                },
+                maxBatchSize,
+                std::chrono::microseconds {1000}
+            };
+            for (const auto& event: events) {
+                boost::asio::post(ioc, [&batcher, &event]() {
+                    batcher.Push(event);
+                });
+            }
+            ioc.run();
+            metrics = batcher.GetMetrics();
+        })};
+        journal.Close();
+
+        Bench::Report("maxBatchSize " + std::to_string(maxBatchSize), nEvents,
+                      time, "event");
+        std::cout << "    mean batch " << metrics.GetMeanBatchSize()
+                  << ", max latency " << metrics.maxBatchLatency.count()
+                  << " us, max queue depth " << metrics.maxQueueDepth << "\n";
+    }
+    std::filesystem::remove_all(journalDir);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "bench.h"
+
+#include <file-downloader.h>
+#include <message-decoders.h>
+#include <transport-network.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace NetworkMonitor;
+
+// Compare the schema-specific decoders with nlohmann::json on the passenger
+// events in the test data.
+int main()
+{
+    // We benchmark the events with their original formatting, one per line.
+    std::ifstream file {std::filesystem::path(TEST_DATA) /
+                        "passenger_events.json"};
+    std::vector<std::string> messages {};
+    std::string line {};
+    while (std::getline(file, line)) {
+        auto begin {line.find('{')};
+        auto end {line.rfind('}')};
+        if (begin == std::string::npos || end == std::string::npos) {
+            continue;
+        }
+        messages.push_back(line.substr(begin, end - begin + 1));
+    }
+    if (messages.empty()) {
+        std::cerr << "No passenger events found\n";
+        return -1;
+    }
+    std::cout << messages.size() << " passenger events\n";
+
+    auto jsonTime {Bench::Measure([&messages]() {
+        for (const auto& message: messages) {
+            PassengerEvent event = nlohmann::json::parse(message);
+            Bench::DoNotOptimize(event);
+        }
+    })};
+    Bench::Report("nlohmann::json + from_json", messages.size(), jsonTime,
+                  "event");
+
+    auto decodeTime {Bench::Measure([&messages]() {
+        for (const auto& message: messages) {
+            PassengerEventMessage event {};
+            DecodePassengerEventMessage(message, event);
+            Bench::DoNotOptimize(event);
+        }
+    })};
+    Bench::Report("DecodePassengerEventMessage", messages.size(), decodeTime,
+                  "event");
+
+    auto parseTime {Bench::Measure([&messages]() {
+        for (const auto& message: messages) {
+            PassengerEvent event {};
+            ParsePassengerEvent(message, event);
+            Bench::DoNotOptimize(event);
+        }
+    })};
+    Bench::Report("ParsePassengerEvent", messages.size(), parseTime, "event");
+
+    // Compact records, as used for ingestion
+    TransportNetwork network {};
+    if (!network.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))) {
+        std::cerr << "Could not load the network layout\n";
+        return -1;
+    }
+    auto recordTime {Bench::Measure([&messages, &network]() {
+        for (const auto& message: messages) {
+            PassengerEventRecord event {};
+            ParsePassengerEvent(message, network, event);
+            Bench::DoNotOptimize(event);
+        }
+    })};
+    Bench::Report("ParsePassengerEvent (record)", messages.size(),
+                  recordTime, "event");
+
+    // Timestamps alone
+    const std::string datetime {"2021-01-03T22:08:08.813000Z"};
+    const size_t nTimestamps {1'000'000};
+    auto boostTime {Bench::Measure([&datetime]() {
+        for (size_t idx {0}; idx < nTimestamps / 10; ++idx) {
+            auto timestamp {boost::posix_time::from_iso_extended_string(
+                datetime.substr(0, datetime.size() - 1)
+            )};
+            Bench::DoNotOptimize(timestamp);
+        }
+    })};
+    Bench::Report("from_iso_extended_string", nTimestamps / 10, boostTime,
+                  "timestamp");
+    auto isoTime {Bench::Measure([&datetime]() {
+        for (size_t idx {0}; idx < nTimestamps; ++idx) {
+            std::int64_t timestampUs {0};
+            ParseIso8601Timestamp(datetime, timestampUs);
+            Bench::DoNotOptimize(timestampUs);
+        }
+    })};
+    Bench::Report("ParseIso8601Timestamp", nTimestamps, isoTime, "timestamp");
+
+    // Quiet-route requests
+    const std::string request {
+        "{\"start_station_id\":\"station_080\","
+        "\"end_station_id\":\"station_018\"}"
+    };
+    const size_t nRequests {100'000};
+    auto requestJsonTime {Bench::Measure([&request]() {
+        for (size_t idx {0}; idx < nRequests; ++idx) {
+            auto messageJson = nlohmann::json::parse(request);
+            auto start {messageJson.at("start_station_id").get<Id>()};
+            auto end {messageJson.at("end_station_id").get<Id>()};
+            Bench::DoNotOptimize(start);
+            Bench::DoNotOptimize(end);
+        }
+    })};
+    Bench::Report("nlohmann::json (quiet-route)", nRequests, requestJsonTime,
+                  "request");
+
+    auto requestDecodeTime {Bench::Measure([&request]() {
+        for (size_t idx {0}; idx < nRequests; ++idx) {
+            QuietRouteRequestMessage decoded {};
+            DecodeQuietRouteRequestMessage(request, decoded);
+            Bench::DoNotOptimize(decoded);
+        }
+    })};
+    Bench::Report("DecodeQuietRouteRequestMessage", nRequests,
+                  requestDecodeTime, "request");
+    return 0;
+}
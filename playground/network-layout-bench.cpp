@@ -0,0 +1,173 @@
+#include "bench.h"
+
+#include <file-downloader.h>
+#include <transport-network.h>
+
+#include <nlohmann/json.hpp>
+
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NetworkMonitor;
+
+// Peak resident set size of the process so far, in MB.
+static double GetPeakMemoryMb()
+{
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+// Write a synthetic layout with nLines lines, each with an inbound and an
+// outbound route through nStops stations. nStations must not be a multiple
+// of 7919.
+static void WriteSyntheticLayout(
+    const std::filesystem::path& path,
+    const size_t nStations,
+    const size_t nLines,
+    const size_t nStops
+)
+{
+    std::mt19937 rng {42};
+    std::uniform_int_distribution<size_t> station {0, nStations - 1};
+    auto stationId {[](size_t idx) {
+        return "\"station_" + std::to_string(idx) + "\"";
+    }};
+
+    std::ofstream file {path};
+    std::vector<std::vector<size_t>> stops(nLines);
+    file << "{\"lines\":[";
+    for (size_t line {0}; line < nLines; ++line) {
+        // A fixed stride that is coprime with the number of stations keeps
+        // the stops of a route distinct.
+        const auto start {station(rng)};
+        for (size_t stop {0}; stop < nStops; ++stop) {
+            stops[line].push_back((start + stop * 7919) % nStations);
+        }
+        const auto lineId {"\"line_" + std::to_string(line) + "\""};
+        file << (line == 0 ? "" : ",") << "{\"line_id\":" << lineId
+             << ",\"name\":\"Line " << line << "\",\"routes\":[";
+        for (const auto* direction: {"inbound", "outbound"}) {
+            const bool inbound {direction[0] == 'i'};
+            file << (inbound ? "" : ",") << "{\"line_id\":" << lineId
+                 << ",\"route_id\":\"route_" << line << "_" << direction
+                 << "\",\"direction\":\"" << direction << "\""
+                 << ",\"start_station_id\":"
+                 << stationId(inbound ? stops[line].front() :
+                                        stops[line].back())
+                 << ",\"end_station_id\":"
+                 << stationId(inbound ? stops[line].back() :
+                                        stops[line].front())
+                 << ",\"route_stops\":[";
+            for (size_t stop {0}; stop < nStops; ++stop) {
+                const auto idx {inbound ? stop : nStops - 1 - stop};
+                file << (stop == 0 ? "" : ",") << stationId(stops[line][idx]);
+            }
+            file << "]}";
+        }
+        file << "]}";
+    }
+    file << "],\"stations\":[";
+    for (size_t idx {0}; idx < nStations; ++idx) {
+        file << (idx == 0 ? "" : ",") << "{\"station_id\":" << stationId(idx)
+             << ",\"name\":\"Station " << idx << "\"}";
+    }
+    file << "],\"travel_times\":[";
+    bool first {true};
+    for (const auto& lineStops: stops) {
+        for (size_t stop {1}; stop < lineStops.size(); ++stop) {
+            file << (first ? "" : ",") << "{\"start_station_id\":"
+                 << stationId(lineStops[stop - 1]) << ",\"end_station_id\":"
+                 << stationId(lineStops[stop]) << ",\"travel_time\":"
+                 << 1 + stop % 5 << "}";
+            first = false;
+        }
+    }
+    file << "]}";
+}
+
+static void BenchLayout(
+    const std::filesystem::path& path,
+    const size_t nRuns
+)
+{
+    const auto size {std::filesystem::file_size(path)};
+    std::cout << path.filename().string() << ": " << size / 1024 << " KB\n";
+
+    // We measure the streaming loader first, so that the peak memory it
+    // reaches is not hidden by the one of the DOM loader.
+    const auto startMemoryMb {GetPeakMemoryMb()};
+    auto streamTime {Bench::Measure([&path]() {
+        TransportNetwork network {};
+        std::ifstream file {path};
+        Bench::DoNotOptimize(network.FromJsonStream(file));
+    }, nRuns)};
+    const auto streamMemoryMb {GetPeakMemoryMb()};
+    Bench::Report("  FromJsonStream", size, streamTime, "byte");
+
+    auto domTime {Bench::Measure([&path]() {
+        TransportNetwork network {};
+        Bench::DoNotOptimize(network.FromJson(ParseJsonFile(path)));
+    }, nRuns)};
+    const auto domMemoryMb {GetPeakMemoryMb()};
+    Bench::Report("  ParseJsonFile + FromJson", size, domTime, "byte");
+
+    std::printf("  startup: %.1f ms (stream) vs %.1f ms (DOM)\n",
+                streamTime * 1e3, domTime * 1e3);
+    std::printf("  peak memory growth: %.1f MB (stream), %.1f MB (DOM)\n",
+                streamMemoryMb - startMemoryMb, domMemoryMb - startMemoryMb);
+
+    // Update 10 travel times with a delta instead of reloading the layout.
+    // Every run sets new values, so that all the edges actually change.
+    TransportNetwork network {};
+    {
+        std::ifstream file {path};
+        network.FromJsonStream(file);
+    }
+    NetworkLayoutDelta delta {};
+    for (const auto& line: network.GetLines()) {
+        const auto& stops {line.routes.front().stops};
+        for (size_t stop {1}; stop < stops.size(); ++stop) {
+            if (delta.travelTimes.size() < 10) {
+                delta.travelTimes.push_back({stops[stop - 1], stops[stop], 0});
+            }
+        }
+    }
+    unsigned int travelTime {0};
+    NetworkLayoutChanges changes {};
+    auto deltaTime {Bench::Measure([&]() {
+        ++travelTime;
+        for (auto& edge: delta.travelTimes) {
+            edge.travelTime = travelTime;
+        }
+        Bench::DoNotOptimize(network.ApplyDelta(delta, changes));
+    }, 1000)};
+    Bench::Report("  ApplyDelta (10 travel times)", delta.travelTimes.size(),
+                  deltaTime, "edge");
+    std::printf("  delta: %.2f us, %.0fx faster than FromJsonStream\n",
+                deltaTime * 1e6, streamTime / deltaTime);
+}
+
+// Compare the time to load a network layout with and without an intermediate
+// JSON DOM, and to update it with a small delta, on the test layout and on a
+// large synthetic layout.
+int main()
+{
+    BenchLayout(TESTS_NETWORK_LAYOUT_JSON, 10);
+
+    const auto syntheticPath {
+        std::filesystem::temp_directory_path() / "mnm-synthetic-layout.json"
+    };
+    WriteSyntheticLayout(syntheticPath, 200'000, 2'000, 150);
+    BenchLayout(syntheticPath, 2);
+    std::filesystem::remove(syntheticPath);
+
+    return 0;
+}
@@ -75,7 +75,7 @@ int main()
     };
 
     auto onMessage{
-        [&client, &onClose](auto ec, auto dst, auto&& message){
+        [&client, &onClose](auto ec, auto&& frame){
             if(ec!=NetworkMonitor::StompClientError::kOk)
             {
                 spdlog::error("QuietRouteClient: Error in receiving message from server");
@@ -83,7 +83,7 @@ int main()
             }
             spdlog::info("QuietRouteClient: Response received from Server");
             NetworkMonitor::TravelRoute quietRoute{};
-            quietRoute = nlohmann::json::parse(message);
+            quietRoute = nlohmann::json::parse(frame.GetBody());
             spdlog::info("QuietRouteClient: Travel route received, closing connection.");
             nlohmann::json to_file;            
             NetworkMonitor::to_json(to_file, quietRoute);
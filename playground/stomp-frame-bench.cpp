@@ -0,0 +1,214 @@
+#include "bench.h"
+
+#include <stomp-frame.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace NetworkMonitor;
+using namespace std::string_literals;
+
+// We count the allocations of the benchmarked code by replacing the global
+// allocation functions.
+static size_t nAllocations {0};
+
+void* operator new(size_t size)
+{
+    ++nAllocations;
+    if (auto ptr {std::malloc(size > 0 ? size : 1)}) {
+        return ptr;
+    }
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// Run a function over nFrames frames and report its speed and the
+// allocations it makes.
+template <typename Function>
+static void Run(
+    const std::string& name,
+    const size_t nFrames,
+    const size_t frameSize,
+    Function&& function
+)
+{
+    auto seconds {Bench::Measure(function)};
+    nAllocations = 0;
+    function();
+    Bench::Report(name, nFrames, nFrames * frameSize, seconds, nAllocations,
+                  "frame");
+}
+
+// A quiet-route response with nSteps steps, as sent by the network monitor.
+static std::string MakeQuietRoute(
+    const size_t nSteps
+)
+{
+    std::string route {
+        "{\"start_station_id\":\"station_000\","
+        "\"end_station_id\":\"station_999\","
+        "\"total_travel_time\":" + std::to_string(2 * nSteps) + ","
+        "\"steps\":["
+    };
+    for (size_t idx {0}; idx < nSteps; ++idx) {
+        route += idx == 0 ? "{" : ",{";
+        route += "\"start_station_id\":\"station_" + std::to_string(idx) +
+                 "\",\"end_station_id\":\"station_" + std::to_string(idx + 1) +
+                 "\",\"line_id\":\"line_000\",\"route_id\":\"route_000\","
+                 "\"travel_time\":2}";
+    }
+    route += "]}";
+    return route;
+}
+
+// Measure the parser, the serializer and the builder on the STOMP frames we
+// exchange with the network events service and the quiet-route clients.
+int main()
+{
+    const std::string passengerEvent {
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"out\",\"station_id\":\"station_227\"}"
+    };
+    const auto quietRoute {MakeQuietRoute(100)};
+
+    struct Case {
+        std::string name {};
+        std::string plain {};
+    };
+    const std::vector<Case> cases {
+        {
+            "STOMP",
+            "STOMP\n"
+            "accept-version:1.2\n"
+            "host:ltnm.learncppthroughprojects.com\n"
+            "login:some_user\n"
+            "passcode:some_password_123\n"
+            "\n"
+            "\0"s
+        },
+        {
+            "CONNECTED",
+            "CONNECTED\n"
+            "version:1.2\n"
+            "session:2c4eddb4-5ec2-4d53-9da0-8d4e7d2d8a7b\n"
+            "\n"
+            "\0"s
+        },
+        {
+            "MESSAGE passenger event",
+            "MESSAGE\n"
+            "subscription:3e5e3b1e-2c36-4d8c-9a0e-4c4a5c3b6f0d\n"
+            "message-id:9d2f6e0e-1d6a-4f1e-8a1c-2e7f6d5c4b3a\n"
+            "destination:/passengers\n"
+            "content-type:application/json\n"
+            "\n" + passengerEvent + "\0"s
+        },
+        {
+            "MESSAGE passenger event, length",
+            "MESSAGE\n"
+            "subscription:3e5e3b1e-2c36-4d8c-9a0e-4c4a5c3b6f0d\n"
+            "message-id:9d2f6e0e-1d6a-4f1e-8a1c-2e7f6d5c4b3a\n"
+            "destination:/passengers\n"
+            "content-type:application/json\n"
+            "content-length:" + std::to_string(passengerEvent.size()) + "\n"
+            "\n" + passengerEvent + "\0"s
+        },
+        {
+            "SEND quiet-route",
+            "SEND\n"
+            "id:0a1b2c3d-4e5f-6789-abcd-ef0123456789\n"
+            "destination:/quiet-route\n"
+            "content-type:application/json\n"
+            "\n" + quietRoute + "\0"s
+        },
+        {
+            "SEND quiet-route, length",
+            "SEND\n"
+            "id:0a1b2c3d-4e5f-6789-abcd-ef0123456789\n"
+            "destination:/quiet-route\n"
+            "content-type:application/json\n"
+            "content-length:" + std::to_string(quietRoute.size()) + "\n"
+            "\n" + quietRoute + "\0"s
+        },
+    };
+
+    for (const auto& [name, plain]: cases) {
+        StompError error {};
+        const StompFrame parsed {error, plain};
+        if (error != StompError::kOk) {
+            std::cerr << name << ": Invalid frame: " << error << "\n";
+            return -1;
+        }
+        const size_t nFrames {std::max<size_t>(1'000,
+                                               20'000'000 / plain.size())};
+        std::cout << "\n" << name << " (" << plain.size() << " bytes, "
+                  << nFrames << " frames)\n";
+
+        // The parser takes the frame by copy or by move. We measure the copy
+        // alone, so that it can be subtracted from the parser time.
+        Run("copy", nFrames, plain.size(), [&plain, nFrames]() {
+            for (size_t idx {0}; idx < nFrames; ++idx) {
+                std::string copy {plain};
+                Bench::DoNotOptimize(copy);
+            }
+        });
+        Run("parse + validate", nFrames, plain.size(), [&plain, nFrames]() {
+            for (size_t idx {0}; idx < nFrames; ++idx) {
+                StompError error {};
+                StompFrame frame {error, plain};
+                Bench::DoNotOptimize(frame);
+            }
+        });
+
+        // Serialization
+        Run("ToString", nFrames, plain.size(), [&parsed, nFrames]() {
+            for (size_t idx {0}; idx < nFrames; ++idx) {
+                auto copy {parsed.ToString()};
+                Bench::DoNotOptimize(copy);
+            }
+        });
+        std::unordered_map<StompHeader, std::string> headers {};
+        for (size_t header {1}; header < StompFrame::kNHeaders; ++header) {
+            const auto key {static_cast<StompHeader>(header)};
+            if (parsed.HasHeader(key)) {
+                headers[key] = std::string {parsed.GetHeaderValue(key)};
+            }
+        }
+        const std::string body {parsed.GetBody()};
+        const auto command {parsed.GetCommand()};
+        Run("StompFrame(command, headers, body)", nFrames, plain.size(), [&]() {
+            for (size_t idx {0}; idx < nFrames; ++idx) {
+                StompError error {};
+                StompFrame frame {error, command, headers, body};
+                Bench::DoNotOptimize(frame);
+            }
+        });
+        Run("StompFrameBuilder", nFrames, plain.size(), [&]() {
+            for (size_t idx {0}; idx < nFrames; ++idx) {
+                StompFrameBuilder builder {command};
+                for (const auto& [header, value]: headers) {
+                    builder.AddHeader(header, value);
+                }
+                StompError error {};
+                auto frame {builder.SetBody(body).Build(error)};
+                Bench::DoNotOptimize(frame);
+            }
+        });
+    }
+    return 0;
+}
@@ -1,14 +1,110 @@
 #include "transport-network.h"
 #include "file-downloader.h"
+#include "network-snapshot.h"
+#include "passenger-event-journal.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <string>
+#include <vector>
 
 using namespace NetworkMonitor;
 
-int main()
+// Rebuild the passenger counts from a journal and report the replay speed.
+// Usage: transport-network-tool replay <network layout> <journal directory>
+int Replay(
+    const std::filesystem::path& layoutFile,
+    const std::filesystem::path& journalDirectory
+)
 {
+    TransportNetwork nw;
+    if (!nw.FromJson(ParseJsonFile(layoutFile)))
+    {
+        std::cerr << "JSON file invalid\n";
+        return -1;
+    }
+
+    std::vector<long long int> passengerCounts(nw.GetNStations(), 0);
+    auto start = std::chrono::steady_clock::now();
+    auto nEvents = ReplayPassengerEventJournal(
+        journalDirectory,
+        nw.GetLayoutHash(),
+        passengerCounts);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    nw.SetPassengerCounts(passengerCounts);
+
+    std::cout << "Replayed " << nEvents << " events in "
+              << elapsed.count() << " s ("
+              << nEvents / std::max(elapsed.count(), 1e-9) << " events/s)\n";
+    for (const auto& station: nw.GetMostCrowdedStations(10))
+    {
+        std::cout << station.stationId << ": " << station.passengerCount
+                  << "\n";
+    }
+    return 0;
+}
+
+// Compile a JSON network layout into a binary snapshot and compare the time
+// to load either file.
+// Usage: transport-network-tool compile <network layout> <snapshot>
+int Compile(
+    const std::filesystem::path& layoutFile,
+    const std::filesystem::path& snapshotFile
+)
+{
+    TransportNetwork nw;
+    auto start = std::chrono::steady_clock::now();
+    std::ifstream layout(layoutFile);
+    if (!nw.FromJsonStream(layout))
+    {
+        std::cerr << "JSON file invalid\n";
+        return -1;
+    }
+    std::chrono::duration<double> jsonElapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::uint64_t sourceHash = 0;
+    if (!HashFile(layoutFile, sourceHash) ||
+        !WriteNetworkSnapshot(snapshotFile, nw, sourceHash))
+    {
+        std::cerr << "Failed to write the snapshot\n";
+        return -1;
+    }
+
+    TransportNetwork loaded;
+    start = std::chrono::steady_clock::now();
+    if (!ReadNetworkSnapshot(snapshotFile, loaded, sourceHash))
+    {
+        std::cerr << "Failed to read back the snapshot\n";
+        return -1;
+    }
+    std::chrono::duration<double> snapshotElapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::cout << "Compiled " << nw.GetNStations() << " stations: "
+              << std::filesystem::file_size(layoutFile) << " bytes -> "
+              << std::filesystem::file_size(snapshotFile) << " bytes\n"
+              << "Load time: " << jsonElapsed.count() * 1e3 << " ms (JSON), "
+              << snapshotElapsed.count() * 1e3 << " ms (snapshot)\n";
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 4 && std::string(argv[1]) == "replay")
+    {
+        return Replay(argv[2], argv[3]);
+    }
+    if (argc == 4 && std::string(argv[1]) == "compile")
+    {
+        return Compile(argv[2], argv[3]);
+    }
+
     TransportNetwork nw;
     auto j = ParseJsonFile(std::filesystem::path(EXAMPLE_NETWORK_LAYOUT));
     bool ok = nw.FromJson(std::move(j));
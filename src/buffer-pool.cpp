@@ -0,0 +1,67 @@
+#include "buffer-pool.h"
+
+#include <mutex>
+#include <string>
+#include <utility>
+
+using NetworkMonitor::BufferPool;
+
+// BufferPool — Public methods
+
+BufferPool::BufferPool(
+    const size_t maxBuffers,
+    const size_t maxBufferCapacity
+) : maxBuffers_ {maxBuffers},
+    maxBufferCapacity_ {maxBufferCapacity}
+{
+    buffers_.reserve(maxBuffers_);
+}
+
+std::string BufferPool::Acquire(
+    const size_t size
+)
+{
+    std::string buffer {};
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if (!buffers_.empty()) {
+            // The most recently released buffer is the most likely to be in
+            // the cache.
+            buffer = std::move(buffers_.back());
+            buffers_.pop_back();
+        }
+        if (buffer.capacity() < size) {
+            ++nAllocations_;
+        }
+    }
+    buffer.reserve(size);
+    return buffer;
+}
+
+void BufferPool::Release(
+    std::string&& buffer
+)
+{
+    // A default-constructed string has the capacity of its inline storage.
+    if (buffer.capacity() <= std::string {}.capacity() ||
+        buffer.capacity() > maxBufferCapacity_) {
+        return;
+    }
+    buffer.clear();
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (buffers_.size() < maxBuffers_) {
+        buffers_.push_back(std::move(buffer));
+    }
+}
+
+size_t BufferPool::GetNBuffers() const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return buffers_.size();
+}
+
+size_t BufferPool::GetNAllocations() const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return nAllocations_;
+}
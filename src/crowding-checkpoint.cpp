@@ -0,0 +1,138 @@
+#include "crowding-checkpoint.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace bip = boost::interprocess;
+
+// Checkpoint file layout. All fields are in the host byte order: Checkpoints
+// are meant to survive a restart of the process, not to be moved across
+// machines.
+struct CheckpointHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t layoutHash;
+    std::uint64_t nStations;
+    std::uint64_t checksum;
+};
+
+static constexpr std::array<char, 8> kMagic {
+    'M', 'N', 'M', 'C', 'K', 'P', 'T', '\0'
+};
+static constexpr std::uint32_t kVersion {1};
+
+// FNV-1a hash of the passenger counts, to detect torn or corrupted files.
+static std::uint64_t Checksum(
+    const long long int* passengerCounts,
+    const size_t nStations
+)
+{
+    std::uint64_t hash {14695981039346656037ull};
+    const auto* bytes {reinterpret_cast<const unsigned char*>(passengerCounts)};
+    for (size_t idx {0}; idx < nStations * sizeof(long long int); ++idx) {
+        hash ^= bytes[idx];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool NetworkMonitor::WriteCrowdingCheckpoint(
+    const std::filesystem::path& file,
+    const std::uint64_t layoutHash,
+    const std::vector<long long int>& passengerCounts
+)
+{
+    auto tmpFile {file};
+    tmpFile += ".tmp";
+    const auto nBytes {
+        sizeof(CheckpointHeader) +
+        passengerCounts.size() * sizeof(long long int)
+    };
+    try {
+        // Create the temporary file with its final size, so we can map it.
+        {
+            std::ofstream out {tmpFile, std::ios::binary | std::ios::trunc};
+            if (!out) {
+                return false;
+            }
+        }
+        std::filesystem::resize_file(tmpFile, nBytes);
+
+        {
+            bip::file_mapping mapping {tmpFile.c_str(), bip::read_write};
+            bip::mapped_region region {mapping, bip::read_write, 0, nBytes};
+            auto* data {static_cast<char*>(region.get_address())};
+            CheckpointHeader header {
+                kMagic,
+                kVersion,
+                0,
+                layoutHash,
+                passengerCounts.size(),
+                Checksum(passengerCounts.data(), passengerCounts.size()),
+            };
+            std::memcpy(data, &header, sizeof(header));
+            std::memcpy(data + sizeof(header), passengerCounts.data(),
+                        passengerCounts.size() * sizeof(long long int));
+            if (!region.flush(0, nBytes, false)) {
+                std::filesystem::remove(tmpFile);
+                return false;
+            }
+        }
+
+        // The rename is atomic: Readers either see the old or the new file.
+        std::filesystem::rename(tmpFile, file);
+    } catch (const std::exception&) {
+        std::error_code ec {};
+        std::filesystem::remove(tmpFile, ec);
+        return false;
+    }
+    return true;
+}
+
+bool NetworkMonitor::ReadCrowdingCheckpoint(
+    const std::filesystem::path& file,
+    const std::uint64_t layoutHash,
+    std::vector<long long int>& passengerCounts
+)
+{
+    std::error_code ec {};
+    const auto fileSize {std::filesystem::file_size(file, ec)};
+    if (ec || fileSize < sizeof(CheckpointHeader)) {
+        return false;
+    }
+    try {
+        bip::file_mapping mapping {file.c_str(), bip::read_only};
+        bip::mapped_region region {mapping, bip::read_only};
+        const auto* data {static_cast<const char*>(region.get_address())};
+        CheckpointHeader header {};
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != kMagic ||
+            header.version != kVersion ||
+            header.layoutHash != layoutHash ||
+            fileSize != sizeof(header) +
+                        header.nStations * sizeof(long long int)) {
+            return false;
+        }
+        std::vector<long long int> counts(header.nStations);
+        std::memcpy(counts.data(), data + sizeof(header),
+                    counts.size() * sizeof(long long int));
+        if (Checksum(counts.data(), counts.size()) != header.checksum) {
+            return false;
+        }
+        passengerCounts = std::move(counts);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,356 @@
+#include "crowding-time-series.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::CrowdingSample;
+using NetworkMonitor::CrowdingTimeSeries;
+using NetworkMonitor::StationHandle;
+
+// Utility functions for the varint encoding.
+// Signed values are zigzag-encoded first, so that small negative values also
+// encode to few bytes.
+
+static std::uint64_t ZigZagEncode(const std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^
+        static_cast<std::uint64_t>(value >> 63);
+}
+
+static std::int64_t ZigZagDecode(const std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^
+        -static_cast<std::int64_t>(value & 1);
+}
+
+static size_t WriteVarint(std::uint64_t value, std::uint8_t* out)
+{
+    size_t nBytes {0};
+    while (value >= 0x80) {
+        out[nBytes++] = static_cast<std::uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[nBytes++] = static_cast<std::uint8_t>(value);
+    return nBytes;
+}
+
+static std::uint64_t ReadVarint(const std::uint8_t* in, size_t& offset)
+{
+    std::uint64_t value {0};
+    unsigned int shift {0};
+    while (true) {
+        const auto byte {in[offset++]};
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+        shift += 7;
+    }
+}
+
+// CrowdingSample — Public methods
+
+bool CrowdingSample::operator==(const CrowdingSample& other) const
+{
+    return timestampUs == other.timestampUs &&
+        passengerCount == other.passengerCount;
+}
+
+// CrowdingTimeSeries — Public methods
+
+CrowdingTimeSeries::CrowdingTimeSeries(
+    const size_t nStations,
+    const std::chrono::microseconds resolution,
+    const std::chrono::microseconds retention
+) : resolutionUs_ {std::max<std::int64_t>(resolution.count(), 1)},
+    retentionUs_ {retention.count()},
+    series_(nStations)
+{
+}
+
+size_t CrowdingTimeSeries::GetNStations() const
+{
+    return series_.size();
+}
+
+bool CrowdingTimeSeries::Record(
+    const StationHandle station,
+    const std::int64_t timestampUs,
+    const long long int passengerCount
+)
+{
+    if (station >= series_.size()) {
+        return false;
+    }
+    auto& series {series_[station]};
+
+    // Align the sample to the start of its resolution interval.
+    auto intervalUs {timestampUs - timestampUs % resolutionUs_};
+    if (timestampUs < 0 && timestampUs % resolutionUs_ != 0) {
+        intervalUs -= resolutionUs_;
+    }
+
+    // Events in the current interval, or late events, update the pending
+    // sample. Only a newer interval causes the pending sample to be
+    // compressed.
+    if (series.hasPending && intervalUs <= series.pending.timestampUs) {
+        series.pending.passengerCount = passengerCount;
+        return true;
+    }
+    if (series.hasPending) {
+        Append(series, series.pending);
+    }
+    series.pending = {intervalUs, passengerCount};
+    series.hasPending = true;
+
+    // Drop the blocks that fell out of the retention window.
+    while (!series.blocks.empty() &&
+           series.blocks.front().lastTimestampUs < intervalUs - retentionUs_) {
+        series.blocks.pop_front();
+    }
+    return true;
+}
+
+void CrowdingTimeSeries::Remap(
+    const std::vector<StationHandle>& newHandles,
+    const size_t nStations
+)
+{
+    // Moving a series only moves its block deque, not the samples.
+    std::vector<Series> series(nStations);
+    const auto nMapped {std::min(newHandles.size(), series_.size())};
+    for (size_t station {0}; station < nMapped; ++station) {
+        const auto newHandle {newHandles[station]};
+        if (newHandle < nStations) {
+            series[newHandle] = std::move(series_[station]);
+        }
+    }
+    series_ = std::move(series);
+}
+
+std::vector<CrowdingSample> CrowdingTimeSeries::GetRange(
+    const StationHandle station,
+    const std::int64_t fromUs,
+    const std::int64_t toUs
+) const
+{
+    std::vector<CrowdingSample> samples {};
+    if (station >= series_.size()) {
+        return samples;
+    }
+    Visit(series_[station], fromUs, [&](const CrowdingSample& sample) {
+        if (sample.timestampUs > toUs) {
+            return false;
+        }
+        if (sample.timestampUs >= fromUs) {
+            samples.push_back(sample);
+        }
+        return true;
+    });
+    return samples;
+}
+
+std::vector<CrowdingSample> CrowdingTimeSeries::GetDownsampled(
+    const StationHandle station,
+    const std::int64_t fromUs,
+    const std::int64_t toUs,
+    const std::int64_t stepUs
+) const
+{
+    std::vector<CrowdingSample> samples {};
+    if (station >= series_.size() || stepUs <= 0 || toUs < fromUs) {
+        return samples;
+    }
+    samples.reserve((toUs - fromUs) / stepUs + 1);
+
+    // We walk the series once, emitting the latest known value every time we
+    // cross an output time.
+    auto nextUs {fromUs};
+    bool hasPrevious {false};
+    CrowdingSample previous {};
+    const auto& series {series_[station]};
+    Visit(series, fromUs, [&](const CrowdingSample& sample) {
+        while (nextUs <= toUs && sample.timestampUs > nextUs) {
+            if (hasPrevious) {
+                samples.push_back({nextUs, previous.passengerCount});
+            }
+            nextUs += stepUs;
+        }
+        previous = sample;
+        hasPrevious = true;
+        return nextUs <= toUs;
+    });
+    while (hasPrevious && nextUs <= toUs) {
+        samples.push_back({nextUs, previous.passengerCount});
+        nextUs += stepUs;
+    }
+    return samples;
+}
+
+std::vector<long long int> CrowdingTimeSeries::GetNetworkLoadAt(
+    const std::int64_t timestampUs,
+    const size_t nThreads
+) const
+{
+    std::vector<long long int> load(series_.size(), 0);
+    auto scan {[this, &load, timestampUs](size_t begin, size_t end) {
+        CrowdingSample sample {};
+        for (size_t idx {begin}; idx < end; ++idx) {
+            if (GetSampleAt(series_[idx], timestampUs, sample)) {
+                load[idx] = sample.passengerCount;
+            }
+        }
+    }};
+
+    // Each worker scans a contiguous range of stations and writes to its own
+    // slice of the output vector, so no synchronization is needed.
+    auto nWorkers {nThreads > 0 ? nThreads :
+                                  std::max(std::thread::hardware_concurrency(),
+                                           1u)};
+    nWorkers = std::min<size_t>(nWorkers, series_.size());
+    if (nWorkers <= 1) {
+        scan(0, series_.size());
+        return load;
+    }
+    std::vector<std::thread> workers {};
+    workers.reserve(nWorkers);
+    const auto chunkSize {(series_.size() + nWorkers - 1) / nWorkers};
+    for (size_t begin {0}; begin < series_.size(); begin += chunkSize) {
+        workers.emplace_back(scan, begin,
+                             std::min(begin + chunkSize, series_.size()));
+    }
+    for (auto& worker: workers) {
+        worker.join();
+    }
+    return load;
+}
+
+size_t CrowdingTimeSeries::GetMemoryUsage(
+    const StationHandle station
+) const
+{
+    if (station >= series_.size()) {
+        return 0;
+    }
+    return sizeof(Series) + series_[station].blocks.size() * sizeof(Block);
+}
+
+size_t CrowdingTimeSeries::GetMemoryUsage() const
+{
+    size_t nBytes {sizeof(*this)};
+    for (StationHandle station {0}; station < series_.size(); ++station) {
+        nBytes += GetMemoryUsage(station);
+    }
+    return nBytes;
+}
+
+// CrowdingTimeSeries — Private methods
+
+void CrowdingTimeSeries::Append(
+    Series& series,
+    const CrowdingSample& sample
+)
+{
+    // Start a new block if there is no room for a worst-case sample.
+    if (series.blocks.empty() ||
+        series.blocks.back().nBytes + kMaxSampleSize > kBlockSize) {
+        auto& block {series.blocks.emplace_back()};
+        block.firstTimestampUs = sample.timestampUs;
+        block.firstPassengerCount = sample.passengerCount;
+        block.lastTimestampUs = sample.timestampUs;
+        block.lastDeltaUs = 0;
+        block.lastPassengerCount = sample.passengerCount;
+        block.nSamples = 1;
+        return;
+    }
+
+    auto& block {series.blocks.back()};
+    const auto deltaUs {sample.timestampUs - block.lastTimestampUs};
+    const auto deltaOfDeltaUs {deltaUs - block.lastDeltaUs};
+    const auto valueXor {ZigZagEncode(sample.passengerCount) ^
+                         ZigZagEncode(block.lastPassengerCount)};
+    auto* out {block.data.data() + block.nBytes};
+    size_t nBytes {WriteVarint(ZigZagEncode(deltaOfDeltaUs), out)};
+    nBytes += WriteVarint(valueXor, out + nBytes);
+    block.nBytes += static_cast<std::uint16_t>(nBytes);
+    block.nSamples += 1;
+    block.lastTimestampUs = sample.timestampUs;
+    block.lastDeltaUs = deltaUs;
+    block.lastPassengerCount = sample.passengerCount;
+}
+
+template <typename Visitor>
+void CrowdingTimeSeries::Visit(
+    const Series& series,
+    const std::int64_t fromUs,
+    Visitor&& visitor
+) const
+{
+    for (const auto& block: series.blocks) {
+        if (block.lastTimestampUs < fromUs) {
+            continue;
+        }
+        CrowdingSample sample {
+            block.firstTimestampUs,
+            block.firstPassengerCount,
+        };
+        if (!visitor(sample)) {
+            return;
+        }
+        std::int64_t deltaUs {0};
+        size_t offset {0};
+        while (offset < block.nBytes) {
+            deltaUs += ZigZagDecode(ReadVarint(block.data.data(), offset));
+            const auto valueXor {ReadVarint(block.data.data(), offset)};
+            sample.timestampUs += deltaUs;
+            sample.passengerCount = ZigZagDecode(
+                ZigZagEncode(sample.passengerCount) ^ valueXor
+            );
+            if (!visitor(sample)) {
+                return;
+            }
+        }
+    }
+    if (series.hasPending && series.pending.timestampUs >= fromUs) {
+        visitor(series.pending);
+    }
+}
+
+bool CrowdingTimeSeries::GetSampleAt(
+    const Series& series,
+    const std::int64_t timestampUs,
+    CrowdingSample& sample
+) const
+{
+    // The latest sample at or before the requested time can only be in the
+    // last block that starts at or before that time, or in the pending sample.
+    if (series.hasPending && series.pending.timestampUs <= timestampUs) {
+        sample = series.pending;
+        return true;
+    }
+    auto blockIt {std::upper_bound(
+        series.blocks.begin(),
+        series.blocks.end(),
+        timestampUs,
+        [](const std::int64_t timestampUs, const Block& block) {
+            return timestampUs < block.firstTimestampUs;
+        }
+    )};
+    if (blockIt == series.blocks.begin()) {
+        return false;
+    }
+    --blockIt;
+    bool found {false};
+    Visit(series, blockIt->firstTimestampUs, [&](const CrowdingSample& s) {
+        if (s.timestampUs > timestampUs) {
+            return false;
+        }
+        sample = s;
+        found = true;
+        return true;
+    });
+    return found;
+}
@@ -1,11 +1,148 @@
 #include "file-downloader.h"
+#include "network-snapshot.h"
+
+#include <boost/asio.hpp>
 
 #include <curl/curl.h>
 
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <stdio.h>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+// Response validators and content hash of a cached file.
+struct CacheEntry {
+    std::string url {};
+    std::string etag {};
+    std::string lastModified {};
+    std::uint64_t contentHash {0};
+};
+
+static void ConfigureCurl(
+    CURL* curl,
+    const std::string& fileUrl,
+    const std::filesystem::path& caCertFile
+)
+{
+    curl_easy_setopt(curl, CURLOPT_URL, fileUrl.c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_CAINFO, caCertFile.string().c_str());
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+
+    // Ask for a compressed transfer. curl decodes the body before writing it.
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip");
+}
+
+// Append the response body to a string.
+static size_t OnBody(
+    char* buffer,
+    size_t size,
+    size_t nItems,
+    void* userData
+)
+{
+    auto* content {static_cast<std::string*>(userData)};
+    content->append(buffer, size * nItems);
+    return size * nItems;
+}
+
+// Collect the ETag and Last-Modified headers of the response.
+static size_t OnHeader(
+    char* buffer,
+    size_t size,
+    size_t nItems,
+    void* userData
+)
+{
+    auto* entry {static_cast<CacheEntry*>(userData)};
+    const std::string_view line {buffer, size * nItems};
+
+    // A new status line starts a new response, for example after a redirect.
+    if (line.rfind("HTTP/", 0) == 0) {
+        entry->etag.clear();
+        entry->lastModified.clear();
+        return line.size();
+    }
+    const auto colon {line.find(':')};
+    if (colon == std::string_view::npos) {
+        return line.size();
+    }
+    std::string name {line.substr(0, colon)};
+    std::transform(name.begin(), name.end(), name.begin(), [](auto c) {
+        return std::tolower(static_cast<unsigned char>(c));
+    });
+    auto value {line.substr(colon + 1)};
+    const auto start {value.find_first_not_of(" \t")};
+    const auto end {value.find_last_not_of(" \t\r\n")};
+    value = start == std::string_view::npos ?
+        std::string_view {} : value.substr(start, end - start + 1);
+    if (name == "etag") {
+        entry->etag = value;
+    } else if (name == "last-modified") {
+        entry->lastModified = value;
+    }
+    return line.size();
+}
+
+static bool ReadCacheEntry(
+    const std::filesystem::path& metaFile,
+    CacheEntry& entry
+)
+{
+    try {
+        std::ifstream file {metaFile};
+        if (!file) {
+            return false;
+        }
+        auto meta = nlohmann::json::parse(file);
+        entry.url = meta.at("url").get<std::string>();
+        entry.etag = meta.at("etag").get<std::string>();
+        entry.lastModified = meta.at("last_modified").get<std::string>();
+        entry.contentHash = meta.at("content_hash").get<std::uint64_t>();
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+static bool WriteCacheEntry(
+    const std::filesystem::path& metaFile,
+    const CacheEntry& entry
+)
+{
+    nlohmann::json meta {};
+    meta["url"] = entry.url;
+    meta["etag"] = entry.etag;
+    meta["last_modified"] = entry.lastModified;
+    meta["content_hash"] = entry.contentHash;
+    std::ofstream file {metaFile};
+    file << meta.dump(4);
+    return static_cast<bool>(file);
+}
+
+// The name of the cached copy is the last segment of the URL path.
+static std::string GetCacheFileName(
+    const std::string& fileUrl
+)
+{
+    const std::string_view url {fileUrl};
+    const auto path {url.substr(0, url.find_first_of("?#"))};
+    const auto slash {path.find_last_of('/')};
+    const auto name {
+        slash == std::string_view::npos ? path : path.substr(slash + 1)
+    };
+    return name.empty() ? "download" : std::string {name};
+}
 
 bool NetworkMonitor::DownloadFile(
     const std::string& fileUrl,
@@ -28,11 +165,7 @@ bool NetworkMonitor::DownloadFile(
     }
 
     // Configure curl.
-    curl_easy_setopt(curl, CURLOPT_URL, fileUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_CAINFO, caCertFile.string().c_str());
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+    ConfigureCurl(curl, fileUrl, caCertFile);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
 
     // Perform the request.
@@ -45,6 +178,143 @@ bool NetworkMonitor::DownloadFile(
     return res == CURLE_OK;
 }
 
+bool NetworkMonitor::DownloadFileToMemory(
+    const std::string& fileUrl,
+    std::string& content,
+    const std::filesystem::path& caCertFile
+)
+{
+    CURL* curl {curl_easy_init()};
+    if (curl == nullptr) {
+        return false;
+    }
+    std::string body {};
+    ConfigureCurl(curl, fileUrl, caCertFile);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, OnBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    CURLcode res = curl_easy_perform(curl);
+    long status {0};
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_cleanup(curl);
+    if (res != CURLE_OK || status != 200) {
+        return false;
+    }
+    content = std::move(body);
+    return true;
+}
+
+std::thread NetworkMonitor::FetchFileAsync(
+    boost::asio::io_context& ioc,
+    const std::string& fileUrl,
+    const std::filesystem::path& caCertFile,
+    FetchFileHandler onFetched
+)
+{
+    // The work guard keeps the I/O context running until the handler is
+    // posted.
+    auto work {boost::asio::make_work_guard(ioc)};
+    return std::thread {[
+        &ioc,
+        work = std::move(work),
+        fileUrl,
+        caCertFile,
+        onFetched = std::move(onFetched)
+    ]() mutable {
+        std::string content {};
+        const bool ok {DownloadFileToMemory(fileUrl, content, caCertFile)};
+        boost::asio::post(ioc, [
+            ok,
+            content = std::move(content),
+            onFetched = std::move(onFetched)
+        ]() mutable {
+            onFetched(ok, std::move(content));
+        });
+        work.reset();
+    }};
+}
+
+bool NetworkMonitor::DownloadFileCached(
+    const std::string& fileUrl,
+    const std::filesystem::path& cacheDirectory,
+    CachedDownload& result,
+    const std::filesystem::path& caCertFile
+)
+{
+    std::error_code ec {};
+    std::filesystem::create_directories(cacheDirectory, ec);
+    if (ec) {
+        return false;
+    }
+    const auto file {cacheDirectory / GetCacheFileName(fileUrl)};
+    auto metaFile {file};
+    metaFile += ".meta";
+    auto tmpFile {file};
+    tmpFile += ".tmp";
+
+    // We only revalidate a cached copy whose content hash we know.
+    CacheEntry cached {};
+    const bool hasCachedCopy {
+        ReadCacheEntry(metaFile, cached) &&
+        cached.url == fileUrl &&
+        std::filesystem::exists(file)
+    };
+
+    CURL* curl {curl_easy_init()};
+    if (curl == nullptr) {
+        return false;
+    }
+    std::FILE* fp {fopen(tmpFile.string().c_str(), "wb")};
+    if (fp == nullptr) {
+        curl_easy_cleanup(curl);
+        return false;
+    }
+    ConfigureCurl(curl, fileUrl, caCertFile);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
+    curl_slist* headers {nullptr};
+    if (hasCachedCopy && !cached.etag.empty()) {
+        const auto header {"If-None-Match: " + cached.etag};
+        headers = curl_slist_append(headers, header.c_str());
+    }
+    if (hasCachedCopy && !cached.lastModified.empty()) {
+        const auto header {"If-Modified-Since: " + cached.lastModified};
+        headers = curl_slist_append(headers, header.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    CacheEntry fresh {fileUrl};
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, OnHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &fresh);
+
+    CURLcode res = curl_easy_perform(curl);
+    long status {0};
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    fclose(fp);
+
+    if (res == CURLE_OK && status == 304 && hasCachedCopy) {
+        std::filesystem::remove(tmpFile, ec);
+        result = {file, cached.contentHash, false};
+        return true;
+    }
+    if (res != CURLE_OK || status != 200) {
+        std::filesystem::remove(tmpFile, ec);
+        return false;
+    }
+
+    // We drop the old metadata first, so that the new file is never paired
+    // with the hash of the old one.
+    std::filesystem::remove(metaFile, ec);
+    std::filesystem::rename(tmpFile, file, ec);
+    if (ec || !HashFile(file, fresh.contentHash)) {
+        return false;
+    }
+
+    // Without metadata, the next call downloads the file again.
+    WriteCacheEntry(metaFile, fresh);
+    result = {file, fresh.contentHash, true};
+    return true;
+}
+
 nlohmann::json NetworkMonitor::ParseJsonFile(
     const std::filesystem::path& source
 )
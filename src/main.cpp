@@ -11,6 +11,7 @@ using NetworkMonitor::BoostWebSocketServer;
 using NetworkMonitor::GetEnvVar;
 using NetworkMonitor::NetworkMonitorError;
 using NetworkMonitor::NetworkMonitorConfig;
+using NetworkMonitor::ParseBackpressurePolicy;
 
 int main()
 {
@@ -32,6 +33,65 @@ int main()
         20,
     };
 
+    // Optional cache for the downloaded network layout, to skip the download
+    // and the parsing on restarts when the layout has not changed
+    // Default: No cache
+    config.networkLayoutCacheDirectory = GetEnvVar(
+        "MNM_NETWORK_LAYOUT_CACHE_DIR", ""
+    );
+
+    // Download and load the network layout in the background, while the
+    // STOMP client connects
+    // Default: 1 = In the background, unless there is a layout cache
+    config.networkLayoutAsyncFetch = GetEnvVar(
+        "MNM_NETWORK_LAYOUT_ASYNC_FETCH", "1"
+    ) == "1";
+
+    // Optional reload of the network layout, when the local file or the cached
+    // download changed
+    // Default: 0s = Never reload
+    config.networkLayoutReloadInterval = std::chrono::seconds {
+        std::stoi(GetEnvVar("MNM_NETWORK_LAYOUT_RELOAD_INTERVAL_S", "0"))
+    };
+
+    // Optional crowding checkpoint, to survive restarts
+    // Default: No checkpoint
+    config.crowdingCheckpointFile = GetEnvVar(
+        "MNM_CROWDING_CHECKPOINT_FILE_PATH", ""
+    );
+    config.crowdingCheckpointInterval = std::chrono::seconds {
+        std::stoi(GetEnvVar("MNM_CROWDING_CHECKPOINT_INTERVAL_S", "60"))
+    };
+
+    // Optional passenger event journal
+    // Default: No journal
+    config.passengerEventJournalDirectory = GetEnvVar(
+        "MNM_PASSENGER_EVENT_JOURNAL_DIR", ""
+    );
+
+    // Passenger event micro-batching
+    // Default: Up to 1024 events or 1000us per batch
+    config.ingestionMaxBatchSize = std::stoul(
+        GetEnvVar("MNM_INGESTION_MAX_BATCH_SIZE", "1024")
+    );
+    config.ingestionMaxLatency = std::chrono::microseconds {
+        std::stoi(GetEnvVar("MNM_INGESTION_MAX_LATENCY_US", "1000"))
+    };
+
+    // Optional aggregation thread for passenger events
+    // Default: 0 = Aggregate passenger events in the I/O thread
+    config.ingestionRingCapacity = std::stoul(
+        GetEnvVar("MNM_INGESTION_RING_CAPACITY", "0")
+    );
+    auto policy {GetEnvVar("MNM_INGESTION_BACKPRESSURE_POLICY", "block")};
+    if (!ParseBackpressurePolicy(
+        policy,
+        config.ingestionBackpressurePolicy
+    )) {
+        spdlog::error("Unknown backpressure policy: {}", policy);
+        return -1;
+    }
+
     // Optional run timeout
     // Default: Oms = run indefinitely
     auto timeoutMs {std::stoi(GetEnvVar("MNM_TIMEOUT_MS", "0"))};
@@ -0,0 +1,324 @@
+#include "message-decoders.h"
+
+#include "transport-network.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using NetworkMonitor::Id;
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerEventMessage;
+using NetworkMonitor::PassengerEventRecord;
+using NetworkMonitor::QuietRouteRequestMessage;
+using NetworkMonitor::TransportNetwork;
+
+static const boost::posix_time::ptime kEpoch {
+    boost::gregorian::date(1970, 1, 1)
+};
+
+// Number of days since 1970-01-01 of a date in the proleptic Gregorian
+// calendar.
+static std::int64_t DaysFromCivil(
+    std::int64_t year,
+    const std::int64_t month,
+    const std::int64_t day
+)
+{
+    year -= month <= 2 ? 1 : 0;
+    const auto era {(year >= 0 ? year : year - 399) / 400};
+    const auto yearOfEra {year - era * 400};
+    const auto dayOfYear {(153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 +
+                          day - 1};
+    const auto dayOfEra {yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 +
+                         dayOfYear};
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static std::int64_t DaysInMonth(
+    const std::int64_t year,
+    const std::int64_t month
+)
+{
+    static constexpr std::int64_t kDays[] {
+        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+    };
+    const bool isLeapYear {
+        (year % 4 == 0 && year % 100 != 0) || year % 400 == 0
+    };
+    return month == 2 && isLeapYear ? 29 : kDays[month - 1];
+}
+
+// Decode a flat JSON object whose values are all strings without escape
+// sequences, calling onField(key, value) for each field.
+// Returns false as soon as the message does not have this exact shape.
+template <typename OnField>
+static bool DecodeFlatObject(
+    const std::string_view message,
+    OnField&& onField
+)
+{
+    const auto size {message.size()};
+    size_t pos {0};
+    auto skipWhitespace {[&message, &pos, size]() {
+        while (pos < size && (message[pos] == ' ' || message[pos] == '\n' ||
+                              message[pos] == '\r' || message[pos] == '\t')) {
+            ++pos;
+        }
+    }};
+    auto readString {[&message, &pos, size](std::string_view& dst) {
+        if (pos >= size || message[pos] != '"') {
+            return false;
+        }
+        const auto end {message.find_first_of("\"\\", pos + 1)};
+        if (end == std::string_view::npos || message[end] != '"') {
+            return false;
+        }
+        dst = message.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+        return true;
+    }};
+    auto consume {[&message, &pos, size](const char c) {
+        if (pos >= size || message[pos] != c) {
+            return false;
+        }
+        ++pos;
+        return true;
+    }};
+
+    skipWhitespace();
+    if (!consume('{')) {
+        return false;
+    }
+    skipWhitespace();
+    if (!consume('}')) {
+        while (true) {
+            std::string_view key {};
+            std::string_view value {};
+            skipWhitespace();
+            if (!readString(key)) {
+                return false;
+            }
+            skipWhitespace();
+            if (!consume(':')) {
+                return false;
+            }
+            skipWhitespace();
+            if (!readString(value)) {
+                return false;
+            }
+            onField(key, value);
+            skipWhitespace();
+            if (consume(',')) {
+                continue;
+            }
+            if (consume('}')) {
+                break;
+            }
+            return false;
+        }
+    }
+    skipWhitespace();
+    return pos == size;
+}
+
+bool NetworkMonitor::DecodePassengerEventMessage(
+    const std::string_view message,
+    PassengerEventMessage& dst
+)
+{
+    bool hasStationId {false};
+    bool hasType {false};
+    bool hasDatetime {false};
+    PassengerEventMessage event {};
+    bool ok {DecodeFlatObject(message, [&](auto key, auto value) {
+        if (key == "station_id") {
+            event.stationId = value;
+            hasStationId = true;
+        } else if (key == "passenger_event") {
+            event.type = value == "in" ? PassengerEvent::Type::In :
+                                         PassengerEvent::Type::Out;
+            hasType = true;
+        } else if (key == "datetime") {
+            event.datetime = value;
+            hasDatetime = true;
+        }
+    })};
+    if (!ok || !hasStationId || !hasType || !hasDatetime) {
+        return false;
+    }
+    dst = event;
+    return true;
+}
+
+bool NetworkMonitor::DecodeQuietRouteRequestMessage(
+    const std::string_view message,
+    QuietRouteRequestMessage& dst
+)
+{
+    bool hasStartStationId {false};
+    bool hasEndStationId {false};
+    QuietRouteRequestMessage request {};
+    bool ok {DecodeFlatObject(message, [&](auto key, auto value) {
+        if (key == "start_station_id") {
+            request.startStationId = value;
+            hasStartStationId = true;
+        } else if (key == "end_station_id") {
+            request.endStationId = value;
+            hasEndStationId = true;
+        }
+    })};
+    if (!ok || !hasStartStationId || !hasEndStationId) {
+        return false;
+    }
+    dst = request;
+    return true;
+}
+
+bool NetworkMonitor::ParsePassengerEvent(
+    const std::string_view message,
+    PassengerEvent& dst
+)
+{
+    PassengerEventMessage decoded {};
+    if (DecodePassengerEventMessage(message, decoded)) {
+        std::int64_t timestampUs {0};
+        if (!ParseIso8601Timestamp(decoded.datetime, timestampUs)) {
+            return false;
+        }
+        dst.timestamp = kEpoch + boost::posix_time::microseconds(timestampUs);
+        dst.stationId = Id {decoded.stationId};
+        dst.type = decoded.type;
+        return true;
+    }
+
+    // Fall back to the full JSON parser.
+    try {
+        dst = nlohmann::json::parse(message);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+bool NetworkMonitor::ParsePassengerEvent(
+    const std::string_view message,
+    const TransportNetwork& network,
+    PassengerEventRecord& dst
+)
+{
+    PassengerEventMessage decoded {};
+    if (DecodePassengerEventMessage(message, decoded)) {
+        std::int64_t timestampUs {0};
+        if (!ParseIso8601Timestamp(decoded.datetime, timestampUs)) {
+            return false;
+        }
+        dst.station = network.FindStationHandle(decoded.stationId);
+        dst.type = decoded.type;
+        dst.timestampUs = timestampUs;
+        return true;
+    }
+
+    // Fall back to the full JSON parser.
+    PassengerEvent event {};
+    try {
+        event = nlohmann::json::parse(message);
+    } catch (...) {
+        return false;
+    }
+    if (event.timestamp.is_special()) {
+        return false;
+    }
+    dst.station = network.FindStationHandle(event.stationId);
+    dst.type = event.type;
+    dst.timestampUs = (event.timestamp - kEpoch).total_microseconds();
+    return true;
+}
+
+bool NetworkMonitor::ParseIso8601Timestamp(
+    const std::string_view datetime,
+    std::int64_t& timestampUs
+)
+{
+    // Fast path: YYYY-MM-DDTHH:MM:SS.ffffffZ
+    // We check the layout in one pass over the string, then convert the fixed
+    // digit positions directly.
+    static constexpr std::string_view kLayout {"dddd-dd-ddTdd:dd:dd.ddddddZ"};
+    bool isFixedLayout {datetime.size() == kLayout.size()};
+    for (size_t idx {0}; isFixedLayout && idx < kLayout.size(); ++idx) {
+        const auto c {datetime[idx]};
+        isFixedLayout = kLayout[idx] == 'd' ? (c >= '0' && c <= '9') :
+                                              c == kLayout[idx];
+    }
+    if (isFixedLayout) {
+        auto digits {[&datetime](size_t pos, size_t n) {
+            std::int64_t value {0};
+            for (size_t idx {pos}; idx < pos + n; ++idx) {
+                value = value * 10 + (datetime[idx] - '0');
+            }
+            return value;
+        }};
+        const auto year {digits(0, 4)};
+        const auto month {digits(5, 2)};
+        const auto day {digits(8, 2)};
+        const auto hours {digits(11, 2)};
+        const auto minutes {digits(14, 2)};
+        const auto seconds {digits(17, 2)};
+        const auto microseconds {digits(20, 6)};
+        if (year < 1400 || month < 1 || month > 12 || day < 1 ||
+            day > DaysInMonth(year, month) || hours > 23 || minutes > 59 ||
+            seconds > 59) {
+            return false;
+        }
+        const auto days {DaysFromCivil(year, month, day)};
+        timestampUs = (((days * 24 + hours) * 60 + minutes) * 60 + seconds) *
+                      1'000'000 + microseconds;
+        return true;
+    }
+
+    // Fall back to the generic parser. As in from_json, we exclude the final
+    // 'Z' when parsing the datetime string.
+    if (datetime.empty()) {
+        return false;
+    }
+    try {
+        const auto timestamp {boost::posix_time::from_iso_extended_string(
+            std::string {datetime.substr(0, datetime.size() - 1)}
+        )};
+        if (timestamp.is_special()) {
+            return false;
+        }
+        timestampUs = (timestamp - kEpoch).total_microseconds();
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+bool NetworkMonitor::ParseQuietRouteRequest(
+    const std::string_view message,
+    Id& startStationId,
+    Id& endStationId
+)
+{
+    QuietRouteRequestMessage decoded {};
+    if (DecodeQuietRouteRequestMessage(message, decoded)) {
+        startStationId = Id {decoded.startStationId};
+        endStationId = Id {decoded.endStationId};
+        return true;
+    }
+
+    // Fall back to the full JSON parser.
+    try {
+        auto messageJson = nlohmann::json::parse(message);
+        startStationId = messageJson.at("start_station_id").get<Id>();
+        endStationId = messageJson.at("end_station_id").get<Id>();
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
@@ -1,86 +1,92 @@
 #include "network-monitor.h"
 
-#include <boost/bimap.hpp>
-
-#include <initializer_list>
+#include <array>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 
 using NetworkMonitor::NetworkMonitorError;
 
-// Utility function to generate a boost::bimap.
-template <typename L, typename R>
-static boost::bimap<L, R> MakeBimap(
-    std::initializer_list<typename boost::bimap<L, R>::value_type> list
-)
+// The enum strings are stored in a table with one entry per enum value, in the
+// order of the enum, so that a lookup is an index into the table. The table
+// is built at compile time.
+template <typename Enum, size_t N>
+using EnumStrings = std::array<std::pair<Enum, std::string_view>, N>;
+
+// Utility function to check that entry i of a table is for enum value i.
+template <typename Enum, size_t N>
+static constexpr bool IsInEnumOrder(const EnumStrings<Enum, N>& table)
 {
-    return boost::bimap<L, R>(list.begin(), list.end());
+    for (size_t idx {0}; idx < N; ++idx) {
+        if (static_cast<size_t>(table[idx].first) != idx) {
+            return false;
+        }
+    }
+    return true;
 }
 
 // NetworkMonitorError
 
-static const auto gNetworkMonitorErrorStrings {
-    MakeBimap<NetworkMonitorError, std::string_view>({
-        {NetworkMonitorError::kOk                                ,
-                              "Ok"                                },
-        {NetworkMonitorError::kUndefinedError                    ,
-                              "UndefinedError"                    },
-        {NetworkMonitorError::kCouldNotConnectToStompClient      ,
-                              "CouldNotConnectToStompClient"      },
-        {NetworkMonitorError::kCouldNotParsePassengerEvent       ,
-                              "CouldNotParsePassengerEvent"       },
-        {NetworkMonitorError::kCouldNotParseQuietRouteRequest    ,
-                              "CouldNotParseQuietRouteRequest"    },
-        {NetworkMonitorError::kCouldNotRecordPassengerEvent      ,
-                              "CouldNotRecordPassengerEvent"      },
-        {NetworkMonitorError::kCouldNotStartStompServer          ,
-                              "CouldNotStartStompServer"          },
-        {NetworkMonitorError::kCouldNotSubscribeToPassengerEvents,
-                              "CouldNotSubscribeToPassengerEvents"},
-        {NetworkMonitorError::kFailedNetworkLayoutFileDownload   ,
-                              "FailedNetworkLayoutFileDownload"   },
-        {NetworkMonitorError::kFailedNetworkLayoutFileParsing    ,
-                              "FailedNetworkLayoutFileParsing"    },
-        {NetworkMonitorError::kFailedTransportNetworkConstruction,
-                              "FailedTransportNetworkConstruction"},
-        {NetworkMonitorError::kMissingCaCertFile                 ,
-                              "MissingCaCertFile"                 },
-        {NetworkMonitorError::kMissingNetworkLayoutFile          ,
-                              "MissingNetworkLayoutFile"          },
-        {NetworkMonitorError::kStompClientDisconnected           ,
-                              "StompClientDisconnected"           },
-        {NetworkMonitorError::kStompServerClientDisconnected     ,
-                              "StompServerClientDisconnected"     },
-        {NetworkMonitorError::kStompServerDisconnected           ,
-                              "StompServerDisconnected"           },
-    })
-};
+static constexpr EnumStrings<
+    NetworkMonitorError,
+    static_cast<size_t>(NetworkMonitorError::kStompServerDisconnected) + 1
+> gNetworkMonitorErrorStrings {{
+    {NetworkMonitorError::kOk                                ,
+                          "Ok"                                },
+    {NetworkMonitorError::kUndefinedError                    ,
+                          "UndefinedError"                    },
+    {NetworkMonitorError::kCouldNotConnectToStompClient      ,
+                          "CouldNotConnectToStompClient"      },
+    {NetworkMonitorError::kCouldNotOpenPassengerEventJournal,
+                          "CouldNotOpenPassengerEventJournal" },
+    {NetworkMonitorError::kCouldNotParseCrowdedStationsRequest,
+                          "CouldNotParseCrowdedStationsRequest"},
+    {NetworkMonitorError::kCouldNotParsePassengerEvent       ,
+                          "CouldNotParsePassengerEvent"       },
+    {NetworkMonitorError::kCouldNotParseQuietRouteRequest    ,
+                          "CouldNotParseQuietRouteRequest"    },
+    {NetworkMonitorError::kCouldNotRecordPassengerEvent      ,
+                          "CouldNotRecordPassengerEvent"      },
+    {NetworkMonitorError::kCouldNotStartStompServer          ,
+                          "CouldNotStartStompServer"          },
+    {NetworkMonitorError::kCouldNotSubscribeToPassengerEvents,
+                          "CouldNotSubscribeToPassengerEvents"},
+    {NetworkMonitorError::kFailedNetworkLayoutFileDownload   ,
+                          "FailedNetworkLayoutFileDownload"   },
+    {NetworkMonitorError::kFailedNetworkLayoutFileParsing    ,
+                          "FailedNetworkLayoutFileParsing"    },
+    {NetworkMonitorError::kFailedTransportNetworkConstruction,
+                          "FailedTransportNetworkConstruction"},
+    {NetworkMonitorError::kMissingCaCertFile                 ,
+                          "MissingCaCertFile"                 },
+    {NetworkMonitorError::kMissingNetworkLayoutFile          ,
+                          "MissingNetworkLayoutFile"          },
+    {NetworkMonitorError::kStompClientDisconnected           ,
+                          "StompClientDisconnected"           },
+    {NetworkMonitorError::kStompServerClientDisconnected     ,
+                          "StompServerClientDisconnected"     },
+    {NetworkMonitorError::kStompServerDisconnected           ,
+                          "StompServerDisconnected"           },
+}};
+static_assert(IsInEnumOrder(gNetworkMonitorErrorStrings),
+              "The NetworkMonitorError strings must follow the enum order");
 
 std::ostream& NetworkMonitor::operator<<(
     std::ostream& os,
     const NetworkMonitorError& error
 )
 {
-    auto errorIt {gNetworkMonitorErrorStrings.left.find(error)};
-    if (errorIt == gNetworkMonitorErrorStrings.left.end()) {
-        os << gNetworkMonitorErrorStrings.left.at(
-            NetworkMonitorError::kUndefinedError
-        );
-    }
-    return os << errorIt->second;
+    return os << ToString(error);
 }
 
-std::string NetworkMonitor::ToString(
-    const NetworkMonitorError& error
-)
+std::string_view NetworkMonitor::ToString(const NetworkMonitorError& error)
 {
-    static const auto undefinedError {std::string(
-        gNetworkMonitorErrorStrings.left.at(NetworkMonitorError::kUndefinedError)
-    )};
-    auto errorIt {gNetworkMonitorErrorStrings.left.find(error)};
-    if (errorIt == gNetworkMonitorErrorStrings.left.end()) {
-        return undefinedError;
+    const auto idx {static_cast<size_t>(error)};
+    if (idx >= gNetworkMonitorErrorStrings.size()) {
+        return gNetworkMonitorErrorStrings[
+            static_cast<size_t>(NetworkMonitorError::kUndefinedError)
+        ].second;
     }
-    return std::string(errorIt->second);
-}
\ No newline at end of file
+    return gNetworkMonitorErrorStrings[idx].second;
+}
@@ -0,0 +1,433 @@
+#include "network-snapshot.h"
+#include "transport-network.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::Line;
+using NetworkMonitor::Route;
+using NetworkMonitor::Station;
+using NetworkMonitor::TransportNetwork;
+
+namespace bip = boost::interprocess;
+
+// Snapshot file layout. All fields are in the host byte order: Snapshots are
+// built on the machine that serves them, as part of a deploy.
+//
+// The header is followed by these sections, in order:
+// - StationRecord[nStations], in station handle order.
+// - LineRecord[nLines].
+// - RouteRecord[nRoutes]. The routes of a line are contiguous.
+// - std::uint32_t[nStops]: Station indices. The stops of a route are
+//   contiguous.
+// - TravelTimeRecord[nTravelTimes].
+// - char[stringTableSize]: All the strings, without separators.
+// Every record is made of 32-bit fields, so all sections stay aligned.
+struct SnapshotHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t sourceHash;
+    std::uint64_t layoutHash;
+    std::uint64_t checksum;
+    std::uint32_t nStations;
+    std::uint32_t nLines;
+    std::uint32_t nRoutes;
+    std::uint32_t nStops;
+    std::uint32_t nTravelTimes;
+    std::uint32_t stringTableSize;
+};
+
+struct StringRef {
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+struct StationRecord {
+    StringRef id;
+    StringRef name;
+};
+
+struct LineRecord {
+    StringRef id;
+    StringRef name;
+    std::uint32_t firstRoute;
+    std::uint32_t nRoutes;
+};
+
+struct RouteRecord {
+    StringRef id;
+    StringRef direction;
+    std::uint32_t firstStop;
+    std::uint32_t nStops;
+};
+
+struct TravelTimeRecord {
+    std::uint32_t stationA;
+    std::uint32_t stationB;
+    std::uint32_t travelTime;
+};
+
+static constexpr std::array<char, 8> kMagic {
+    'M', 'N', 'M', 'S', 'N', 'A', 'P', '\0'
+};
+static constexpr std::uint32_t kVersion {1};
+
+static std::uint64_t Fnv1a(
+    const char* data,
+    const size_t nBytes,
+    std::uint64_t hash = 14695981039346656037ull
+)
+{
+    for (size_t idx {0}; idx < nBytes; ++idx) {
+        hash ^= static_cast<unsigned char>(data[idx]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Sizes of the sections that follow the header.
+static size_t GetPayloadSize(
+    const SnapshotHeader& header
+)
+{
+    return static_cast<size_t>(header.nStations) * sizeof(StationRecord) +
+        static_cast<size_t>(header.nLines) * sizeof(LineRecord) +
+        static_cast<size_t>(header.nRoutes) * sizeof(RouteRecord) +
+        static_cast<size_t>(header.nStops) * sizeof(std::uint32_t) +
+        static_cast<size_t>(header.nTravelTimes) * sizeof(TravelTimeRecord) +
+        header.stringTableSize;
+}
+
+// Collects the snapshot sections while we walk the network.
+class SnapshotBuilder {
+public:
+    StringRef Intern(
+        const std::string& string
+    )
+    {
+        auto stringIt {strings_.find(string)};
+        if (stringIt != strings_.end()) {
+            return stringIt->second;
+        }
+        StringRef ref {
+            static_cast<std::uint32_t>(stringTable_.size()),
+            static_cast<std::uint32_t>(string.size()),
+        };
+        stringTable_ += string;
+        strings_.emplace(string, ref);
+        return ref;
+    }
+
+    std::vector<StationRecord> stations {};
+    std::vector<LineRecord> lines {};
+    std::vector<RouteRecord> routes {};
+    std::vector<std::uint32_t> stops {};
+    std::vector<TravelTimeRecord> travelTimes {};
+
+    const std::string& GetStringTable() const
+    {
+        return stringTable_;
+    }
+
+private:
+    std::string stringTable_ {};
+    std::unordered_map<std::string, StringRef> strings_ {};
+};
+
+template <typename Record>
+static void Append(
+    std::string& buffer,
+    const std::vector<Record>& records
+)
+{
+    buffer.append(reinterpret_cast<const char*>(records.data()),
+                  records.size() * sizeof(Record));
+}
+
+bool NetworkMonitor::HashFile(
+    const std::filesystem::path& file,
+    std::uint64_t& hash
+)
+{
+    std::ifstream in {file, std::ios::binary};
+    if (!in) {
+        return false;
+    }
+    std::uint64_t result {14695981039346656037ull};
+    std::array<char, 64 * 1024> buffer {};
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        result = Fnv1a(buffer.data(), static_cast<size_t>(in.gcount()),
+                       result);
+    }
+    if (in.bad()) {
+        return false;
+    }
+    hash = result;
+    return true;
+}
+
+bool NetworkMonitor::WriteNetworkSnapshot(
+    const std::filesystem::path& file,
+    const TransportNetwork& network,
+    const std::uint64_t sourceHash
+)
+{
+    SnapshotBuilder builder {};
+
+    // Stations, in handle order, so that the handles of the loaded network
+    // match the ones of the original network.
+    const auto stations {network.GetStations()};
+    std::unordered_map<std::string_view, std::uint32_t> stationIndices {};
+    builder.stations.reserve(stations.size());
+    for (const auto& station: stations) {
+        stationIndices.emplace(station.id, builder.stations.size());
+        builder.stations.push_back({
+            builder.Intern(station.id),
+            builder.Intern(station.name),
+        });
+    }
+
+    // Lines, routes and stops. We collect the travel time of every pair of
+    // consecutive stops once.
+    const auto lines {network.GetLines()};
+    std::unordered_set<std::uint64_t> edges {};
+    for (const auto& line: lines) {
+        builder.lines.push_back({
+            builder.Intern(line.id),
+            builder.Intern(line.name),
+            static_cast<std::uint32_t>(builder.routes.size()),
+            static_cast<std::uint32_t>(line.routes.size()),
+        });
+        for (const auto& route: line.routes) {
+            builder.routes.push_back({
+                builder.Intern(route.id),
+                builder.Intern(route.direction),
+                static_cast<std::uint32_t>(builder.stops.size()),
+                static_cast<std::uint32_t>(route.stops.size()),
+            });
+            for (size_t idx {0}; idx < route.stops.size(); ++idx) {
+                const auto stop {stationIndices.at(route.stops[idx])};
+                builder.stops.push_back(stop);
+                if (idx == 0) {
+                    continue;
+                }
+                const auto previous {builder.stops[builder.stops.size() - 2]};
+                const auto edge {
+                    static_cast<std::uint64_t>(std::min(previous, stop)) << 32 |
+                    std::max(previous, stop)
+                };
+                if (!edges.insert(edge).second) {
+                    continue;
+                }
+                const auto travelTime {network.GetTravelTime(
+                    route.stops[idx - 1], route.stops[idx]
+                )};
+                if (travelTime > 0) {
+                    builder.travelTimes.push_back({previous, stop, travelTime});
+                }
+            }
+        }
+    }
+
+    SnapshotHeader header {
+        kMagic,
+        kVersion,
+        0,
+        sourceHash,
+        network.GetLayoutHash(),
+        0,
+        static_cast<std::uint32_t>(builder.stations.size()),
+        static_cast<std::uint32_t>(builder.lines.size()),
+        static_cast<std::uint32_t>(builder.routes.size()),
+        static_cast<std::uint32_t>(builder.stops.size()),
+        static_cast<std::uint32_t>(builder.travelTimes.size()),
+        static_cast<std::uint32_t>(builder.GetStringTable().size()),
+    };
+    std::string payload {};
+    payload.reserve(GetPayloadSize(header));
+    Append(payload, builder.stations);
+    Append(payload, builder.lines);
+    Append(payload, builder.routes);
+    Append(payload, builder.stops);
+    Append(payload, builder.travelTimes);
+    payload += builder.GetStringTable();
+    header.checksum = Fnv1a(payload.data(), payload.size());
+
+    auto tmpFile {file};
+    tmpFile += ".tmp";
+    try {
+        {
+            std::ofstream out {tmpFile, std::ios::binary | std::ios::trunc};
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(payload.data(), payload.size());
+            if (!out) {
+                throw std::runtime_error("Could not write snapshot");
+            }
+        }
+
+        // The rename is atomic: Readers either see the old or the new file.
+        std::filesystem::rename(tmpFile, file);
+    } catch (const std::exception&) {
+        std::error_code ec {};
+        std::filesystem::remove(tmpFile, ec);
+        return false;
+    }
+    return true;
+}
+
+bool NetworkMonitor::IsNetworkSnapshot(
+    const std::filesystem::path& file
+)
+{
+    std::ifstream in {file, std::ios::binary};
+    std::array<char, 8> magic {};
+    in.read(magic.data(), magic.size());
+    return in && magic == kMagic;
+}
+
+bool NetworkMonitor::ReadNetworkSnapshot(
+    const std::filesystem::path& file,
+    TransportNetwork& network,
+    std::uint64_t& sourceHash
+)
+{
+    std::error_code ec {};
+    const auto fileSize {std::filesystem::file_size(file, ec)};
+    if (ec || fileSize < sizeof(SnapshotHeader)) {
+        return false;
+    }
+    try {
+        bip::file_mapping mapping {file.c_str(), bip::read_only};
+        bip::mapped_region region {mapping, bip::read_only};
+        const auto* data {static_cast<const char*>(region.get_address())};
+        SnapshotHeader header {};
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != kMagic ||
+            header.version != kVersion ||
+            fileSize != sizeof(header) + GetPayloadSize(header)) {
+            return false;
+        }
+        const auto* payload {data + sizeof(header)};
+        if (Fnv1a(payload, fileSize - sizeof(header)) != header.checksum) {
+            return false;
+        }
+
+        // The mapping is page-aligned and all records are made of 32-bit
+        // fields, so we can read the sections in place.
+        const auto* stations {
+            reinterpret_cast<const StationRecord*>(payload)
+        };
+        const auto* lines {
+            reinterpret_cast<const LineRecord*>(stations + header.nStations)
+        };
+        const auto* routes {
+            reinterpret_cast<const RouteRecord*>(lines + header.nLines)
+        };
+        const auto* stops {
+            reinterpret_cast<const std::uint32_t*>(routes + header.nRoutes)
+        };
+        const auto* travelTimes {
+            reinterpret_cast<const TravelTimeRecord*>(stops + header.nStops)
+        };
+        const auto* strings {
+            reinterpret_cast<const char*>(travelTimes + header.nTravelTimes)
+        };
+        auto getString {[&header, strings](const StringRef& ref) {
+            if (static_cast<size_t>(ref.offset) + ref.size >
+                header.stringTableSize) {
+                throw std::runtime_error("Bad string reference");
+            }
+            return std::string(strings + ref.offset, ref.size);
+        }};
+        auto getStationId {[&header, stations, &getString](std::uint32_t idx) {
+            if (idx >= header.nStations) {
+                throw std::runtime_error("Bad station index");
+            }
+            return getString(stations[idx].id);
+        }};
+
+        // We build a separate network, so that the caller's network is left
+        // untouched if the snapshot turns out to be inconsistent.
+        TransportNetwork loaded {};
+        for (std::uint32_t idx {0}; idx < header.nStations; ++idx) {
+            if (!loaded.AddStation({
+                getString(stations[idx].id),
+                getString(stations[idx].name),
+            })) {
+                return false;
+            }
+        }
+        for (std::uint32_t lineIdx {0}; lineIdx < header.nLines; ++lineIdx) {
+            const auto& lineRecord {lines[lineIdx]};
+            if (static_cast<size_t>(lineRecord.firstRoute) +
+                lineRecord.nRoutes > header.nRoutes) {
+                return false;
+            }
+            Line line {
+                getString(lineRecord.id),
+                getString(lineRecord.name),
+                {},
+            };
+            line.routes.reserve(lineRecord.nRoutes);
+            for (std::uint32_t idx {0}; idx < lineRecord.nRoutes; ++idx) {
+                const auto& routeRecord {routes[lineRecord.firstRoute + idx]};
+                if (routeRecord.nStops == 0 ||
+                    static_cast<size_t>(routeRecord.firstStop) +
+                    routeRecord.nStops > header.nStops) {
+                    return false;
+                }
+                auto& route {line.routes.emplace_back()};
+                route.id = getString(routeRecord.id);
+                route.direction = getString(routeRecord.direction);
+                route.lineId = line.id;
+                route.stops.reserve(routeRecord.nStops);
+                for (std::uint32_t stop {0}; stop < routeRecord.nStops;
+                     ++stop) {
+                    route.stops.push_back(
+                        getStationId(stops[routeRecord.firstStop + stop])
+                    );
+                }
+                route.startStationId = route.stops.front();
+                route.endStationId = route.stops.back();
+            }
+            if (!loaded.AddLine(line)) {
+                return false;
+            }
+        }
+        for (std::uint32_t idx {0}; idx < header.nTravelTimes; ++idx) {
+            const auto& travelTime {travelTimes[idx]};
+            if (!loaded.SetTravelTime(
+                getStationId(travelTime.stationA),
+                getStationId(travelTime.stationB),
+                travelTime.travelTime
+            )) {
+                return false;
+            }
+        }
+        if (loaded.GetLayoutHash() != header.layoutHash) {
+            return false;
+        }
+        network = std::move(loaded);
+        sourceHash = header.sourceHash;
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#include "passenger-event-batcher.h"
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::IngestionMetrics;
+using NetworkMonitor::PassengerEventBatcher;
+using NetworkMonitor::PassengerEventRecord;
+
+// IngestionMetrics — Public methods
+
+double IngestionMetrics::GetMeanBatchSize() const
+{
+    return nBatches == 0 ? 0.0 : static_cast<double>(nEvents) / nBatches;
+}
+
+// PassengerEventBatcher — Public methods
+
+PassengerEventBatcher::PassengerEventBatcher(
+    boost::asio::io_context& ioc,
+    OnBatch onBatch,
+    const size_t maxBatchSize,
+    const std::chrono::microseconds maxLatency
+) : ioc_ {ioc},
+    onBatch_ {std::move(onBatch)},
+    maxBatchSize_ {std::max<size_t>(maxBatchSize, 1)},
+    maxLatency_ {maxLatency}
+{
+    pending_.reserve(maxBatchSize_);
+}
+
+void PassengerEventBatcher::Push(
+    const PassengerEventRecord& event
+)
+{
+    if (pending_.empty()) {
+        batchStart_ = std::chrono::steady_clock::now();
+    }
+    pending_.push_back(event);
+    metrics_.queueDepth = pending_.size();
+    metrics_.maxQueueDepth = std::max(metrics_.maxQueueDepth,
+                                      metrics_.queueDepth);
+
+    if (pending_.size() >= maxBatchSize_ ||
+        std::chrono::steady_clock::now() - batchStart_ >= maxLatency_) {
+        Flush();
+        return;
+    }
+
+    // The flush runs after the handlers that are already queued in the I/O
+    // context, so that all events of the current drain end up in this batch.
+    if (!isFlushScheduled_) {
+        isFlushScheduled_ = true;
+        boost::asio::post(ioc_, [this]() {
+            isFlushScheduled_ = false;
+            Flush();
+        });
+    }
+}
+
+void PassengerEventBatcher::Flush()
+{
+    if (pending_.empty()) {
+        return;
+    }
+    onBatch_(pending_);
+
+    const auto latency {std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - batchStart_
+    )};
+    metrics_.nEvents += pending_.size();
+    metrics_.nBatches += 1;
+    metrics_.lastBatchSize = pending_.size();
+    metrics_.maxBatchSize = std::max(metrics_.maxBatchSize, pending_.size());
+    metrics_.lastBatchLatency = latency;
+    metrics_.maxBatchLatency = std::max(metrics_.maxBatchLatency, latency);
+    metrics_.queueDepth = 0;
+    pending_.clear();
+}
+
+const IngestionMetrics& PassengerEventBatcher::GetMetrics() const
+{
+    return metrics_;
+}
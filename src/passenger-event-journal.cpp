@@ -0,0 +1,325 @@
+#include "passenger-event-journal.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerEventJournal;
+using NetworkMonitor::PassengerEventRecord;
+
+namespace bip = boost::interprocess;
+
+// Segment file layout. All fields are in the host byte order.
+struct SegmentHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t layoutHash;
+};
+
+struct DiskRecord {
+    std::uint32_t station;
+    std::uint8_t type;
+    std::array<std::uint8_t, 3> reserved;
+    std::int64_t timestampUs;
+};
+static_assert(sizeof(DiskRecord) == 16, "Unexpected journal record size");
+
+static constexpr std::array<char, 8> kMagic {
+    'M', 'N', 'M', 'J', 'R', 'N', 'L', '\0'
+};
+static constexpr std::uint32_t kVersion {1};
+
+static std::filesystem::path GetSegmentPath(
+    const std::filesystem::path& directory,
+    const size_t segmentNumber
+)
+{
+    std::array<char, 32> filename {};
+    std::snprintf(filename.data(), filename.size(), "journal-%08zu.bin",
+                  segmentNumber);
+    return directory / filename.data();
+}
+
+// Get the sequence numbers of the segments in a directory, in order.
+static std::vector<size_t> GetSegmentNumbers(
+    const std::filesystem::path& directory
+)
+{
+    std::vector<size_t> segmentNumbers {};
+    std::error_code ec {};
+    for (const auto& entry: std::filesystem::directory_iterator(directory, ec)) {
+        const auto filename {entry.path().filename().string()};
+        size_t segmentNumber {0};
+        char extension[5] {};
+        if (std::sscanf(filename.c_str(), "journal-%zu.%4s",
+                        &segmentNumber, extension) == 2 &&
+            std::strcmp(extension, "bin") == 0) {
+            segmentNumbers.push_back(segmentNumber);
+        }
+    }
+    std::sort(segmentNumbers.begin(), segmentNumbers.end());
+    return segmentNumbers;
+}
+
+// PassengerEventJournal — Public methods
+
+PassengerEventJournal::PassengerEventJournal(
+    const std::filesystem::path& directory,
+    const size_t maxSegmentSize,
+    const std::chrono::milliseconds flushInterval
+) : directory_ {directory},
+    maxSegmentSize_ {maxSegmentSize},
+    flushInterval_ {flushInterval}
+{
+}
+
+PassengerEventJournal::~PassengerEventJournal()
+{
+    Close();
+}
+
+bool PassengerEventJournal::Open(
+    const std::uint64_t layoutHash
+)
+{
+    Close();
+    std::error_code ec {};
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        spdlog::error("PassengerEventJournal: Could not create {}: {}",
+                      directory_.string(), ec.message());
+        return false;
+    }
+
+    // We never append to an existing segment: A segment may have been left
+    // with a partial record by a crash.
+    const auto segmentNumbers {GetSegmentNumbers(directory_)};
+    segmentNumber_ = segmentNumbers.empty() ? 0 : segmentNumbers.back();
+    layoutHash_ = layoutHash;
+    if (!OpenNextSegment()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock {mutex_};
+    isOpen_ = true;
+    stopping_ = false;
+    writer_ = std::thread {[this]() { RunWriter(); }};
+    return true;
+}
+
+void PassengerEventJournal::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if (!isOpen_) {
+            return;
+        }
+        isOpen_ = false;
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    writer_.join();
+    segment_.close();
+}
+
+void PassengerEventJournal::Append(
+    const PassengerEventRecord& record
+)
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (isOpen_) {
+        pending_.push_back(record);
+    }
+}
+
+void PassengerEventJournal::Append(
+    const std::vector<PassengerEventRecord>& records
+)
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (isOpen_) {
+        pending_.insert(pending_.end(), records.begin(), records.end());
+    }
+}
+
+size_t PassengerEventJournal::GetNRecordsWritten() const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return nRecordsWritten_;
+}
+
+size_t PassengerEventJournal::GetNFlushes() const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return nFlushes_;
+}
+
+// PassengerEventJournal — Private methods
+
+void PassengerEventJournal::RunWriter()
+{
+    std::vector<PassengerEventRecord> records {};
+    bool stopping {false};
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock {mutex_};
+            cv_.wait_for(lock, flushInterval_, [this]() { return stopping_; });
+            stopping = stopping_;
+
+            // Swap the buffers, so that callers can keep appending while we
+            // write. The two buffers keep their capacity across iterations.
+            records.clear();
+            std::swap(records, pending_);
+        }
+        if (!records.empty()) {
+            WriteRecords(records);
+        }
+    }
+}
+
+bool PassengerEventJournal::OpenNextSegment()
+{
+    segment_.close();
+    ++segmentNumber_;
+    const auto path {GetSegmentPath(directory_, segmentNumber_)};
+    segment_.open(path, std::ios::binary | std::ios::trunc);
+    if (!segment_) {
+        spdlog::error("PassengerEventJournal: Could not create {}",
+                      path.string());
+        return false;
+    }
+    SegmentHeader header {
+        kMagic,
+        kVersion,
+        sizeof(DiskRecord),
+        layoutHash_,
+    };
+    segment_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    segmentSize_ = sizeof(header);
+    return static_cast<bool>(segment_);
+}
+
+void PassengerEventJournal::WriteRecords(
+    const std::vector<PassengerEventRecord>& records
+)
+{
+    // Group commit: All records in the group go out with a single flush.
+    std::vector<DiskRecord> diskRecords {};
+    diskRecords.reserve(records.size());
+    for (const auto& record: records) {
+        diskRecords.push_back({
+            record.station,
+            static_cast<std::uint8_t>(record.type),
+            {},
+            record.timestampUs,
+        });
+    }
+    size_t offset {0};
+    while (offset < diskRecords.size()) {
+        if (segmentSize_ + sizeof(DiskRecord) > maxSegmentSize_ &&
+            segmentSize_ > sizeof(SegmentHeader)) {
+            if (!OpenNextSegment()) {
+                return;
+            }
+        }
+        const auto nFree {
+            maxSegmentSize_ - std::min(segmentSize_, maxSegmentSize_)
+        };
+        const auto nRecords {std::min(
+            std::max<size_t>(nFree / sizeof(DiskRecord), 1),
+            diskRecords.size() - offset
+        )};
+        const auto nBytes {nRecords * sizeof(DiskRecord)};
+        segment_.write(
+            reinterpret_cast<const char*>(diskRecords.data() + offset),
+            nBytes
+        );
+        segmentSize_ += nBytes;
+        offset += nRecords;
+    }
+    segment_.flush();
+    if (!segment_) {
+        spdlog::error("PassengerEventJournal: Could not write {} records",
+                      records.size());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock {mutex_};
+    nRecordsWritten_ += records.size();
+    ++nFlushes_;
+}
+
+// Replay
+
+size_t NetworkMonitor::ReplayPassengerEventJournal(
+    const std::filesystem::path& directory,
+    const std::uint64_t layoutHash,
+    std::vector<long long int>& passengerCounts
+)
+{
+    size_t nEvents {0};
+    for (const auto segmentNumber: GetSegmentNumbers(directory)) {
+        const auto path {GetSegmentPath(directory, segmentNumber)};
+        std::error_code ec {};
+        const auto fileSize {std::filesystem::file_size(path, ec)};
+        if (ec || fileSize < sizeof(SegmentHeader)) {
+            continue;
+        }
+        try {
+            bip::file_mapping mapping {path.c_str(), bip::read_only};
+            bip::mapped_region region {mapping, bip::read_only};
+            const auto* data {static_cast<const char*>(region.get_address())};
+            SegmentHeader header {};
+            std::memcpy(&header, data, sizeof(header));
+            if (header.magic != kMagic ||
+                header.version != kVersion ||
+                header.recordSize != sizeof(DiskRecord) ||
+                header.layoutHash != layoutHash) {
+                spdlog::warn("PassengerEventJournal: Skipping segment {}",
+                             path.string());
+                continue;
+            }
+
+            // A partial record at the end of the segment is ignored.
+            const auto nRecords {
+                (fileSize - sizeof(header)) / sizeof(DiskRecord)
+            };
+            const auto* records {data + sizeof(header)};
+            const auto nStations {passengerCounts.size()};
+            for (size_t idx {0}; idx < nRecords; ++idx) {
+                DiskRecord record;
+                std::memcpy(&record, records + idx * sizeof(DiskRecord),
+                            sizeof(DiskRecord));
+                if (record.station >= nStations) {
+                    continue;
+                }
+                passengerCounts[record.station] +=
+                    record.type == static_cast<std::uint8_t>(
+                        PassengerEvent::Type::In
+                    ) ? 1 : -1;
+                ++nEvents;
+            }
+        } catch (const std::exception& e) {
+            spdlog::warn("PassengerEventJournal: Could not read {}: {}",
+                         path.string(), e.what());
+        }
+    }
+    return nEvents;
+}
@@ -0,0 +1,194 @@
+#include "passenger-event-pipeline.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::BackpressurePolicy;
+using NetworkMonitor::IngestionMetrics;
+using NetworkMonitor::PassengerEventPipeline;
+
+// BackpressurePolicy
+
+// The table is built at compile time. It is short enough to search linearly.
+static constexpr std::array<
+    std::pair<BackpressurePolicy, std::string_view>,
+    3
+> gBackpressurePolicyStrings {{
+    {BackpressurePolicy::kBlock       , "block"         },
+    {BackpressurePolicy::kCountAndDrop, "count-and-drop"},
+    {BackpressurePolicy::kDropOldest  , "drop-oldest"   },
+}};
+
+std::ostream& NetworkMonitor::operator<<(
+    std::ostream& os,
+    const BackpressurePolicy& policy
+)
+{
+    for (const auto& [value, name]: gBackpressurePolicyStrings) {
+        if (value == policy) {
+            return os << name;
+        }
+    }
+    return os << "BackpressurePolicy::kInvalid";
+}
+
+bool NetworkMonitor::ParseBackpressurePolicy(
+    const std::string& name,
+    BackpressurePolicy& policy
+)
+{
+    for (const auto& [value, valueName]: gBackpressurePolicyStrings) {
+        if (valueName == name) {
+            policy = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// PassengerEventPipeline — Public methods
+
+PassengerEventPipeline::PassengerEventPipeline(
+    OnMessages onMessages,
+    const size_t capacity,
+    const BackpressurePolicy policy,
+    const size_t maxBatchSize
+) : onMessages_ {std::move(onMessages)},
+    ring_ {capacity},
+    policy_ {policy},
+    maxBatchSize_ {std::max<size_t>(maxBatchSize, 1)}
+{
+}
+
+PassengerEventPipeline::~PassengerEventPipeline()
+{
+    Stop();
+}
+
+void PassengerEventPipeline::Start()
+{
+    if (isRunning_.exchange(true)) {
+        return;
+    }
+    aggregator_ = std::thread {[this]() {
+        RunAggregator();
+    }};
+}
+
+void PassengerEventPipeline::Stop()
+{
+    isRunning_.store(false, std::memory_order_release);
+    if (aggregator_.joinable()) {
+        aggregator_.join();
+    }
+}
+
+bool PassengerEventPipeline::Push(
+    std::string&& message
+)
+{
+    Entry entry {std::move(message), std::chrono::steady_clock::now()};
+    if (ring_.TryPush(std::move(entry))) {
+        return true;
+    }
+
+    // The ring is full.
+    switch (policy_) {
+        case BackpressurePolicy::kBlock: {
+            while (isRunning_.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+                if (ring_.TryPush(std::move(entry))) {
+                    return true;
+                }
+            }
+            nDropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        case BackpressurePolicy::kDropOldest: {
+            Entry oldest {};
+            while (!ring_.TryPush(std::move(entry))) {
+                if (ring_.TryPop(oldest)) {
+                    nDropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            return false;
+        }
+        case BackpressurePolicy::kCountAndDrop:
+        default: {
+            nDropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+}
+
+IngestionMetrics PassengerEventPipeline::GetMetrics() const
+{
+    std::lock_guard<std::mutex> lock {metricsMutex_};
+    auto metrics {metrics_};
+    metrics.queueDepth = ring_.GetSize();
+    metrics.nDropped = nDropped_.load(std::memory_order_relaxed);
+    return metrics;
+}
+
+// PassengerEventPipeline — Private methods
+
+void PassengerEventPipeline::RunAggregator()
+{
+    std::vector<std::string> messages {};
+    messages.reserve(maxBatchSize_);
+    Entry entry {};
+    size_t nIdleRounds {0};
+    while (true) {
+        // We read the flag before draining the ring, so that the messages
+        // pushed before a call to Stop are always processed.
+        const bool isStopping {!isRunning_.load(std::memory_order_acquire)};
+
+        messages.clear();
+        std::chrono::steady_clock::time_point oldestPushedAt {};
+        while (messages.size() < maxBatchSize_ && ring_.TryPop(entry)) {
+            if (messages.empty()) {
+                oldestPushedAt = entry.pushedAt;
+            }
+            messages.push_back(std::move(entry.message));
+        }
+        if (messages.empty()) {
+            if (isStopping) {
+                return;
+            }
+
+            // Spin for a little while before backing off, so that we react
+            // quickly to bursts without burning a core when idle.
+            if (++nIdleRounds < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            continue;
+        }
+        nIdleRounds = 0;
+        const auto queueDepth {messages.size() + ring_.GetSize()};
+
+        onMessages_(messages);
+
+        const auto latency {std::chrono::duration_cast<
+            std::chrono::microseconds
+        >(std::chrono::steady_clock::now() - oldestPushedAt)};
+        std::lock_guard<std::mutex> lock {metricsMutex_};
+        metrics_.nEvents += messages.size();
+        metrics_.nBatches += 1;
+        metrics_.lastBatchSize = messages.size();
+        metrics_.maxBatchSize = std::max(metrics_.maxBatchSize,
+                                         messages.size());
+        metrics_.lastBatchLatency = latency;
+        metrics_.maxBatchLatency = std::max(metrics_.maxBatchLatency, latency);
+        metrics_.maxQueueDepth = std::max(metrics_.maxQueueDepth, queueDepth);
+    }
+}
@@ -1,78 +1,80 @@
 #include "stomp-client.h"
 
-#include <boost/bimap.hpp>
-
-#include <initializer_list>
+#include <array>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 
 using NetworkMonitor::StompClientError;
 
-// Utility function to generate a boost::bimap.
-template <typename L, typename R>
-static boost::bimap<L, R> MakeBimap(
-    std::initializer_list<typename boost::bimap<L, R>::value_type> list
-)
+// The enum strings are stored in a table with one entry per enum value, in the
+// order of the enum, so that a lookup is an index into the table. The table
+// is built at compile time.
+template <typename Enum, size_t N>
+using EnumStrings = std::array<std::pair<Enum, std::string_view>, N>;
+
+// Utility function to check that entry i of a table is for enum value i.
+template <typename Enum, size_t N>
+static constexpr bool IsInEnumOrder(const EnumStrings<Enum, N>& table)
 {
-    return boost::bimap<L, R>(list.begin(), list.end());
+    for (size_t idx {0}; idx < N; ++idx) {
+        if (static_cast<size_t>(table[idx].first) != idx) {
+            return false;
+        }
+    }
+    return true;
 }
 
 // StompClientError
 
-static const auto gStompClientErrorStrings {
-    MakeBimap<StompClientError, std::string_view>({
-        {StompClientError::kOk                                ,
-                           "Ok"                                },
-        {StompClientError::kUndefinedError                    ,
-                           "UndefinedError"                    },
-        {StompClientError::kCouldNotCloseWebSocketConnection  ,
-                           "CouldNotCloseWebSocketConnection"  },
-        {StompClientError::kCouldNotConnectToWebSocketServer  ,
-                           "CouldNotConnectToWebSocketServer"  },
-        {StompClientError::kCouldNotParseMessageAsStompFrame  ,
-                           "CouldNotParseMessageAsStompFrame"  },
-        {StompClientError::kCouldNotSendMessage               ,
-                           "CouldNotSendMessage"               },
-        {StompClientError::kCouldNotSendStompFrame            ,
-                           "CouldNotSendStompFrame"            },
-        {StompClientError::kCouldNotSendSubscribeFrame        ,
-                           "CouldNotSendSubscribeFrame"        },
-        {StompClientError::kUnexpectedCouldNotCreateValidFrame,
-                           "UnexpectedCouldNotCreateValidFrame"},
-        {StompClientError::kUnexpectedMessageContentType      ,
-                           "UnexpectedMessageContentType"      },
-        {StompClientError::kUnexpectedSubscriptionMismatch    ,
-                           "UnexpectedSubscriptionMismatch"    },
-        {StompClientError::kWebSocketServerDisconnected       ,
-                           "WebSocketServerDisconnected"       },
-    })
-};
+static constexpr EnumStrings<
+    StompClientError,
+    static_cast<size_t>(StompClientError::kWebSocketServerDisconnected) + 1
+> gStompClientErrorStrings {{
+    {StompClientError::kOk                                ,
+                       "Ok"                                },
+    {StompClientError::kUndefinedError                    ,
+                       "UndefinedError"                    },
+    {StompClientError::kCouldNotCloseWebSocketConnection  ,
+                       "CouldNotCloseWebSocketConnection"  },
+    {StompClientError::kCouldNotConnectToWebSocketServer  ,
+                       "CouldNotConnectToWebSocketServer"  },
+    {StompClientError::kCouldNotParseMessageAsStompFrame  ,
+                       "CouldNotParseMessageAsStompFrame"  },
+    {StompClientError::kCouldNotSendMessage               ,
+                       "CouldNotSendMessage"               },
+    {StompClientError::kCouldNotSendStompFrame            ,
+                       "CouldNotSendStompFrame"            },
+    {StompClientError::kCouldNotSendSubscribeFrame        ,
+                       "CouldNotSendSubscribeFrame"        },
+    {StompClientError::kUnexpectedCouldNotCreateValidFrame,
+                       "UnexpectedCouldNotCreateValidFrame"},
+    {StompClientError::kUnexpectedMessageContentType      ,
+                       "UnexpectedMessageContentType"      },
+    {StompClientError::kUnexpectedSubscriptionMismatch    ,
+                       "UnexpectedSubscriptionMismatch"    },
+    {StompClientError::kWebSocketServerDisconnected       ,
+                       "WebSocketServerDisconnected"       },
+}};
+static_assert(IsInEnumOrder(gStompClientErrorStrings),
+              "The StompClientError strings must follow the enum order");
 
 std::ostream& NetworkMonitor::operator<<(
     std::ostream& os,
     const StompClientError& error
 )
 {
-    auto errorIt {gStompClientErrorStrings.left.find(error)};
-    if (errorIt == gStompClientErrorStrings.left.end()) {
-        os << gStompClientErrorStrings.left.at(
-            StompClientError::kUndefinedError
-        );
-    } else {
-        os << errorIt->second;
-    }
-    return os;
+    return os << ToString(error);
 }
 
-std::string NetworkMonitor::ToString(const StompClientError& error)
+std::string_view NetworkMonitor::ToString(const StompClientError& error)
 {
-    static const auto undefinedError {std::string(
-        gStompClientErrorStrings.left.at(StompClientError::kUndefinedError)
-    )};
-    auto errorIt {gStompClientErrorStrings.left.find(error)};
-    if (errorIt == gStompClientErrorStrings.left.end()) {
-        return undefinedError;
+    const auto idx {static_cast<size_t>(error)};
+    if (idx >= gStompClientErrorStrings.size()) {
+        return gStompClientErrorStrings[
+            static_cast<size_t>(StompClientError::kUndefinedError)
+        ].second;
     }
-    return std::string(errorIt->second);
-}
\ No newline at end of file
+    return gStompClientErrorStrings[idx].second;
+}
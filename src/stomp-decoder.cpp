@@ -0,0 +1,255 @@
+#include "stomp-decoder.h"
+
+#include "stomp-frame.h"
+
+#include <algorithm>
+#include <charconv>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::StompDecoder;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+
+// StompDecoder — Public methods
+
+StompDecoder::StompDecoder(
+    const size_t maxFrameSize
+) : maxFrameSize_ {maxFrameSize}
+{
+}
+
+StompError StompDecoder::Decode(
+    const std::string_view chunk,
+    std::pmr::vector<StompFrame>& frames
+)
+{
+    if (error_ != StompError::kOk) {
+        return error_;
+    }
+
+    // Finish the frame we started in a previous chunk first.
+    size_t offset {0};
+    if (!pending_.empty()) {
+        bool frameComplete {false};
+        offset = ContinuePendingFrame(chunk, frameComplete);
+        if (error_ != StompError::kOk) {
+            return error_;
+        }
+        if (!frameComplete) {
+            if (pending_.size() > maxFrameSize_) {
+                error_ = StompError::kParsingFrameTooLarge;
+            }
+            return error_;
+        }
+        auto plain {std::move(pending_)};
+        pending_.clear();
+        auto ec {EmitFrame(std::move(plain), frames)};
+        if (ec != StompError::kOk) {
+            return ec;
+        }
+    }
+
+    // Frames that are entirely in the chunk do not go through the pending
+    // buffer.
+    while (offset < chunk.size()) {
+        if (chunk[offset] == '\n') {
+            ++offset;
+            continue;
+        }
+        const auto data {chunk.substr(offset)};
+        const auto frameSize {FindFrameEnd(data)};
+        if (error_ != StompError::kOk) {
+            return error_;
+        }
+        if (frameSize == 0) {
+            if (data.size() > maxFrameSize_) {
+                error_ = StompError::kParsingFrameTooLarge;
+                return error_;
+            }
+            pending_.assign(data);
+            return StompError::kOk;
+        }
+        if (frameSize > maxFrameSize_) {
+            error_ = StompError::kParsingFrameTooLarge;
+            return error_;
+        }
+        auto ec {EmitFrame(std::string {data.substr(0, frameSize)}, frames)};
+        if (ec != StompError::kOk) {
+            return ec;
+        }
+        offset += frameSize;
+    }
+    return StompError::kOk;
+}
+
+StompError StompDecoder::Decode(
+    std::string&& chunk,
+    std::pmr::vector<StompFrame>& frames
+)
+{
+    // StompFrame accepts new lines after the frame, so a chunk with a single
+    // frame followed by heart-beats can also be handed over.
+    if (error_ == StompError::kOk && pending_.empty() &&
+        !chunk.empty() && chunk[0] != '\n') {
+        const auto frameSize {FindFrameEnd(chunk)};
+        if (error_ != StompError::kOk) {
+            return error_;
+        }
+        if (frameSize > 0 && frameSize <= maxFrameSize_ &&
+            chunk.find_first_not_of('\n', frameSize) == std::string::npos) {
+            return EmitFrame(std::move(chunk), frames);
+        }
+    }
+    return Decode(std::string_view {chunk}, frames);
+}
+
+bool StompDecoder::HasPartialFrame() const
+{
+    return !pending_.empty();
+}
+
+void StompDecoder::Reset()
+{
+    error_ = StompError::kOk;
+    pending_.clear();
+    stage_ = Stage::kHeaders;
+    bodyStart_ = 0;
+    hasContentLength_ = false;
+    contentLength_ = 0;
+}
+
+// StompDecoder — Private methods
+
+size_t StompDecoder::FindFrameEnd(
+    const std::string_view data
+)
+{
+    stage_ = Stage::kHeaders;
+    bodyStart_ = 0;
+    hasContentLength_ = false;
+    contentLength_ = 0;
+
+    // The headers end with a blank line.
+    const auto headersEnd {data.find("\n\n")};
+    if (headersEnd == std::string_view::npos) {
+        return 0;
+    }
+    bodyStart_ = headersEnd + 2;
+    error_ = ReadContentLength(data.substr(0, headersEnd + 1));
+    if (error_ != StompError::kOk) {
+        return 0;
+    }
+    stage_ = Stage::kBody;
+
+    // Body
+    if (hasContentLength_) {
+        const auto frameSize {bodyStart_ + contentLength_ + 1};
+        return data.size() >= frameSize ? frameSize : 0;
+    }
+    const auto bodyEnd {data.find('\0', bodyStart_)};
+    return bodyEnd == std::string_view::npos ? 0 : bodyEnd + 1;
+}
+
+size_t StompDecoder::ContinuePendingFrame(
+    const std::string_view chunk,
+    bool& frameComplete
+)
+{
+    frameComplete = false;
+    size_t consumed {0};
+
+    // The blank line after the headers may start in the pending buffer.
+    if (stage_ == Stage::kHeaders) {
+        size_t headersEnd {std::string_view::npos};
+        if (pending_.back() == '\n' && !chunk.empty() && chunk[0] == '\n') {
+            headersEnd = 0;
+        } else {
+            const auto blankLine {chunk.find("\n\n")};
+            if (blankLine != std::string_view::npos) {
+                headersEnd = blankLine + 1;
+            }
+        }
+        if (headersEnd == std::string_view::npos) {
+            pending_.append(chunk);
+            return chunk.size();
+        }
+        consumed = headersEnd + 1;
+        pending_.append(chunk.substr(0, consumed));
+        bodyStart_ = pending_.size();
+        error_ = ReadContentLength(
+            std::string_view {pending_}.substr(0, bodyStart_ - 1)
+        );
+        if (error_ != StompError::kOk) {
+            return consumed;
+        }
+        stage_ = Stage::kBody;
+    }
+
+    // Body
+    const auto rest {chunk.substr(consumed)};
+    if (hasContentLength_) {
+        const auto frameSize {bodyStart_ + contentLength_ + 1};
+        const auto nBytes {std::min(frameSize - pending_.size(), rest.size())};
+        pending_.append(rest.substr(0, nBytes));
+        frameComplete = pending_.size() == frameSize;
+        return consumed + nBytes;
+    }
+    const auto bodyEnd {rest.find('\0')};
+    if (bodyEnd == std::string_view::npos) {
+        pending_.append(rest);
+        return consumed + rest.size();
+    }
+    pending_.append(rest.substr(0, bodyEnd + 1));
+    frameComplete = true;
+    return consumed + bodyEnd + 1;
+}
+
+StompError StompDecoder::ReadContentLength(
+    const std::string_view headers
+)
+{
+    // Header values cannot contain new lines, so this only matches a header
+    // name. As in StompFrame, the first occurrence wins.
+    static const std::string_view contentLength {"\ncontent-length:"};
+    const auto headerStart {headers.find(contentLength)};
+    if (headerStart == std::string_view::npos) {
+        return StompError::kOk;
+    }
+    const auto valueStart {headerStart + contentLength.size()};
+    const auto valueEnd {headers.find('\n', valueStart)};
+    const auto value {headers.substr(valueStart, valueEnd - valueStart)};
+    auto result {std::from_chars(
+        value.data(),
+        value.data() + value.size(),
+        contentLength_
+    )};
+    if (result.ec != std::errc {}) {
+        return StompError::kParsingInvalidContentLength;
+    }
+    if (contentLength_ >= maxFrameSize_ ||
+        bodyStart_ + contentLength_ + 1 > maxFrameSize_) {
+        return StompError::kParsingFrameTooLarge;
+    }
+    hasContentLength_ = true;
+    return StompError::kOk;
+}
+
+StompError StompDecoder::EmitFrame(
+    std::string&& plain,
+    std::pmr::vector<StompFrame>& frames
+)
+{
+    StompError ec {};
+    StompFrame frame {ec, std::move(plain)};
+    if (ec != StompError::kOk) {
+        error_ = ec;
+        return ec;
+    }
+    frames.push_back(std::move(frame));
+    return StompError::kOk;
+}
@@ -1,30 +1,77 @@
 #include "stomp-frame.h"
 
-#include <boost/bimap.hpp>
-
+#include <array>
 #include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <initializer_list>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <utility>
 
+// Vector instructions for the structural scanner. SSE2 is part of the x86-64
+// baseline; AVX2 is only used if the CPU supports it, which we check at
+// runtime with a GCC/Clang builtin.
+#if defined(__x86_64__) || defined(_M_X64)
+#define MNM_STOMP_SCANNER_X86
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define MNM_STOMP_SCANNER_AVX2
+#include <immintrin.h>
+#endif
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using NetworkMonitor::SharedStompFrame;
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFrameBuilder;
+using NetworkMonitor::StompFrameTemplate;
 using NetworkMonitor::StompHeader;
 
-using Headers = StompFrame::Headers;
+static_assert(StompFrame::kNHeaders <= 32,
+              "The header presence mask must have one bit per header");
+
+// Utility function to get the bit of a header in the header presence mask.
+static std::uint32_t ToHeaderBit(const StompHeader& header)
+{
+    return std::uint32_t {1} << static_cast<size_t>(header);
+}
 
-// Utility function to generate a boost::bimap, i.e bidirectional map
-// example usage: MakeBimap<std::string, int>
-template <typename L, typename R>
-static boost::bimap<L, R> MakeBimap(
-    std::initializer_list<typename boost::bimap<L, R>::value_type> list
+// The enum strings are stored in tables with one entry per enum value, in the
+// order of the enum, so that a lookup is an index into the table. The tables
+// are built at compile time.
+template <typename Enum, size_t N>
+using EnumStrings = std::array<std::pair<Enum, std::string_view>, N>;
+
+// Utility function to check that entry i of a table is for enum value i.
+template <typename Enum, size_t N>
+static constexpr bool IsInEnumOrder(const EnumStrings<Enum, N>& table)
+{
+    for (size_t idx {0}; idx < N; ++idx) {
+        if (static_cast<size_t>(table[idx].first) != idx) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Utility function to look up an enum string. Returns an empty view for
+// values that are not in the table.
+template <typename Enum, size_t N>
+static constexpr std::string_view GetEnumString(
+    const EnumStrings<Enum, N>& table,
+    const Enum& value
 )
 {
-    return boost::bimap<L, R>(list.begin(), list.end());
+    const auto idx {static_cast<size_t>(value)};
+    return idx < N ? table[idx].second : std::string_view {};
 }
 
 // Utility function to convert a std::string_view to a number.
@@ -41,198 +88,748 @@ static bool StoI(const std::string_view string, size_t& result)
 
 // StompCommand
 
-static const auto gStompCommandStrings {
-    MakeBimap<StompCommand, std::string_view>({
-        {StompCommand::kAbort      , "ABORT"      },
-        {StompCommand::kAck        , "ACK"        },
-        {StompCommand::kBegin      , "BEGIN"      },
-        {StompCommand::kCommit     , "COMMIT"     },
-        {StompCommand::kConnect    , "CONNECT"    },
-        {StompCommand::kConnected  , "CONNECTED"  },
-        {StompCommand::kDisconnect , "DISCONNECT" },
-        {StompCommand::kError      , "ERROR"      },
-        {StompCommand::kMessage    , "MESSAGE"    },
-        {StompCommand::kNack       , "NACK"       },
-        {StompCommand::kReceipt    , "RECEIPT"    },
-        {StompCommand::kSend       , "SEND"       },
-        {StompCommand::kStomp      , "STOMP"      },
-        {StompCommand::kSubscribe  , "SUBSCRIBE"  },
-        {StompCommand::kUnsubscribe, "UNSUBSCRIBE"},
-    })
-};
+static constexpr EnumStrings<
+    StompCommand,
+    static_cast<size_t>(StompCommand::kUnsubscribe) + 1
+> gStompCommandStrings {{
+    {StompCommand::kInvalid    , ""           },
+    {StompCommand::kAbort      , "ABORT"      },
+    {StompCommand::kAck        , "ACK"        },
+    {StompCommand::kBegin      , "BEGIN"      },
+    {StompCommand::kCommit     , "COMMIT"     },
+    {StompCommand::kConnect    , "CONNECT"    },
+    {StompCommand::kConnected  , "CONNECTED"  },
+    {StompCommand::kDisconnect , "DISCONNECT" },
+    {StompCommand::kError      , "ERROR"      },
+    {StompCommand::kMessage    , "MESSAGE"    },
+    {StompCommand::kNack       , "NACK"       },
+    {StompCommand::kReceipt    , "RECEIPT"    },
+    {StompCommand::kSend       , "SEND"       },
+    {StompCommand::kStomp      , "STOMP"      },
+    {StompCommand::kSubscribe  , "SUBSCRIBE"  },
+    {StompCommand::kUnsubscribe, "UNSUBSCRIBE"},
+}};
+static_assert(IsInEnumOrder(gStompCommandStrings),
+              "The StompCommand strings must follow the enum order");
+
+// The command as it appears in a frame. Returns an empty view for invalid
+// commands.
+static constexpr std::string_view GetCommandName(const StompCommand& command)
+{
+    return GetEnumString(gStompCommandStrings, command);
+}
 
 std::ostream& NetworkMonitor::operator<<(
     std::ostream& os,
     const StompCommand& command
 )
 {
-    auto commandIt {gStompCommandStrings.left.find(command)};
-    if (commandIt == gStompCommandStrings.left.end()) {
-        os << "StompCommand::kInvalid";
-    } else {
-        os << commandIt->second;
-    }
-    return os;
+    return os << ToString(command);
 }
 
-std::string NetworkMonitor::ToString(const StompCommand& command)
+std::string_view NetworkMonitor::ToString(const StompCommand& command)
 {
-    auto commandIt {gStompCommandStrings.left.find(command)};
-    if (commandIt == gStompCommandStrings.left.end()) {
-        return "StompCommand::kInvalid";
-    }
-    return std::string(commandIt->second);
+    const auto name {GetCommandName(command)};
+    return name.empty() ? "StompCommand::kInvalid" : name;
 }
 
-static const StompCommand& ToCommand(const std::string_view command)
+// We recognize commands with a switch on their length and first character,
+// which leaves at most one string comparison per command.
+static StompCommand ToCommand(const std::string_view command)
 {
-    static const auto invalidCommand {StompCommand::kInvalid};
-    auto commandIt {gStompCommandStrings.right.find(command)};
-    if (commandIt == gStompCommandStrings.right.end()) {
-        return invalidCommand;
+    if (command.empty()) {
+        return StompCommand::kInvalid;
     }
-    return commandIt->second;
+    auto match {[&command](
+        const std::string_view keyword,
+        const StompCommand value
+    ) {
+        return command == keyword ? value : StompCommand::kInvalid;
+    }};
+    switch (command.size()) {
+        case 3:
+            return match("ACK", StompCommand::kAck);
+        case 4:
+            switch (command[0]) {
+                case 'N': return match("NACK", StompCommand::kNack);
+                case 'S': return match("SEND", StompCommand::kSend);
+                default: break;
+            }
+            break;
+        case 5:
+            switch (command[0]) {
+                case 'A': return match("ABORT", StompCommand::kAbort);
+                case 'B': return match("BEGIN", StompCommand::kBegin);
+                case 'E': return match("ERROR", StompCommand::kError);
+                case 'S': return match("STOMP", StompCommand::kStomp);
+                default: break;
+            }
+            break;
+        case 6:
+            return match("COMMIT", StompCommand::kCommit);
+        case 7:
+            switch (command[0]) {
+                case 'C': return match("CONNECT", StompCommand::kConnect);
+                case 'M': return match("MESSAGE", StompCommand::kMessage);
+                case 'R': return match("RECEIPT", StompCommand::kReceipt);
+                default: break;
+            }
+            break;
+        case 9:
+            switch (command[0]) {
+                case 'C': return match("CONNECTED",
+                                       StompCommand::kConnected);
+                case 'S': return match("SUBSCRIBE",
+                                       StompCommand::kSubscribe);
+                default: break;
+            }
+            break;
+        case 10:
+            return match("DISCONNECT", StompCommand::kDisconnect);
+        case 11:
+            return match("UNSUBSCRIBE", StompCommand::kUnsubscribe);
+        default:
+            break;
+    }
+    return StompCommand::kInvalid;
 }
 
 // StompHeader
 
-static const auto gStompHeaderStrings {
-    MakeBimap<StompHeader, std::string_view>({
-        {StompHeader::kAcceptVersion, "accept-version"},
-        {StompHeader::kAck          , "ack"           },
-        {StompHeader::kContentLength, "content-length"},
-        {StompHeader::kContentType  , "content-type"  },
-        {StompHeader::kDestination  , "destination"   },
-        {StompHeader::kHeartBeat    , "heart-beat"    },
-        {StompHeader::kHost         , "host"          },
-        {StompHeader::kId           , "id"            },
-        {StompHeader::kLogin        , "login"         },
-        {StompHeader::kMessage      , "message"       },
-        {StompHeader::kMessageId    , "message-id"    },
-        {StompHeader::kPasscode     , "passcode"      },
-        {StompHeader::kReceipt      , "receipt"       },
-        {StompHeader::kReceiptId    , "receipt-id"    },
-        {StompHeader::kSession      , "session"       },
-        {StompHeader::kSubscription , "subscription"  },
-        {StompHeader::kTransaction  , "transaction"   },
-        {StompHeader::kServer       , "server"        },
-        {StompHeader::kVersion      , "version"       },
-    })
-};
+static constexpr EnumStrings<
+    StompHeader,
+    StompFrame::kNHeaders
+> gStompHeaderStrings {{
+    {StompHeader::kInvalid      , ""              },
+    {StompHeader::kAcceptVersion, "accept-version"},
+    {StompHeader::kAck          , "ack"           },
+    {StompHeader::kContentLength, "content-length"},
+    {StompHeader::kContentType  , "content-type"  },
+    {StompHeader::kDestination  , "destination"   },
+    {StompHeader::kHeartBeat    , "heart-beat"    },
+    {StompHeader::kHost         , "host"          },
+    {StompHeader::kId           , "id"            },
+    {StompHeader::kLogin        , "login"         },
+    {StompHeader::kMessage      , "message"       },
+    {StompHeader::kMessageId    , "message-id"    },
+    {StompHeader::kPasscode     , "passcode"      },
+    {StompHeader::kReceipt      , "receipt"       },
+    {StompHeader::kReceiptId    , "receipt-id"    },
+    {StompHeader::kSession      , "session"       },
+    {StompHeader::kSubscription , "subscription"  },
+    {StompHeader::kTransaction  , "transaction"   },
+    {StompHeader::kServer       , "server"        },
+    {StompHeader::kVersion      , "version"       },
+}};
+static_assert(IsInEnumOrder(gStompHeaderStrings),
+              "The StompHeader strings must follow the enum order");
+
+// The header name as it appears in a frame. Returns an empty view for invalid
+// headers.
+static constexpr std::string_view GetHeaderName(const StompHeader& header)
+{
+    return GetEnumString(gStompHeaderStrings, header);
+}
 
 std::ostream& NetworkMonitor::operator<<(
     std::ostream& os,
     const StompHeader& header
 )
 {
-    auto headerIt {gStompHeaderStrings.left.find(header)};
-    if (headerIt == gStompHeaderStrings.left.end()) {
-        os << "StompHeader::kInvalid";
-    } else {
-        os << headerIt->second;
-    }
-    return os;
+    return os << ToString(header);
 }
 
-std::string NetworkMonitor::ToString(const StompHeader& header)
+std::string_view NetworkMonitor::ToString(const StompHeader& header)
 {
-    auto headerIt {gStompHeaderStrings.left.find(header)};
-    if (headerIt == gStompHeaderStrings.left.end()) {
-        return "StompHeader::kInvalid";
-    }
-    return std::string(headerIt->second);
+    const auto name {GetHeaderName(header)};
+    return name.empty() ? "StompHeader::kInvalid" : name;
 }
 
-static const StompHeader& ToHeader(const std::string_view header)
+// Same as ToCommand: A switch on the length and on the first character of the
+// header name.
+static StompHeader ToHeader(const std::string_view header)
 {
-    static const auto invalidHeader {StompHeader::kInvalid};
-    auto headerIt {gStompHeaderStrings.right.find(header)};
-    if (headerIt == gStompHeaderStrings.right.end()) {
-        return invalidHeader;
+    if (header.empty()) {
+        return StompHeader::kInvalid;
     }
-    return headerIt->second;
+    auto match {[&header](
+        const std::string_view keyword,
+        const StompHeader value
+    ) {
+        return header == keyword ? value : StompHeader::kInvalid;
+    }};
+    switch (header.size()) {
+        case 2:
+            return match("id", StompHeader::kId);
+        case 3:
+            return match("ack", StompHeader::kAck);
+        case 4:
+            return match("host", StompHeader::kHost);
+        case 5:
+            return match("login", StompHeader::kLogin);
+        case 6:
+            return match("server", StompHeader::kServer);
+        case 7:
+            switch (header[0]) {
+                case 'm': return match("message", StompHeader::kMessage);
+                case 'r': return match("receipt", StompHeader::kReceipt);
+                case 's': return match("session", StompHeader::kSession);
+                case 'v': return match("version", StompHeader::kVersion);
+                default: break;
+            }
+            break;
+        case 8:
+            return match("passcode", StompHeader::kPasscode);
+        case 10:
+            switch (header[0]) {
+                case 'h': return match("heart-beat",
+                                       StompHeader::kHeartBeat);
+                case 'm': return match("message-id",
+                                       StompHeader::kMessageId);
+                case 'r': return match("receipt-id",
+                                       StompHeader::kReceiptId);
+                default: break;
+            }
+            break;
+        case 11:
+            switch (header[0]) {
+                case 'd': return match("destination",
+                                       StompHeader::kDestination);
+                case 't': return match("transaction",
+                                       StompHeader::kTransaction);
+                default: break;
+            }
+            break;
+        case 12:
+            switch (header[0]) {
+                case 'c': return match("content-type",
+                                       StompHeader::kContentType);
+                case 's': return match("subscription",
+                                       StompHeader::kSubscription);
+                default: break;
+            }
+            break;
+        case 14:
+            switch (header[0]) {
+                case 'a': return match("accept-version",
+                                       StompHeader::kAcceptVersion);
+                case 'c': return match("content-length",
+                                       StompHeader::kContentLength);
+                default: break;
+            }
+            break;
+        default:
+            break;
+    }
+    return StompHeader::kInvalid;
 }
 
 // StompError
 
-static const auto gStompErrorStrings {
-    MakeBimap<StompError, std::string_view>({
-        {StompError::kOk                                    ,
-                     "Ok"                                    },
-        {StompError::kUndefinedError                        ,
-                     "UndefinedError"                        },
-        {StompError::kParsingEmptyHeaderValue               ,
-                     "ParsingEmptyHeaderValue"               },
-        {StompError::kParsingContentLengthExceedsFrameLength,
-                     "ParsingContentLengthExceedsFrameLength"},
-        {StompError::kParsingInvalidContentLength           ,
-                     "ParsingInvalidContentLength"           },
-        {StompError::kParsingJunkAfterBody                  ,
-                     "ParsingJunkAfterBody"                  },
-        {StompError::kParsingMissingBlankLineAfterHeaders   ,
-                     "ParsingMissingBlankLineAfterHeaders   "},
-        {StompError::kParsingMissingColonInHeader           ,
-                     "ParsingMissingColonInHeader"           },
-        {StompError::kParsingMissingEolAfterCommand         ,
-                     "ParsingMissingEolAfterCommand"         },
-        {StompError::kParsingMissingEolAfterHeaderValue     ,
-                     "ParsingMissingEolAfterHeaderValue"     },
-        {StompError::kParsingMissingNullInBody              ,
-                     "ParsingMissingNullInBody"              },
-        {StompError::kParsingUnrecognizedCommand            ,
-                     "ParsingUnrecognizedCommand"            },
-        {StompError::kParsingUnrecognizedHeader             ,
-                     "ParsingUnrecognizedHeader"             },
-        {StompError::kValidationContentLengthMismatch       ,
-                     "ValidationContentLengthMismatch"       },
-        {StompError::kValidationInvalidCommand              ,
-                     "ValidationInvalidCommand"              },
-        {StompError::kValidationInvalidContentLength        ,
-                     "ValidationInvalidContentLength"        },
-        {StompError::kValidationMissingHeader               ,
-                     "ValidationMissingHeader"               },
-    })
-};
+static constexpr EnumStrings<
+    StompError,
+    static_cast<size_t>(StompError::kValidationMissingHeader) + 1
+> gStompErrorStrings {{
+    {StompError::kOk                                    ,
+                 "Ok"                                    },
+    {StompError::kUndefinedError                        ,
+                 "UndefinedError"                        },
+    {StompError::kParsingEmptyHeaderValue               ,
+                 "ParsingEmptyHeaderValue"               },
+    {StompError::kParsingContentLengthExceedsFrameLength,
+                 "ParsingContentLengthExceedsFrameLength"},
+    {StompError::kParsingFrameTooLarge                  ,
+                 "ParsingFrameTooLarge"                  },
+    {StompError::kParsingInvalidContentLength           ,
+                 "ParsingInvalidContentLength"           },
+    {StompError::kParsingJunkAfterBody                  ,
+                 "ParsingJunkAfterBody"                  },
+    {StompError::kParsingMissingBlankLineAfterHeaders   ,
+                 "ParsingMissingBlankLineAfterHeaders"   },
+    {StompError::kParsingMissingColonInHeader           ,
+                 "ParsingMissingColonInHeader"           },
+    {StompError::kParsingMissingEolAfterCommand         ,
+                 "ParsingMissingEolAfterCommand"         },
+    {StompError::kParsingMissingEolAfterHeaderValue     ,
+                 "ParsingMissingEolAfterHeaderValue"     },
+    {StompError::kParsingMissingNullInBody              ,
+                 "ParsingMissingNullInBody"              },
+    {StompError::kParsingUnrecognizedCommand            ,
+                 "ParsingUnrecognizedCommand"            },
+    {StompError::kParsingUnrecognizedHeader             ,
+                 "ParsingUnrecognizedHeader"             },
+    {StompError::kValidationContentLengthMismatch       ,
+                 "ValidationContentLengthMismatch"       },
+    {StompError::kValidationInvalidCommand              ,
+                 "ValidationInvalidCommand"              },
+    {StompError::kValidationInvalidContentLength        ,
+                 "ValidationInvalidContentLength"        },
+    {StompError::kValidationMissingHeader               ,
+                 "ValidationMissingHeader"               },
+}};
+static_assert(IsInEnumOrder(gStompErrorStrings),
+              "The StompError strings must follow the enum order");
 
 std::ostream& NetworkMonitor::operator<<(
     std::ostream& os,
     const StompError& error
 )
 {
-    static const auto undefinedError {
-        gStompErrorStrings.left.at(StompError::kUndefinedError)
-    };
-    auto errorIt {gStompErrorStrings.left.find(error)};
-    if (errorIt == gStompErrorStrings.left.end()) {
-        os << undefinedError;
-    } else {
-        os << errorIt->second;
+    return os << ToString(error);
+}
+
+std::string_view NetworkMonitor::ToString(const StompError& error)
+{
+    const auto name {GetEnumString(gStompErrorStrings, error)};
+    return name.empty() ? GetEnumString(gStompErrorStrings,
+                                        StompError::kUndefinedError) : name;
+}
+
+// Structural scanner
+
+// The STOMP parser only cares about three characters: The end of line, the
+// colon between a header name and its value, and the NULL octet at the end of
+// the body. The scanner classifies the frame 64 bytes at a time into one
+// bitmask per character, using the widest vector instructions available on
+// this CPU, and answers "where is the next structural character" queries from
+// the bitmasks.
+// The body is the bulk of large frames and only needs one character class, so
+// it gets its own vector loops.
+
+static constexpr std::uint8_t kNewLineBit {1 << 0};
+static constexpr std::uint8_t kColonBit {1 << 1};
+static constexpr std::uint8_t kNullBit {1 << 2};
+
+static constexpr size_t kScannerBlockSize {64};
+
+// One bit per byte of the block, for each structural character.
+struct StructuralMasks {
+    std::uint64_t newLines {0};
+    std::uint64_t colons {0};
+    std::uint64_t nulls {0};
+};
+
+// The scanner primitives, one implementation per instruction set.
+struct ScannerKernels {
+    // Classify a full block of kScannerBlockSize bytes.
+    void (*classifyBlock)(const char* block, StructuralMasks& masks);
+
+    // Get the position of the first byte equal to a value, or size if there
+    // is none.
+    size_t (*findByte)(const char* data, const size_t size, const char value);
+
+    // Get the position of the first byte different from a value, or size if
+    // there is none.
+    size_t (*skipByte)(const char* data, const size_t size, const char value);
+};
+
+static size_t CountTrailingZeros(const std::uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long idx {0};
+    _BitScanForward64(&idx, value);
+    return idx;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+[[maybe_unused]] static void ClassifyBlockScalar(
+    const char* block,
+    StructuralMasks& masks
+)
+{
+    masks = {};
+    for (size_t idx {0}; idx < kScannerBlockSize; ++idx) {
+        const std::uint64_t bit {std::uint64_t {1} << idx};
+        switch (block[idx]) {
+            case '\n': masks.newLines |= bit; break;
+            case ':': masks.colons |= bit; break;
+            case '\0': masks.nulls |= bit; break;
+            default: break;
+        }
     }
-    return os;
 }
 
-std::string NetworkMonitor::ToString(const StompError& error)
+static size_t FindByteScalar(
+    const char* data,
+    const size_t size,
+    const char value
+)
 {
-    static const auto undefinedError {std::string(
-        gStompErrorStrings.left.at(StompError::kUndefinedError)
+    const auto* found {std::memchr(data, value, size)};
+    return found == nullptr ? size : static_cast<const char*>(found) - data;
+}
+
+static size_t SkipByteScalar(
+    const char* data,
+    const size_t size,
+    const char value
+)
+{
+    size_t idx {0};
+    while (idx < size && data[idx] == value) {
+        ++idx;
+    }
+    return idx;
+}
+
+#if defined(MNM_STOMP_SCANNER_X86)
+static void ClassifyBlockSse2(const char* block, StructuralMasks& masks)
+{
+    const auto newLine {_mm_set1_epi8('\n')};
+    const auto colon {_mm_set1_epi8(':')};
+    const auto null {_mm_setzero_si128()};
+    masks = {};
+    for (size_t offset {0}; offset < kScannerBlockSize; offset += 16) {
+        const auto chunk {_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(block + offset)
+        )};
+        const std::uint16_t newLines {static_cast<std::uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newLine))
+        )};
+        masks.newLines |= std::uint64_t {newLines} << offset;
+        const std::uint16_t colons {static_cast<std::uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, colon))
+        )};
+        masks.colons |= std::uint64_t {colons} << offset;
+        const std::uint16_t nulls {static_cast<std::uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, null))
+        )};
+        masks.nulls |= std::uint64_t {nulls} << offset;
+    }
+}
+
+// With matchMask = 0, finds the first byte equal to the value. With
+// matchMask = 0xFFFF, finds the first byte different from the value.
+// Used for short inputs.
+static size_t ScanSse2(
+    const char* data,
+    const size_t size,
+    const char value,
+    const unsigned int matchMask
+)
+{
+    const auto needle {_mm_set1_epi8(value)};
+    size_t idx {0};
+    for (; idx + 16 <= size; idx += 16) {
+        const auto chunk {_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(data + idx)
+        )};
+        const unsigned int found {static_cast<unsigned int>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle))
+        ) ^ matchMask};
+        if (found != 0) {
+            return idx + CountTrailingZeros(found);
+        }
+    }
+    const auto tail {matchMask == 0 ?
+        FindByteScalar(data + idx, size - idx, value) :
+        SkipByteScalar(data + idx, size - idx, value)};
+    return idx + tail;
+}
+
+// Same as FindByteAvx2, with 64 bytes per iteration.
+static size_t FindByteSse2(
+    const char* data,
+    const size_t size,
+    const char value
+)
+{
+    if (size < 64) {
+        return ScanSse2(data, size, value, 0);
+    }
+    const auto needle {_mm_set1_epi8(value)};
+    const unsigned int head {static_cast<unsigned int>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)),
+            needle
+        )
+    ))};
+    if (head != 0) {
+        return CountTrailingZeros(head);
+    }
+    size_t idx {16 - reinterpret_cast<std::uintptr_t>(data) % 16};
+    for (; idx + 64 <= size; idx += 64) {
+        const auto* chunks {reinterpret_cast<const __m128i*>(data + idx)};
+        const auto found0 {_mm_cmpeq_epi8(_mm_load_si128(chunks + 0), needle)};
+        const auto found1 {_mm_cmpeq_epi8(_mm_load_si128(chunks + 1), needle)};
+        const auto found2 {_mm_cmpeq_epi8(_mm_load_si128(chunks + 2), needle)};
+        const auto found3 {_mm_cmpeq_epi8(_mm_load_si128(chunks + 3), needle)};
+        const auto found {_mm_or_si128(_mm_or_si128(found0, found1),
+                                       _mm_or_si128(found2, found3))};
+        if (_mm_movemask_epi8(found) == 0) {
+            continue;
+        }
+        const std::uint64_t mask {
+            std::uint64_t {static_cast<std::uint16_t>(
+                _mm_movemask_epi8(found0)
+            )} |
+            std::uint64_t {static_cast<std::uint16_t>(
+                _mm_movemask_epi8(found1)
+            )} << 16 |
+            std::uint64_t {static_cast<std::uint16_t>(
+                _mm_movemask_epi8(found2)
+            )} << 32 |
+            std::uint64_t {static_cast<std::uint16_t>(
+                _mm_movemask_epi8(found3)
+            )} << 48
+        };
+        return idx + CountTrailingZeros(mask);
+    }
+    return idx + ScanSse2(data + idx, size - idx, value, 0);
+}
+
+static size_t SkipByteSse2(
+    const char* data,
+    const size_t size,
+    const char value
+)
+{
+    return ScanSse2(data, size, value, 0xFFFF);
+}
+
+#if defined(MNM_STOMP_SCANNER_AVX2)
+__attribute__((target("avx2")))
+static void ClassifyBlockAvx2(const char* block, StructuralMasks& masks)
+{
+    const auto newLine {_mm256_set1_epi8('\n')};
+    const auto colon {_mm256_set1_epi8(':')};
+    const auto null {_mm256_setzero_si256()};
+    masks = {};
+    for (size_t offset {0}; offset < kScannerBlockSize; offset += 32) {
+        const auto chunk {_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(block + offset)
+        )};
+        const std::uint32_t newLines {static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newLine))
+        )};
+        masks.newLines |= std::uint64_t {newLines} << offset;
+        const std::uint32_t colons {static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, colon))
+        )};
+        masks.colons |= std::uint64_t {colons} << offset;
+        const std::uint32_t nulls {static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, null))
+        )};
+        masks.nulls |= std::uint64_t {nulls} << offset;
+    }
+}
+
+// Bodies can be large: We check 128 bytes per iteration, and only look for
+// the exact position once we know the value is in the current 128 bytes.
+// Shorter inputs are not worth the setup.
+__attribute__((target("avx2")))
+static size_t FindByteAvx2(
+    const char* data,
+    const size_t size,
+    const char value
+)
+{
+    if (size < 128) {
+        return FindByteSse2(data, size, value);
+    }
+    const auto needle {_mm256_set1_epi8(value)};
+
+    // We check the first 32 bytes with an unaligned load, then move on to
+    // aligned loads, which never cross a cache line.
+    const std::uint32_t head {static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)),
+            needle
+        ))
     )};
-    auto errorIt {gStompErrorStrings.left.find(error)};
-    if (errorIt == gStompErrorStrings.left.end()) {
-        return undefinedError;
+    if (head != 0) {
+        return CountTrailingZeros(head);
+    }
+    size_t idx {32 - reinterpret_cast<std::uintptr_t>(data) % 32};
+    for (; idx + 128 <= size; idx += 128) {
+        const auto* chunks {reinterpret_cast<const __m256i*>(data + idx)};
+        const auto found0 {_mm256_cmpeq_epi8(_mm256_load_si256(chunks + 0),
+                                             needle)};
+        const auto found1 {_mm256_cmpeq_epi8(_mm256_load_si256(chunks + 1),
+                                             needle)};
+        const auto found2 {_mm256_cmpeq_epi8(_mm256_load_si256(chunks + 2),
+                                             needle)};
+        const auto found3 {_mm256_cmpeq_epi8(_mm256_load_si256(chunks + 3),
+                                             needle)};
+        const auto found {_mm256_or_si256(_mm256_or_si256(found0, found1),
+                                          _mm256_or_si256(found2, found3))};
+        if (_mm256_testz_si256(found, found)) {
+            continue;
+        }
+        const std::uint64_t low {
+            static_cast<std::uint32_t>(_mm256_movemask_epi8(found0)) |
+            std::uint64_t {static_cast<std::uint32_t>(
+                _mm256_movemask_epi8(found1)
+            )} << 32
+        };
+        if (low != 0) {
+            return idx + CountTrailingZeros(low);
+        }
+        const std::uint64_t high {
+            static_cast<std::uint32_t>(_mm256_movemask_epi8(found2)) |
+            std::uint64_t {static_cast<std::uint32_t>(
+                _mm256_movemask_epi8(found3)
+            )} << 32
+        };
+        return idx + 64 + CountTrailingZeros(high);
     }
-    return std::string(errorIt->second);
+    return idx + FindByteSse2(data + idx, size - idx, value);
 }
 
-static const StompError& StringToError(const std::string_view error)
+// Trailing new lines are short, we do not unroll this loop.
+__attribute__((target("avx2")))
+static size_t SkipByteAvx2(
+    const char* data,
+    const size_t size,
+    const char value
+)
 {
-    static const auto invalidError {StompError::kUndefinedError};
-    auto errorIt {gStompErrorStrings.right.find(error)};
-    if (errorIt == gStompErrorStrings.right.end()) {
-        return invalidError;
+    const auto needle {_mm256_set1_epi8(value)};
+    size_t idx {0};
+    for (; idx + 32 <= size; idx += 32) {
+        const auto chunk {_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(data + idx)
+        )};
+        const std::uint32_t different {~static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle))
+        )};
+        if (different != 0) {
+            return idx + CountTrailingZeros(different);
+        }
+    }
+    return idx + SkipByteSse2(data + idx, size - idx, value);
+}
+#endif // MNM_STOMP_SCANNER_AVX2
+#endif // MNM_STOMP_SCANNER_X86
+
+// We pick the scanner kernels once, based on the CPU we run on.
+static ScannerKernels SelectScannerKernels()
+{
+#if defined(MNM_STOMP_SCANNER_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return {ClassifyBlockAvx2, FindByteAvx2, SkipByteAvx2};
     }
-    return errorIt->second;
+#endif
+#if defined(MNM_STOMP_SCANNER_X86)
+    return {ClassifyBlockSse2, FindByteSse2, SkipByteSse2};
+#else
+    return {ClassifyBlockScalar, FindByteScalar, SkipByteScalar};
+#endif
 }
 
+static const ScannerKernels gScannerKernels {SelectScannerKernels()};
+
+// Forward-only view of the structural characters of a frame. The last block
+// classified is cached, so successive queries in the same block, which is the
+// common case for header lines, do not classify it again.
+class StructuralScanner {
+public:
+    StructuralScanner(const std::string_view data)
+        : data_ {data}
+    {
+    }
+
+    // Find the first character in [from, end) in any of the requested
+    // classes.
+    // Returns std::string::npos if there is none.
+    size_t Find(
+        size_t from,
+        const std::uint8_t classes
+    )
+    {
+        while (from < data_.size()) {
+            const auto blockStart {from - from % kScannerBlockSize};
+            const auto& masks {Load(blockStart)};
+            std::uint64_t found {0};
+            if (classes & kNewLineBit) {
+                found |= masks.newLines;
+            }
+            if (classes & kColonBit) {
+                found |= masks.colons;
+            }
+            if (classes & kNullBit) {
+                found |= masks.nulls;
+            }
+            found &= ~std::uint64_t {0} << (from - blockStart);
+            found &= ValidBytes(blockStart);
+            if (found != 0) {
+                return blockStart + CountTrailingZeros(found);
+            }
+            from = blockStart + kScannerBlockSize;
+        }
+        return std::string::npos;
+    }
+
+    // Find the first NULL octet in [from, end).
+    // Returns std::string::npos if there is none.
+    size_t FindNull(
+        const size_t from
+    ) const
+    {
+        if (from >= data_.size()) {
+            return std::string::npos;
+        }
+        const auto size {data_.size() - from};
+        const auto idx {gScannerKernels.findByte(data_.data() + from, size,
+                                                 '\0')};
+        return idx == size ? std::string::npos : from + idx;
+    }
+
+    // Check that all the characters in [from, end) are new lines.
+    bool OnlyNewLines(
+        const size_t from
+    ) const
+    {
+        if (from >= data_.size()) {
+            return true;
+        }
+        const auto size {data_.size() - from};
+        return gScannerKernels.skipByte(data_.data() + from, size,
+                                        '\n') == size;
+    }
+
+private:
+    std::string_view data_ {};
+    size_t blockStart_ {std::string::npos};
+    StructuralMasks masks_ {};
+
+    const StructuralMasks& Load(
+        const size_t blockStart
+    )
+    {
+        if (blockStart == blockStart_) {
+            return masks_;
+        }
+        blockStart_ = blockStart;
+        if (blockStart + kScannerBlockSize <= data_.size()) {
+            gScannerKernels.classifyBlock(data_.data() + blockStart, masks_);
+        } else {
+            // The vector loads cannot read past the end of the frame, so we
+            // copy the last partial block. The padding bytes are masked out
+            // by ValidBytes.
+            char block[kScannerBlockSize];
+            std::memcpy(block, data_.data() + blockStart,
+                        data_.size() - blockStart);
+            gScannerKernels.classifyBlock(block, masks_);
+        }
+        return masks_;
+    }
+
+    // One bit per byte of the block that is part of the frame.
+    std::uint64_t ValidBytes(
+        const size_t blockStart
+    ) const
+    {
+        const auto nBytes {data_.size() - blockStart};
+        if (nBytes >= kScannerBlockSize) {
+            return ~std::uint64_t {0};
+        }
+        return (std::uint64_t {1} << nBytes) - 1;
+    }
+};
+
 // StompFrame — Public methods
 
 StompFrame::StompFrame() = default;
@@ -262,51 +859,43 @@ StompFrame::StompFrame(
     const std::string& body
 )
 {
-    using namespace std::string_literals;
-
-    // Construct the frame as a string.
-    std::string plain {""};
-    plain += NetworkMonitor::ToString(command);
-    plain += "\n";
+    StompFrameBuilder builder {command};
     for (const auto& [header, value]: headers) {
-        plain += NetworkMonitor::ToString(header);
-        plain += ":";
-        plain += value;
-        plain += "\n";
-    }
-    plain += "\n";
-    plain += body;
-    plain += "\0"s;
-    plain_ = std::move(plain);
-
-    // This may be wasteful, but we re-parse the frame to make sure it is a
-    // valid one. We may optimize this later.
-    ec = ParseAndValidateFrame(plain_);
+        builder.AddHeader(header, value);
+    }
+    builder.SetBody(body);
+    *this = builder.Build(ec);
 }
 
-// The copy constructor cannot copy the string views. Instead, we copy the
-// original plain-text frame and re-parse it.
-StompFrame::StompFrame(const StompFrame& other)
+StompFrame::StompFrame(const StompFrame& other) = default;
+
+// The moved-from frame is left empty, so that its offsets do not point past
+// the end of its (now empty) string.
+StompFrame::StompFrame(StompFrame&& other)
+    : plain_ {std::move(other.plain_)},
+      command_ {other.command_},
+      headers_ {other.headers_},
+      headerMask_ {other.headerMask_},
+      body_ {other.body_}
 {
-    plain_ = other.plain_;
-    ParseAndValidateFrame(plain_);
+    other.Clear();
 }
 
-StompFrame::StompFrame(StompFrame&& other) = default;
+StompFrame& StompFrame::operator=(const StompFrame& other) = default;
 
-// The copy assignment operator cannot copy the string views. Instead, we copy
-// the original plain-text frame and re-parse it.
-StompFrame& StompFrame::operator=(const StompFrame& other)
+StompFrame& StompFrame::operator=(StompFrame&& other)
 {
     if (this != &other) {
-        plain_ = other.plain_;
-        ParseAndValidateFrame(plain_);
+        plain_ = std::move(other.plain_);
+        command_ = other.command_;
+        headers_ = other.headers_;
+        headerMask_ = other.headerMask_;
+        body_ = other.body_;
+        other.Clear();
     }
     return *this;
 }
 
-StompFrame& StompFrame::operator=(StompFrame&& other) = default;
-
 StompCommand StompFrame::GetCommand() const
 {
     return command_;
@@ -314,33 +903,63 @@ StompCommand StompFrame::GetCommand() const
 
 const bool StompFrame::HasHeader(const StompHeader& header) const
 {
-    return headers_.find(header) != headers_.end();
+    return static_cast<size_t>(header) < kNHeaders &&
+        (headerMask_ & ToHeaderBit(header)) != 0;
 }
 
-const std::string_view& StompFrame::GetHeaderValue(
+std::string_view StompFrame::GetHeaderValue(
     const StompHeader& header
 ) const
 {
-    static const std::string_view emptyHeaderValue {""};
-    auto headerValueIt {headers_.find(header)};
-    if (headerValueIt == headers_.end()) {
-        return emptyHeaderValue;
+    if (!HasHeader(header)) {
+        return {};
     }
-    return headerValueIt->second;
+    const auto& value {headers_[static_cast<size_t>(header)]};
+    return std::string_view {plain_.data() + value.offset, value.size};
 }
 
-const std::string_view& StompFrame::GetBody() const
+std::string_view StompFrame::GetBody() const
 {
-    return body_;
+    return std::string_view {plain_.data() + body_.offset, body_.size};
 }
 
-std::string StompFrame::ToString() const
+const std::string& StompFrame::AsString() const
 {
     return plain_;
 }
 
+std::string StompFrame::ToString() const&
+{
+    return plain_;
+}
+
+std::string StompFrame::ToString() &&
+{
+    auto plain {std::move(plain_)};
+    Clear();
+    return plain;
+}
+
+std::string StompFrame::TakeBody() &&
+{
+    auto body {std::move(plain_)};
+    body.resize(body_.offset + body_.size);
+    body.erase(0, body_.offset);
+    Clear();
+    return body;
+}
+
 // StompFrame — Private methods
 
+void StompFrame::Clear()
+{
+    plain_.clear();
+    command_ = StompCommand::kInvalid;
+    headers_ = {};
+    headerMask_ = 0;
+    body_ = {};
+}
+
 StompError StompFrame::ParseAndValidateFrame(const std::string_view frame)
 {
     auto ec {ParseFrame(frame)};
@@ -351,10 +970,13 @@ StompError StompFrame::ParseAndValidateFrame(const std::string_view frame)
 }
 
 // A frame consists of a command, a set of optional headers and an optional body.
+// We walk the frame once with the structural scanner: Every block of the
+// frame is classified at most once, and the parser only moves forward.
 StompError StompFrame::ParseFrame(const std::string_view frame)
 {
     const std::string_view plain {frame};
-    
+    StructuralScanner scanner {plain};
+
     // Frame delimiters
     static const char null {'\0'};
     static const char colon {':'};
@@ -362,7 +984,7 @@ StompError StompFrame::ParseFrame(const std::string_view frame)
 
     // Command
     size_t commandStart {0};
-    size_t commandEnd {plain.find(newLine, commandStart)};
+    size_t commandEnd {scanner.Find(commandStart, kNewLineBit)};
     if (commandEnd == std::string::npos) {
         return StompError::kParsingMissingEolAfterCommand;
     }
@@ -376,11 +998,14 @@ StompError StompFrame::ParseFrame(const std::string_view frame)
     // Headers
     size_t headerLineStart {commandEnd + 1};
     Headers headers {};
+    std::uint32_t headerMask {0};
     while (headerLineStart < plain.size() &&
-           plain.at(headerLineStart) != newLine) {
+           plain[headerLineStart] != newLine) {
+        // A header name ends at the first colon, which must come before the
+        // end of the line.
         size_t headerStart {headerLineStart};
-        size_t headerEnd {plain.find(colon, headerStart)};
-        if (headerEnd == std::string::npos) {
+        size_t headerEnd {scanner.Find(headerStart, kColonBit | kNewLineBit)};
+        if (headerEnd == std::string::npos || plain[headerEnd] != colon) {
             return StompError::kParsingMissingColonInHeader;
         }
         auto header {ToHeader(
@@ -390,21 +1015,21 @@ StompError StompFrame::ParseFrame(const std::string_view frame)
             return StompError::kParsingUnrecognizedHeader;
         };
         size_t valueStart {headerEnd + 1};
-        if (plain.at(valueStart) == newLine) {
+        if (valueStart < plain.size() && plain[valueStart] == newLine) {
             return StompError::kParsingEmptyHeaderValue;
         }
-        size_t valueEnd {plain.find(newLine, valueStart)};
+        size_t valueEnd {scanner.Find(valueStart, kNewLineBit)};
         if (valueEnd == std::string::npos) {
             return StompError::kParsingMissingEolAfterHeaderValue;
         }
-        auto value {plain.substr(valueStart, valueEnd - valueStart)};
-
-        // Skip this header value if the header is already in the header map.
-        if (headers.find(header) == headers.end()) {
-            headers.emplace(std::make_pair(
-                std::move(header),
-                std::move(value))
-            );
+        // Skip this header value if the header is already in the table.
+        const auto headerBit {ToHeaderBit(header)};
+        if ((headerMask & headerBit) == 0) {
+            headers[static_cast<size_t>(header)] = {
+                valueStart,
+                valueEnd - valueStart
+            };
+            headerMask |= headerBit;
         }
 
         // Prepare for next line;
@@ -414,7 +1039,7 @@ StompError StompFrame::ParseFrame(const std::string_view frame)
     // Blank line between headers and body
     size_t newLineBeforeBody {headerLineStart};
     if (newLineBeforeBody >= plain.size() ||
-        plain.at(newLineBeforeBody) != newLine) {
+        plain[newLineBeforeBody] != newLine) {
         return StompError::kParsingMissingBlankLineAfterHeaders;
     }
 
@@ -423,11 +1048,16 @@ StompError StompFrame::ParseFrame(const std::string_view frame)
     size_t bodyStart {newLineBeforeBody + 1};
     size_t bodyEnd {0}; // The NULL octet
     size_t bodyLength {0};
-    auto contentLengthIt {headers.find(StompHeader::kContentLength)};
-    if (contentLengthIt != headers.end()) {
+    if ((headerMask & ToHeaderBit(StompHeader::kContentLength)) != 0) {
         // If the content-length header is present, we need to read the
-        // specified number of bytes.
-        auto ok {StoI(contentLengthIt->second, bodyLength)};
+        // specified number of bytes. The scanner skips the body entirely.
+        const auto& contentLength {
+            headers[static_cast<size_t>(StompHeader::kContentLength)]
+        };
+        auto ok {StoI(
+            plain.substr(contentLength.offset, contentLength.size),
+            bodyLength
+        )};
         if (!ok) {
             return StompError::kParsingInvalidContentLength;
         }
@@ -438,28 +1068,26 @@ StompError StompFrame::ParseFrame(const std::string_view frame)
             return StompError::kParsingContentLengthExceedsFrameLength;
         }
         bodyEnd = bodyStart + bodyLength;
-        if (plain.at(bodyEnd) != null) {
+        if (plain[bodyEnd] != null) {
             return StompError::kParsingMissingNullInBody;
         }
     } else {
         // If the content-length header is not present, we need to look for the
         // first NULL octet as a body delimiter.
-        bodyEnd = plain.find(null, bodyStart);
+        bodyEnd = scanner.FindNull(bodyStart);
         if (bodyEnd == std::string::npos) {
             return StompError::kParsingMissingNullInBody;
         }
         bodyLength = bodyEnd - bodyStart;
     }
-    for (size_t idx {bodyEnd + 1}; idx < plain.size(); ++idx) {
-        if (plain.at(idx) != newLine) {
-            return StompError::kParsingJunkAfterBody;
-        }
+    if (!scanner.OnlyNewLines(bodyEnd + 1)) {
+        return StompError::kParsingJunkAfterBody;
     }
-    auto body {plain.substr(bodyStart, bodyLength)};
 
-    command_ = std::move(command);
-    headers_ = std::move(headers);
-    body_ = std::move(body);
+    command_ = command;
+    headers_ = headers;
+    headerMask_ = headerMask;
+    body_ = {bodyStart, bodyLength};
     return StompError::kOk;
 }
 
@@ -521,10 +1149,325 @@ StompError StompFrame::ValidateFrame()
         if (!ok) {
             return StompError::kValidationInvalidContentLength;
         }
-        if (length != body_.size()) {
+        if (length != body_.size) {
             return StompError::kValidationContentLengthMismatch;
         }
     }
 
     return StompError::kOk;
-}
\ No newline at end of file
+}
+
+// SharedStompFrame
+
+SharedStompFrame NetworkMonitor::MakeSharedStompFrame(StompFrame&& frame)
+{
+    return std::make_shared<const StompFrame>(std::move(frame));
+}
+
+// StompFrameBuilder — Public methods
+
+StompFrameBuilder::StompFrameBuilder(
+    const StompCommand& command
+) : command_ {command}
+{
+}
+
+StompFrameBuilder& StompFrameBuilder::AddHeader(
+    const StompHeader& header,
+    const std::string_view value
+)
+{
+    auto* slot {NewHeader(header)};
+    if (slot == nullptr) {
+        return *this;
+    }
+    if (error_ == StompError::kOk && value.empty()) {
+        error_ = StompError::kParsingEmptyHeaderValue;
+    }
+    if (error_ == StompError::kOk &&
+        value.find('\n') != std::string_view::npos) {
+        error_ = StompError::kParsingMissingColonInHeader;
+    }
+    slot->value = value;
+    return *this;
+}
+
+StompFrameBuilder& StompFrameBuilder::AddHeader(
+    const StompHeader& header,
+    const size_t value
+)
+{
+    auto* slot {NewHeader(header)};
+    if (slot == nullptr) {
+        return *this;
+    }
+    auto result {std::to_chars(
+        slot->digits.data(),
+        slot->digits.data() + slot->digits.size(),
+        value
+    )};
+    slot->nDigits = result.ptr - slot->digits.data();
+    return *this;
+}
+
+StompFrameBuilder& StompFrameBuilder::SetBody(
+    const std::string_view body
+)
+{
+    body_ = body;
+    return *this;
+}
+
+StompFrame StompFrameBuilder::Build(
+    StompError& ec
+) const
+{
+    ec = error_;
+    if (ec != StompError::kOk) {
+        return {};
+    }
+    const auto command {GetCommandName(command_)};
+    if (command.empty()) {
+        ec = StompError::kValidationInvalidCommand;
+        return {};
+    }
+    if ((headerMask_ & ToHeaderBit(StompHeader::kContentLength)) == 0 &&
+        !body_.empty() &&
+        std::memchr(body_.data(), '\0', body_.size()) != nullptr) {
+        ec = StompError::kParsingJunkAfterBody;
+        return {};
+    }
+    auto getValue {[](const Header& header) {
+        return header.nDigits > 0 ?
+            std::string_view {header.digits.data(), header.nDigits} :
+            header.value;
+    }};
+
+    // Exact frame size, so that we write into a single allocation.
+    size_t size {command.size() + 1};
+    for (size_t idx {0}; idx < nHeaders_; ++idx) {
+        const auto& header {headers_[idx]};
+        size += GetHeaderName(header.header).size() + 1 +
+                getValue(header).size() + 1;
+    }
+    size += 1 + body_.size() + 1;
+
+    // We record where each value and the body start as we write them.
+    StompFrame frame {};
+    auto& plain {frame.plain_};
+    plain.reserve(size);
+    plain.append(command);
+    plain.push_back('\n');
+    for (size_t idx {0}; idx < nHeaders_; ++idx) {
+        const auto& header {headers_[idx]};
+        const auto value {getValue(header)};
+        plain.append(GetHeaderName(header.header));
+        plain.push_back(':');
+        frame.headers_[static_cast<size_t>(header.header)] = {
+            plain.size(),
+            value.size()
+        };
+        plain.append(value);
+        plain.push_back('\n');
+    }
+    plain.push_back('\n');
+    frame.body_ = {plain.size(), body_.size()};
+    plain.append(body_);
+    plain.push_back('\0');
+    frame.command_ = command_;
+    frame.headerMask_ = headerMask_;
+
+    // The frame is well-formed by construction, but the command may still
+    // require headers we did not get.
+    ec = frame.ValidateFrame();
+    if (ec != StompError::kOk) {
+        return {};
+    }
+    return frame;
+}
+
+// StompFrameBuilder — Private methods
+
+StompFrameBuilder::Header* StompFrameBuilder::NewHeader(
+    const StompHeader& header
+)
+{
+    if (header == StompHeader::kInvalid ||
+        static_cast<size_t>(header) >= StompFrame::kNHeaders) {
+        if (error_ == StompError::kOk) {
+            error_ = StompError::kParsingUnrecognizedHeader;
+        }
+        return nullptr;
+    }
+    const auto headerBit {ToHeaderBit(header)};
+    if ((headerMask_ & headerBit) != 0) {
+        return nullptr;
+    }
+    headerMask_ |= headerBit;
+    auto& slot {headers_[nHeaders_++]};
+    slot.header = header;
+    return &slot;
+}
+
+// StompFrameTemplate — Public methods
+
+StompFrameTemplate::StompFrameTemplate(
+    StompError& ec,
+    const StompCommand& command,
+    std::initializer_list<
+        std::pair<StompHeader, std::string_view>
+    > fixedHeaders,
+    std::initializer_list<StompHeader> variableHeaders
+) : command_ {command}
+{
+    error_ = StompError::kOk;
+    auto addHeader {[this](const StompHeader header) {
+        if (header == StompHeader::kInvalid ||
+            static_cast<size_t>(header) >= StompFrame::kNHeaders) {
+            if (error_ == StompError::kOk) {
+                error_ = StompError::kParsingUnrecognizedHeader;
+            }
+            return false;
+        }
+        const auto headerBit {ToHeaderBit(header)};
+        if ((headerMask_ & headerBit) != 0) {
+            return false;
+        }
+        headerMask_ |= headerBit;
+        return true;
+    }};
+
+    const auto commandName {GetCommandName(command_)};
+    if (commandName.empty()) {
+        error_ = StompError::kValidationInvalidCommand;
+    }
+    prefix_.append(commandName);
+    prefix_.push_back('\n');
+    for (const auto& [header, value]: fixedHeaders) {
+        if (!addHeader(header)) {
+            continue;
+        }
+        if (error_ == StompError::kOk && value.empty()) {
+            error_ = StompError::kParsingEmptyHeaderValue;
+        }
+        if (error_ == StompError::kOk &&
+            value.find('\n') != std::string_view::npos) {
+            error_ = StompError::kParsingMissingColonInHeader;
+        }
+        prefix_.append(GetHeaderName(header));
+        prefix_.push_back(':');
+        fixedHeaders_[static_cast<size_t>(header)] = {
+            prefix_.size(),
+            value.size()
+        };
+        prefix_.append(value);
+        prefix_.push_back('\n');
+    }
+    for (const auto header: variableHeaders) {
+        if (!addHeader(header)) {
+            continue;
+        }
+        if (header == StompHeader::kContentLength) {
+            hasContentLength_ = true;
+        } else {
+            variableHeaders_[nVariableHeaders_++] = header;
+        }
+    }
+    ec = error_;
+}
+
+StompFrame StompFrameTemplate::Render(
+    StompError& ec,
+    std::initializer_list<std::string_view> values,
+    const std::string_view body
+) const
+{
+    ec = error_;
+    if (ec != StompError::kOk) {
+        return {};
+    }
+    if (values.size() != nVariableHeaders_) {
+        ec = StompError::kValidationMissingHeader;
+        return {};
+    }
+    for (const auto& value: values) {
+        if (value.empty()) {
+            ec = StompError::kParsingEmptyHeaderValue;
+            return {};
+        }
+        if (value.find('\n') != std::string_view::npos) {
+            ec = StompError::kParsingMissingColonInHeader;
+            return {};
+        }
+    }
+    if (!hasContentLength_ && !body.empty() &&
+        std::memchr(body.data(), '\0', body.size()) != nullptr) {
+        ec = StompError::kParsingJunkAfterBody;
+        return {};
+    }
+    std::array<char, kMaxDigits> digits {};
+    size_t nDigits {0};
+    if (hasContentLength_) {
+        auto result {std::to_chars(
+            digits.data(),
+            digits.data() + digits.size(),
+            body.size()
+        )};
+        nDigits = result.ptr - digits.data();
+    }
+    const auto* header {variableHeaders_.data()};
+
+    // Exact frame size, so that we write into a single allocation.
+    size_t size {prefix_.size()};
+    for (const auto& value: values) {
+        size += GetHeaderName(*header++).size() + 1 + value.size() + 1;
+    }
+    if (hasContentLength_) {
+        size += GetHeaderName(StompHeader::kContentLength).size() + 1 +
+                nDigits + 1;
+    }
+    size += 1 + body.size() + 1;
+
+    // The fixed header locations are the same in every frame, as the prefix
+    // comes first.
+    StompFrame frame {};
+    auto& plain {frame.plain_};
+    plain.reserve(size);
+    plain.append(prefix_);
+    frame.headers_ = fixedHeaders_;
+    header = variableHeaders_.data();
+    for (const auto& value: values) {
+        plain.append(GetHeaderName(*header));
+        plain.push_back(':');
+        frame.headers_[static_cast<size_t>(*header++)] = {
+            plain.size(),
+            value.size()
+        };
+        plain.append(value);
+        plain.push_back('\n');
+    }
+    if (hasContentLength_) {
+        plain.append(GetHeaderName(StompHeader::kContentLength));
+        plain.push_back(':');
+        frame.headers_[static_cast<size_t>(StompHeader::kContentLength)] = {
+            plain.size(),
+            nDigits
+        };
+        plain.append(digits.data(), nDigits);
+        plain.push_back('\n');
+    }
+    plain.push_back('\n');
+    frame.body_ = {plain.size(), body.size()};
+    plain.append(body);
+    plain.push_back('\0');
+    frame.command_ = command_;
+    frame.headerMask_ = headerMask_;
+
+    // The frame is well-formed by construction, but the command may still
+    // require headers we did not get.
+    ec = frame.ValidateFrame();
+    if (ec != StompError::kOk) {
+        return {};
+    }
+    return frame;
+}
@@ -1,78 +1,80 @@
 #include <stomp-server.h>
 
-#include <boost/bimap.hpp>
-
-#include <initializer_list>
+#include <array>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 
 using NetworkMonitor::StompServerError;
 
-// Utility function to generate a boost::bimap.
-template <typename L, typename R>
-static boost::bimap<L, R> MakeBimap(
-    std::initializer_list<typename boost::bimap<L, R>::value_type> list
-)
+// The enum strings are stored in a table with one entry per enum value, in the
+// order of the enum, so that a lookup is an index into the table. The table
+// is built at compile time.
+template <typename Enum, size_t N>
+using EnumStrings = std::array<std::pair<Enum, std::string_view>, N>;
+
+// Utility function to check that entry i of a table is for enum value i.
+template <typename Enum, size_t N>
+static constexpr bool IsInEnumOrder(const EnumStrings<Enum, N>& table)
 {
-    return boost::bimap<L, R>(list.begin(), list.end());
+    for (size_t idx {0}; idx < N; ++idx) {
+        if (static_cast<size_t>(table[idx].first) != idx) {
+            return false;
+        }
+    }
+    return true;
 }
 
 // StompServerError
 
-static const auto gStompServerErrorStrings {
-    MakeBimap<StompServerError, std::string_view>({
-        {StompServerError::kOk                                ,
-                           "Ok"                                },
-        {StompServerError::kUndefinedError                    ,
-                           "UndefinedError"                    },
-        {StompServerError::kClientCannotReconnect             ,
-                           "ClientCannotReconnect"             },
-        {StompServerError::kCouldNotCloseClientConnection     ,
-                           "CouldNotCloseClientConnection"     },
-        {StompServerError::kCouldNotParseFrame                ,
-                           "CouldNotParseFrame"                },
-        {StompServerError::kCouldNotSendMessage               ,
-                           "CouldNotSendMessage"               },
-        {StompServerError::kCouldNotStartWebSocketServer      ,
-                           "CouldNotStartWebSocketServer"      },
-        {StompServerError::kInvalidHeaderValueAcceptVersion   ,
-                           "InvalidHeaderValueAcceptVersion"   },
-        {StompServerError::kInvalidHeaderValueHost            ,
-                           "InvalidHeaderValueHost"            },
-        {StompServerError::kUnsupportedFrame                  ,
-                           "UnsupportedFrame"                  },
-        {StompServerError::kWebSocketSessionDisconnected      ,
-                           "WebSocketSessionDisconnected"      },
-        {StompServerError::kWebSocketServerDisconnected       ,
-                           "WebSocketServerDisconnected"       },
-    })
-};
+static constexpr EnumStrings<
+    StompServerError,
+    static_cast<size_t>(StompServerError::kWebSocketServerDisconnected) + 1
+> gStompServerErrorStrings {{
+    {StompServerError::kOk                                ,
+                       "Ok"                                },
+    {StompServerError::kUndefinedError                    ,
+                       "UndefinedError"                    },
+    {StompServerError::kClientCannotReconnect             ,
+                       "ClientCannotReconnect"             },
+    {StompServerError::kCouldNotCloseClientConnection     ,
+                       "CouldNotCloseClientConnection"     },
+    {StompServerError::kCouldNotParseFrame                ,
+                       "CouldNotParseFrame"                },
+    {StompServerError::kCouldNotSendMessage               ,
+                       "CouldNotSendMessage"               },
+    {StompServerError::kCouldNotStartWebSocketServer      ,
+                       "CouldNotStartWebSocketServer"      },
+    {StompServerError::kInvalidHeaderValueAcceptVersion   ,
+                       "InvalidHeaderValueAcceptVersion"   },
+    {StompServerError::kInvalidHeaderValueHost            ,
+                       "InvalidHeaderValueHost"            },
+    {StompServerError::kUnsupportedFrame                  ,
+                       "UnsupportedFrame"                  },
+    {StompServerError::kWebSocketSessionDisconnected      ,
+                       "WebSocketSessionDisconnected"      },
+    {StompServerError::kWebSocketServerDisconnected       ,
+                       "WebSocketServerDisconnected"       },
+}};
+static_assert(IsInEnumOrder(gStompServerErrorStrings),
+              "The StompServerError strings must follow the enum order");
 
 std::ostream& NetworkMonitor::operator<<(
     std::ostream& os,
     const StompServerError& error
 )
 {
-    auto errorIt {gStompServerErrorStrings.left.find(error)};
-    if (errorIt == gStompServerErrorStrings.left.end()) {
-        os << gStompServerErrorStrings.left.at(
-            StompServerError::kUndefinedError
-        );
-    } else {
-        os << errorIt->second;
-    }
-    return os;
+    return os << ToString(error);
 }
 
-std::string NetworkMonitor::ToString(const StompServerError& error)
+std::string_view NetworkMonitor::ToString(const StompServerError& error)
 {
-    static const auto undefinedError {std::string(
-        gStompServerErrorStrings.left.at(StompServerError::kUndefinedError)
-    )};
-    auto errorIt {gStompServerErrorStrings.left.find(error)};
-    if (errorIt == gStompServerErrorStrings.left.end()) {
-        return undefinedError;
+    const auto idx {static_cast<size_t>(error)};
+    if (idx >= gStompServerErrorStrings.size()) {
+        return gStompServerErrorStrings[
+            static_cast<size_t>(StompServerError::kUndefinedError)
+        ].second;
     }
-    return std::string(errorIt->second);
-}
\ No newline at end of file
+    return gStompServerErrorStrings[idx].second;
+}
@@ -5,18 +5,28 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <istream>
 #include <memory>
 #include <queue>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 using NetworkMonitor::Id;
 using NetworkMonitor::Line;
+using NetworkMonitor::NetworkLayoutChanges;
+using NetworkMonitor::NetworkLayoutDelta;
 using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerEventRecord;
 using NetworkMonitor::Route;
 using NetworkMonitor::Station;
+using NetworkMonitor::StationCrowding;
+using NetworkMonitor::StationHandle;
 using NetworkMonitor::TransportNetwork;
 using NetworkMonitor::TravelRoute;
 
@@ -41,6 +51,14 @@ bool Line::operator==(const Line& other) const
     return id == other.id;
 }
 
+// StationCrowding — Public methods
+
+bool StationCrowding::operator==(const StationCrowding& other) const
+{
+    return stationId == other.stationId &&
+        passengerCount == other.passengerCount;
+}
+
 // TravelRoute — Public methods
 bool TravelRoute::Step::operator==(const TravelRoute::Step& other) const
 {
@@ -129,6 +147,433 @@ void NetworkMonitor::from_json(
     dst.steps = src.at("steps").get<std::vector<TravelRoute::Step>>();
 }
 
+void NetworkMonitor::to_json(
+    nlohmann::json& dst,
+    const StationCrowding& src
+)
+{
+    dst["station_id"] = src.stationId;
+    dst["passenger_count"] = src.passengerCount;
+}
+
+void NetworkMonitor::from_json(
+    const nlohmann::json& src,
+    StationCrowding& dst
+)
+{
+    dst.stationId = src.at("station_id").get<Id>();
+    dst.passengerCount = src.at("passenger_count").get<long long int>();
+}
+
+// NetworkLayoutDelta — Free functions
+
+static Route ParseDeltaRoute(
+    const nlohmann::json& src
+)
+{
+    return Route {
+        src.at("route_id").get<std::string>(),
+        src.at("direction").get<std::string>(),
+        src.at("line_id").get<std::string>(),
+        src.at("start_station_id").get<std::string>(),
+        src.at("end_station_id").get<std::string>(),
+        src.at("route_stops").get<std::vector<std::string>>(),
+    };
+}
+
+void NetworkMonitor::from_json(
+    const nlohmann::json& src,
+    NetworkLayoutDelta& dst
+)
+{
+    dst = NetworkLayoutDelta {};
+    if (src.contains("stations")) {
+        for (const auto& stationJson: src.at("stations")) {
+            dst.addedStations.push_back(Station {
+                stationJson.at("station_id").get<std::string>(),
+                stationJson.at("name").get<std::string>(),
+            });
+        }
+    }
+    if (src.contains("lines")) {
+        for (const auto& lineJson: src.at("lines")) {
+            Line line {
+                lineJson.at("line_id").get<std::string>(),
+                lineJson.at("name").get<std::string>(),
+                {},
+            };
+            for (const auto& routeJson: lineJson.at("routes")) {
+                line.routes.push_back(ParseDeltaRoute(routeJson));
+            }
+            dst.addedLines.push_back(std::move(line));
+        }
+    }
+    if (src.contains("routes")) {
+        for (const auto& routeJson: src.at("routes")) {
+            dst.addedRoutes.push_back(ParseDeltaRoute(routeJson));
+        }
+    }
+    if (src.contains("travel_times")) {
+        for (const auto& travelTimeJson: src.at("travel_times")) {
+            dst.travelTimes.push_back(NetworkLayoutDelta::TravelTime {
+                travelTimeJson.at("start_station_id").get<std::string>(),
+                travelTimeJson.at("end_station_id").get<std::string>(),
+                travelTimeJson.at("travel_time").get<unsigned int>(),
+            });
+        }
+    }
+    if (src.contains("closed_stations")) {
+        dst.closedStations =
+            src.at("closed_stations").get<std::vector<std::string>>();
+    }
+    if (src.contains("reopened_stations")) {
+        dst.reopenedStations =
+            src.at("reopened_stations").get<std::vector<std::string>>();
+    }
+}
+
+// Streaming network layout parser
+
+// SAX handler that adds stations, lines and travel times to the network as
+// soon as they are complete. Unknown keys are skipped, with their value.
+class NetworkLayoutSaxHandler: public nlohmann::json_sax<nlohmann::json> {
+public:
+    NetworkLayoutSaxHandler(
+        TransportNetwork& network
+    ) : network_ {network}
+    {
+    }
+
+    // Returns false if some travel times could not be set.
+    bool Finish()
+    {
+        if (!hasStations_ || !hasLines_ || !hasTravelTimes_) {
+            throw std::runtime_error(
+                "Network layout: Missing stations, lines or travel_times"
+            );
+        }
+        return ok_;
+    }
+
+    bool null() override
+    {
+        return true;
+    }
+
+    bool boolean(bool) override
+    {
+        return true;
+    }
+
+    bool number_integer(number_integer_t value) override
+    {
+        return number_unsigned(static_cast<number_unsigned_t>(value));
+    }
+
+    bool number_unsigned(number_unsigned_t value) override
+    {
+        if (Top() == Frame::kTravelTime && key_ == "travel_time") {
+            travelTime_ = static_cast<unsigned int>(value);
+            fields_ |= 0b100;
+        }
+        return true;
+    }
+
+    bool number_float(number_float_t, const string_t&) override
+    {
+        return true;
+    }
+
+    bool string(string_t& value) override
+    {
+        switch (Top()) {
+            case Frame::kStation: {
+                SetField("station_id", station_.id, value, 0b01) ||
+                SetField("name", station_.name, value, 0b10);
+                break;
+            }
+            case Frame::kLine: {
+                SetField("line_id", line_.id, value, 0b01) ||
+                SetField("name", line_.name, value, 0b10);
+                break;
+            }
+            case Frame::kRoute: {
+                SetField("route_id", route_.id, value, 0b00001) ||
+                SetField("direction", route_.direction, value, 0b00010) ||
+                SetField("line_id", route_.lineId, value, 0b00100) ||
+                SetField("start_station_id", route_.startStationId, value,
+                         0b01000) ||
+                SetField("end_station_id", route_.endStationId, value,
+                         0b10000);
+                break;
+            }
+            case Frame::kRouteStops: {
+                route_.stops.push_back(std::move(value));
+                break;
+            }
+            case Frame::kTravelTime: {
+                SetField("start_station_id", travelTimeStart_, value, 0b001) ||
+                SetField("end_station_id", travelTimeEnd_, value, 0b010);
+                break;
+            }
+            default:
+                break;
+        }
+        return true;
+    }
+
+    bool binary(binary_t&) override
+    {
+        return true;
+    }
+
+    bool start_object(std::size_t) override
+    {
+        auto frame {Frame::kSkip};
+        switch (Top()) {
+            case Frame::kNone: frame = Frame::kRoot; break;
+            case Frame::kStations: frame = Frame::kStation; break;
+            case Frame::kLines: frame = Frame::kLine; break;
+            case Frame::kRoutes: frame = Frame::kRoute; break;
+            case Frame::kTravelTimes: frame = Frame::kTravelTime; break;
+            default: break;
+        }
+        switch (frame) {
+            case Frame::kStation: station_ = {}; fields_ = 0; break;
+            case Frame::kLine: line_ = {}; fields_ = 0; break;
+            case Frame::kRoute: route_ = {}; fields_ = 0; break;
+            case Frame::kTravelTime: fields_ = 0; break;
+            default: break;
+        }
+        frames_.push_back(frame);
+        return true;
+    }
+
+    bool key(string_t& key) override
+    {
+        key_ = std::move(key);
+        return true;
+    }
+
+    bool end_object() override
+    {
+        const auto frame {Top()};
+        frames_.pop_back();
+        switch (frame) {
+            case Frame::kStation: {
+                RequireFields(fields_, 0b11, "station");
+                if (!network_.AddStation(station_)) {
+                    throw std::runtime_error("Could not add station " +
+                                             station_.id);
+                }
+                break;
+            }
+            case Frame::kLine: {
+                RequireFields(fields_, 0b111, "line");
+                if (hasStations_) {
+                    AddLine(line_);
+                } else {
+                    pendingLines_.push_back(std::move(line_));
+                }
+                break;
+            }
+            case Frame::kRoute: {
+                RequireFields(fields_, 0b111111, "route");
+                line_.routes.push_back(std::move(route_));
+                break;
+            }
+            case Frame::kTravelTime: {
+                RequireFields(fields_, 0b111, "travel time");
+                if (hasStations_ && hasLines_) {
+                    ok_ &= network_.SetTravelTime(
+                        travelTimeStart_, travelTimeEnd_, travelTime_
+                    );
+                } else {
+                    pendingTravelTimes_.push_back({
+                        std::move(travelTimeStart_),
+                        std::move(travelTimeEnd_),
+                        travelTime_,
+                    });
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        auto frame {Frame::kSkip};
+        if (Top() == Frame::kRoot && key_ == "stations") {
+            frame = Frame::kStations;
+        } else if (Top() == Frame::kRoot && key_ == "lines") {
+            frame = Frame::kLines;
+        } else if (Top() == Frame::kRoot && key_ == "travel_times") {
+            frame = Frame::kTravelTimes;
+        } else if (Top() == Frame::kLine && key_ == "routes") {
+            // The fields of the parent object are saved while we parse the
+            // nested objects.
+            lineFields_ = fields_;
+            frame = Frame::kRoutes;
+        } else if (Top() == Frame::kRoute && key_ == "route_stops") {
+            routeFields_ = fields_;
+            frame = Frame::kRouteStops;
+        }
+        frames_.push_back(frame);
+        return true;
+    }
+
+    bool end_array() override
+    {
+        const auto frame {Top()};
+        frames_.pop_back();
+        switch (frame) {
+            case Frame::kStations: {
+                hasStations_ = true;
+                for (const auto& line: pendingLines_) {
+                    AddLine(line);
+                }
+                pendingLines_.clear();
+                break;
+            }
+            case Frame::kLines: {
+                hasLines_ = true;
+                break;
+            }
+            case Frame::kTravelTimes: {
+                hasTravelTimes_ = true;
+                break;
+            }
+            case Frame::kRoutes: {
+                fields_ = lineFields_ | 0b100;
+                break;
+            }
+            case Frame::kRouteStops: {
+                fields_ = routeFields_ | 0b100000;
+                break;
+            }
+            default:
+                break;
+        }
+        if (hasStations_ && hasLines_) {
+            for (const auto& travelTime: pendingTravelTimes_) {
+                ok_ &= network_.SetTravelTime(
+                    travelTime.startStationId,
+                    travelTime.endStationId,
+                    travelTime.travelTime
+                );
+            }
+            pendingTravelTimes_.clear();
+        }
+        return true;
+    }
+
+    bool parse_error(
+        std::size_t,
+        const std::string&,
+        const nlohmann::detail::exception& ex
+    ) override
+    {
+        if (auto* error {dynamic_cast<const nlohmann::json::parse_error*>(
+            &ex
+        )}) {
+            throw *error;
+        }
+        throw std::runtime_error(ex.what());
+    }
+
+private:
+    enum class Frame {
+        kNone,
+        kRoot,
+        kStations,
+        kStation,
+        kLines,
+        kLine,
+        kRoutes,
+        kRoute,
+        kRouteStops,
+        kTravelTimes,
+        kTravelTime,
+        kSkip,
+    };
+
+    struct TravelTime {
+        Id startStationId {};
+        Id endStationId {};
+        unsigned int travelTime {0};
+    };
+
+    TransportNetwork& network_;
+    bool ok_ {true};
+
+    std::vector<Frame> frames_ {};
+    std::string key_ {};
+
+    // Bitmasks of the required fields found so far in the current object,
+    // and in the enclosing line and route.
+    unsigned int fields_ {0};
+    unsigned int lineFields_ {0};
+    unsigned int routeFields_ {0};
+
+    // Items being parsed
+    Station station_ {};
+    Line line_ {};
+    Route route_ {};
+    Id travelTimeStart_ {};
+    Id travelTimeEnd_ {};
+    unsigned int travelTime_ {0};
+
+    // Items that must wait for other sections of the document
+    bool hasStations_ {false};
+    bool hasLines_ {false};
+    bool hasTravelTimes_ {false};
+    std::vector<Line> pendingLines_ {};
+    std::vector<TravelTime> pendingTravelTimes_ {};
+
+    Frame Top() const
+    {
+        return frames_.empty() ? Frame::kNone : frames_.back();
+    }
+
+    bool SetField(
+        const char* name,
+        std::string& field,
+        std::string& value,
+        const unsigned int bit
+    )
+    {
+        if (key_ != name) {
+            return false;
+        }
+        field = std::move(value);
+        fields_ |= bit;
+        return true;
+    }
+
+    void RequireFields(
+        const unsigned int found,
+        const unsigned int required,
+        const std::string& item
+    )
+    {
+        if ((found & required) != required) {
+            throw std::runtime_error("Network layout: Incomplete " + item);
+        }
+    }
+
+    void AddLine(
+        const Line& line
+    )
+    {
+        if (!network_.AddLine(line)) {
+            throw std::runtime_error("Could not add line " + line.id);
+        }
+    }
+};
+
 // TransportNetwork — Public methods
 
 TransportNetwork::TransportNetwork() = default;
@@ -207,6 +652,15 @@ bool TransportNetwork::FromJson(
     return ok;
 }
 
+bool TransportNetwork::FromJsonStream(
+    std::istream& src
+)
+{
+    NetworkLayoutSaxHandler handler {*this};
+    nlohmann::json::sax_parse(src, &handler);
+    return handler.Finish();
+}
+
 bool TransportNetwork::AddStation(
     const Station& station
 )
@@ -217,14 +671,23 @@ bool TransportNetwork::AddStation(
     }
 
     // Create a new station node and add it to the map.
+    const auto handle {static_cast<StationHandle>(stationsByHandle_.size())};
     auto node {std::make_shared<GraphNode>(GraphNode {
         station.id,
         station.name,
+        handle,
         0, // We start with no passengers.
         {} // We start with no edges.
     })};
+    stationsByHandle_.push_back(node);
     stations_.emplace(station.id, std::move(node));
 
+    // Add the station to the bottom of the crowding heap. With no passengers,
+    // it can only move up past stations with a negative count.
+    crowdingHeap_.push_back(handle);
+    crowdingHeapPos_.push_back(crowdingHeap_.size() - 1);
+    SiftUpInCrowdingHeap(crowdingHeap_.size() - 1);
+
     return true;
 }
 
@@ -252,12 +715,106 @@ bool TransportNetwork::AddLine(
         }
     }
 
+    // Register the line with all the stations it serves.
+    for (const auto& [_, route]: lineInternal->routes) {
+        AddLineToStops(lineInternal, route);
+    }
+
     // Only add the line to the map when we are sure that there were no errors.
     lines_.emplace(line.id, std::move(lineInternal));
 
     return true;
 }
 
+bool TransportNetwork::ApplyDelta(
+    const NetworkLayoutDelta& delta,
+    NetworkLayoutChanges& changes
+)
+{
+    // We check the whole delta first, so that it is either applied in full or
+    // not at all. After this, none of the steps below can fail.
+    if (!IsValidDelta(delta)) {
+        return false;
+    }
+    changes = NetworkLayoutChanges {};
+    auto addRoute {[&changes](const auto& route) {
+        changes.routes.push_back(route.id);
+        changes.stations.insert(changes.stations.end(),
+                                route.stops.begin(), route.stops.end());
+    }};
+
+    // New stations, lines and routes
+    for (const auto& station: delta.addedStations) {
+        AddStation(station);
+        changes.stations.push_back(station.id);
+    }
+    for (const auto& line: delta.addedLines) {
+        AddLine(line);
+        for (const auto& route: line.routes) {
+            addRoute(route);
+        }
+    }
+    for (const auto& route: delta.addedRoutes) {
+        const auto lineInternal {GetLine(route.lineId)};
+        AddRouteToLine(route, lineInternal);
+        AddLineToStops(lineInternal, lineInternal->routes.at(route.id));
+        addRoute(route);
+    }
+
+    // Travel times
+    // We only touch the edges between the two stations.
+    for (const auto& travelTime: delta.travelTimes) {
+        const auto stationA {GetStation(travelTime.startStationId)};
+        const auto stationB {GetStation(travelTime.endStationId)};
+        auto setTravelTime {[&changes, &travelTime](auto from, auto to) {
+            for (auto& edge: from->edges) {
+                if (edge->nextStop == to &&
+                        edge->travelTime != travelTime.travelTime) {
+                    edge->travelTime = travelTime.travelTime;
+                    changes.routes.push_back(edge->route->id);
+                    changes.stations.push_back(from->id);
+                    changes.stations.push_back(to->id);
+                }
+            }
+        }};
+        setTravelTime(stationA, stationB);
+        setTravelTime(stationB, stationA);
+    }
+
+    // Station closures
+    auto setClosed {[this, &changes](const Id& stationId, const bool closed) {
+        const auto station {GetStation(stationId)};
+        if (station->closed == closed) {
+            return;
+        }
+        station->closed = closed;
+        changes.stations.push_back(station->id);
+        for (const auto& route: station->routes) {
+            changes.routes.push_back(route->id);
+        }
+    }};
+    for (const auto& stationId: delta.closedStations) {
+        setClosed(stationId, true);
+    }
+    for (const auto& stationId: delta.reopenedStations) {
+        setClosed(stationId, false);
+    }
+
+    for (auto* ids: {&changes.stations, &changes.routes}) {
+        std::sort(ids->begin(), ids->end());
+        ids->erase(std::unique(ids->begin(), ids->end()), ids->end());
+    }
+    return true;
+}
+
+bool TransportNetwork::IsStationClosed(
+    const Id& station
+) const
+{
+    const auto stationNode {GetStation(station)};
+    return stationNode != nullptr && stationNode->closed;
+}
+
 bool TransportNetwork::RecordPassengerEvent(
     const PassengerEvent& event
 )
@@ -269,12 +826,34 @@ bool TransportNetwork::RecordPassengerEvent(
     }
 
     // Increase or decrease the passenger count at the station.
+    long long int delta {0};
     switch (event.type) {
         case PassengerEvent::Type::In:
-            ++stationNode->passengerCount;
+            delta = 1;
+            break;
+        case PassengerEvent::Type::Out:
+            delta = -1;
+            break;
+        default:
+            return false;
+    }
+    UpdatePassengerCount(stationNode, delta);
+    return true;
+}
+
+bool TransportNetwork::RecordPassengerEvent(
+    const PassengerEventRecord& event
+)
+{
+    if (event.station >= stationsByHandle_.size()) {
+        return false;
+    }
+    switch (event.type) {
+        case PassengerEvent::Type::In:
+            UpdatePassengerCount(stationsByHandle_[event.station], 1);
             return true;
         case PassengerEvent::Type::Out:
-            --stationNode->passengerCount;
+            UpdatePassengerCount(stationsByHandle_[event.station], -1);
             return true;
         default:
             return false;
@@ -294,11 +873,192 @@ long long int TransportNetwork::GetPassengerCount(
     return stationNode->passengerCount;
 }
 
+long long int TransportNetwork::GetPassengerCount(
+    const StationHandle station
+) const
+{
+    if (station >= stationsByHandle_.size()) {
+        throw std::runtime_error("Invalid station handle: " +
+                                 std::to_string(station));
+    }
+    return stationsByHandle_[station]->passengerCount;
+}
+
+StationHandle TransportNetwork::GetStationHandle(
+    const Id& station
+) const
+{
+    // Find the station.
+    const auto stationNode {GetStation(station)};
+    if (stationNode == nullptr) {
+        throw std::runtime_error("Could not find station in the network: " +
+                                 station);
+    }
+    return stationNode->handle;
+}
+
+StationHandle TransportNetwork::FindStationHandle(
+    const std::string_view station
+) const
+{
+    const auto stationNode {GetStation(Id {station})};
+    return stationNode == nullptr ? kInvalidStationHandle : stationNode->handle;
+}
+
+size_t TransportNetwork::GetNStations() const
+{
+    return stationsByHandle_.size();
+}
+
+std::vector<Station> TransportNetwork::GetStations() const
+{
+    std::vector<Station> stations {};
+    stations.reserve(stationsByHandle_.size());
+    for (const auto& stationNode: stationsByHandle_) {
+        stations.push_back({stationNode->id, stationNode->name});
+    }
+    return stations;
+}
+
+std::vector<Line> TransportNetwork::GetLines() const
+{
+    std::vector<Line> lines {};
+    lines.reserve(lines_.size());
+    for (const auto& [lineId, lineInternal]: lines_) {
+        auto& line {lines.emplace_back()};
+        line.id = lineId;
+        line.name = lineInternal->name;
+        line.routes.reserve(lineInternal->routes.size());
+        for (const auto& [routeId, routeInternal]: lineInternal->routes) {
+            auto& route {line.routes.emplace_back()};
+            route.id = routeId;
+            route.lineId = lineId;
+            route.stops.reserve(routeInternal->stops.size());
+            for (const auto& stop: routeInternal->stops) {
+                route.stops.push_back(stop->id);
+            }
+            if (!route.stops.empty()) {
+                route.startStationId = route.stops.front();
+                route.endStationId = route.stops.back();
+            }
+        }
+        std::sort(line.routes.begin(), line.routes.end(),
+                  [](const auto& a, const auto& b) { return a.id < b.id; });
+    }
+    std::sort(lines.begin(), lines.end(),
+              [](const auto& a, const auto& b) { return a.id < b.id; });
+    return lines;
+}
+
+long long int TransportNetwork::GetRoutePassengerCount(
+    const Id& line,
+    const Id& route
+) const
+{
+    // Find the route.
+    const auto routeInternal {GetRoute(line, route)};
+    if (routeInternal == nullptr) {
+        throw std::runtime_error("Could not find route in the network: " +
+                                 route);
+    }
+    return routeInternal->passengerCount;
+}
+
+long long int TransportNetwork::GetLinePassengerCount(
+    const Id& line
+) const
+{
+    // Find the line.
+    const auto lineInternal {GetLine(line)};
+    if (lineInternal == nullptr) {
+        throw std::runtime_error("Could not find line in the network: " +
+                                 line);
+    }
+    return lineInternal->passengerCount;
+}
+
+std::vector<StationCrowding> TransportNetwork::GetMostCrowdedStations(
+    const size_t k
+) const
+{
+    std::vector<StationCrowding> stations {};
+    const auto nStations {std::min(k, crowdingHeap_.size())};
+    if (nStations == 0) {
+        return stations;
+    }
+    stations.reserve(nStations);
+
+    // Best-first visit of the heap: The next most crowded station is always
+    // the root or a child of a station we have already visited. We only ever
+    // look at O(k) heap positions.
+    auto cmp {[this](const size_t a, const size_t b) {
+        return IsMoreCrowded(crowdingHeap_[b], crowdingHeap_[a]);
+    }};
+    std::priority_queue<size_t, std::vector<size_t>, decltype(cmp)> frontier {
+        cmp
+    };
+    frontier.push(0);
+    while (stations.size() < nStations) {
+        const auto pos {frontier.top()};
+        frontier.pop();
+        const auto& node {stationsByHandle_[crowdingHeap_[pos]]};
+        stations.push_back({node->id, node->passengerCount});
+        for (const auto child: {2 * pos + 1, 2 * pos + 2}) {
+            if (child < crowdingHeap_.size()) {
+                frontier.push(child);
+            }
+        }
+    }
+    return stations;
+}
+
 /*! \brief Set the network representation crowding..
     *
     *  This method can be used when testing to pre-seed the network with the
     *  desired crowding.
     */
+std::vector<long long int> TransportNetwork::GetPassengerCounts() const
+{
+    std::vector<long long int> passengerCounts {};
+    passengerCounts.reserve(stationsByHandle_.size());
+    for (const auto& stationNode: stationsByHandle_) {
+        passengerCounts.push_back(stationNode->passengerCount);
+    }
+    return passengerCounts;
+}
+
+bool TransportNetwork::SetPassengerCounts(
+    const std::vector<long long int>& passengerCounts
+)
+{
+    if (passengerCounts.size() != stationsByHandle_.size()) {
+        return false;
+    }
+    for (size_t handle {0}; handle < passengerCounts.size(); ++handle) {
+        const auto& stationNode {stationsByHandle_[handle]};
+        const auto delta {passengerCounts[handle] - stationNode->passengerCount};
+        if (delta != 0) {
+            UpdatePassengerCount(stationNode, delta);
+        }
+    }
+    return true;
+}
+
+std::uint64_t TransportNetwork::GetLayoutHash() const
+{
+    // FNV-1a over the station IDs, in handle order. The terminating null
+    // character separates consecutive IDs.
+    std::uint64_t hash {14695981039346656037ull};
+    for (const auto& stationNode: stationsByHandle_) {
+        for (const char c: stationNode->id) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 void TransportNetwork::SetNetworkCrowding(
     const std::unordered_map<Id, int>& passengerCounts
 )
@@ -322,31 +1082,13 @@ std::vector<Id> TransportNetwork::GetRoutesServingStation(
         return {};
     }
 
+    // The station keeps a fan-out list of all the routes serving it, including
+    // the routes that end at the station (which have no departing edge).
     std::vector<Id> routes {};
-
-    // Iterate over all edges departing from the node. Each edge corresponds to
-    // one route serving the station.
-    const auto& edges {stationNode->edges};
-    for (const auto& edge: edges) {
-        routes.push_back(edge->route->id);
+    routes.reserve(stationNode->routes.size());
+    for (const auto& route: stationNode->routes) {
+        routes.push_back(route->id);
     }
-
-    // The previous loop misses a corner case: The end station of a route does
-    // not have any edge containing that route, because we only track the routes
-    // that *leave from*, not *arrive to* a certain station.
-    // We need to loop over all line routes to check if our station is the end
-    // stop of any route.
-    // FIXME: In the worst case, we are iterating over all routes for all
-    //        lines in the network. We may want to optimize this.
-    for (const auto& [_, line]: lines_) {
-        for (const auto& [_, route]: line->routes) {
-            const auto& endStop {route->stops[route->stops.size() - 1]};
-            if (stationNode == endStop) {
-                routes.push_back(route->id);
-            }
-        }
-    }
-
     return routes;
 }
 
@@ -472,6 +1214,16 @@ TravelRoute TransportNetwork::GetFastestTravelRoute(
     }
     spdlog::info("GetFastestTravelRoute: {} -> {}", stationA->id, stationB->id);
 
+    // Corner case: There is no valid path from or to a closed station.
+    if (stationA->closed || stationB->closed) {
+        return TravelRoute {
+            stationAId,
+            stationBId,
+            0,
+            {},
+        };
+    }
+
     // Corner case: A and B are the same station.
     if (stationA == stationB) {
         return TravelRoute {
@@ -545,6 +1297,16 @@ TravelRoute TransportNetwork::GetQuietTravelRoute(
     }
     spdlog::info("GetQuietTravelRoute: {} -> {}", stationA->id, stationB->id);
 
+    // Corner case: There is no valid path from or to a closed station.
+    if (stationA->closed || stationB->closed) {
+        return TravelRoute {
+            stationAId,
+            stationBId,
+            0,
+            {},
+        };
+    }
+
     // Corner case: A and B are the same station.
     if (stationA == stationB) {
         return TravelRoute {
@@ -594,7 +1356,12 @@ TravelRoute TransportNetwork::GetQuietTravelRoute(
         minCrowding * (1 - minQuietnessPc)
     )};
     for (size_t idx {1}; idx < paths.size(); ++idx) {
-        auto crowding {GetPathCrowding(paths[idx])};
+        // We can discard a path as soon as its crowding exceeds the best one
+        // we found so far, or the quietness threshold.
+        auto crowding {GetPathCrowding(
+            paths[idx],
+            std::min(maxCrowding, minCrowding)
+        )};
         if (crowding > maxCrowding) {
             continue;
         }
@@ -760,12 +1527,223 @@ bool TransportNetwork::AddRouteToLine(
         }));
     }
 
+    // Add the route to the fan-out list of every stop, and seed the route
+    // crowding with the passengers that we may have already recorded.
+    for (const auto& stop: routeInternal->stops) {
+        stop->routes.push_back(routeInternal);
+        routeInternal->passengerCount += stop->passengerCount;
+    }
+
     // Finally, add the route to the line.
     lineInternal->routes[route.id] = std::move(routeInternal);
 
     return true;
 }
 
+void TransportNetwork::AddLineToStops(
+    const std::shared_ptr<LineInternal>& lineInternal,
+    const std::shared_ptr<RouteInternal>& routeInternal
+)
+{
+    // A station served by multiple routes of the same line only contributes
+    // to the line crowding once.
+    for (const auto& stop: routeInternal->stops) {
+        auto& lines {stop->lines};
+        if (std::find(lines.begin(), lines.end(), lineInternal) ==
+                lines.end()) {
+            lines.push_back(lineInternal);
+            lineInternal->passengerCount += stop->passengerCount;
+        }
+    }
+}
+
+bool TransportNetwork::IsValidDelta(
+    const NetworkLayoutDelta& delta
+) const
+{
+    // New stations
+    std::unordered_set<Id> newStations {};
+    for (const auto& station: delta.addedStations) {
+        if (GetStation(station.id) != nullptr ||
+                !newStations.insert(station.id).second) {
+            return false;
+        }
+    }
+    auto stationExists {[this, &newStations](const Id& stationId) {
+        return GetStation(stationId) != nullptr ||
+            newStations.find(stationId) != newStations.end();
+    }};
+
+    // New lines and routes
+    std::unordered_set<Id> newLines {};
+    std::vector<const Route*> newRoutes {};
+    for (const auto& line: delta.addedLines) {
+        if (GetLine(line.id) != nullptr || line.routes.empty() ||
+                !newLines.insert(line.id).second) {
+            return false;
+        }
+        for (const auto& route: line.routes) {
+            if (route.lineId != line.id) {
+                return false;
+            }
+            newRoutes.push_back(&route);
+        }
+    }
+    for (const auto& route: delta.addedRoutes) {
+        if (GetLine(route.lineId) == nullptr ||
+                GetRoute(route.lineId, route.id) != nullptr) {
+            return false;
+        }
+        newRoutes.push_back(&route);
+    }
+    std::unordered_set<Id> newRouteKeys {};
+    for (const auto* route: newRoutes) {
+        if (!newRouteKeys.insert(route->lineId + '\0' + route->id).second ||
+                route->stops.size() < 2) {
+            return false;
+        }
+        std::unordered_set<Id> stops {};
+        for (const auto& stop: route->stops) {
+            if (!stationExists(stop) || !stops.insert(stop).second) {
+                return false;
+            }
+        }
+    }
+
+    // Travel times
+    // The stations must be adjacent in an existing route or in a new one.
+    auto isAdjacent {[this, &newRoutes](const Id& stationA, const Id& stationB) {
+        const auto stationANode {GetStation(stationA)};
+        const auto stationBNode {GetStation(stationB)};
+        auto hasEdge {[](const auto& from, const auto& to) {
+            return from != nullptr && to != nullptr &&
+                std::any_of(from->edges.begin(), from->edges.end(),
+                            [&to](const auto& edge) {
+                                return edge->nextStop == to;
+                            });
+        }};
+        if (hasEdge(stationANode, stationBNode) ||
+                hasEdge(stationBNode, stationANode)) {
+            return true;
+        }
+        for (const auto* route: newRoutes) {
+            const auto& stops {route->stops};
+            for (size_t idx {0}; idx + 1 < stops.size(); ++idx) {
+                if ((stops[idx] == stationA && stops[idx + 1] == stationB) ||
+                    (stops[idx] == stationB && stops[idx + 1] == stationA)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }};
+    for (const auto& travelTime: delta.travelTimes) {
+        if (!isAdjacent(travelTime.startStationId, travelTime.endStationId)) {
+            return false;
+        }
+    }
+
+    // Station closures
+    for (const auto* stationIds: {&delta.closedStations,
+                                  &delta.reopenedStations}) {
+        for (const auto& stationId: *stationIds) {
+            if (!stationExists(stationId)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void TransportNetwork::UpdatePassengerCount(
+    const std::shared_ptr<GraphNode>& station,
+    const long long int delta
+)
+{
+    const auto wasNegative {station->passengerCount < 0};
+    station->passengerCount += delta;
+    const auto isNegative {station->passengerCount < 0};
+    if (wasNegative != isNegative) {
+        isNegative ? ++nNegativeStations_ : --nNegativeStations_;
+    }
+
+    // Propagate the change to the route and line aggregates through the
+    // station fan-out lists.
+    for (const auto& route: station->routes) {
+        route->passengerCount += delta;
+    }
+    for (const auto& line: station->lines) {
+        line->passengerCount += delta;
+    }
+
+    // Restore the crowding ranking.
+    const auto pos {crowdingHeapPos_[station->handle]};
+    if (delta > 0) {
+        SiftUpInCrowdingHeap(pos);
+    } else {
+        SiftDownInCrowdingHeap(pos);
+    }
+}
+
+bool TransportNetwork::IsMoreCrowded(
+    const StationHandle a,
+    const StationHandle b
+) const
+{
+    const auto countA {stationsByHandle_[a]->passengerCount};
+    const auto countB {stationsByHandle_[b]->passengerCount};
+    if (countA != countB) {
+        return countA > countB;
+    }
+    // Break ties by insertion order, so the ranking is deterministic.
+    return a < b;
+}
+
+void TransportNetwork::SwapInCrowdingHeap(
+    const size_t posA,
+    const size_t posB
+)
+{
+    std::swap(crowdingHeap_[posA], crowdingHeap_[posB]);
+    crowdingHeapPos_[crowdingHeap_[posA]] = posA;
+    crowdingHeapPos_[crowdingHeap_[posB]] = posB;
+}
+
+void TransportNetwork::SiftUpInCrowdingHeap(
+    size_t pos
+)
+{
+    while (pos > 0) {
+        const auto parent {(pos - 1) / 2};
+        if (!IsMoreCrowded(crowdingHeap_[pos], crowdingHeap_[parent])) {
+            break;
+        }
+        SwapInCrowdingHeap(pos, parent);
+        pos = parent;
+    }
+}
+
+void TransportNetwork::SiftDownInCrowdingHeap(
+    size_t pos
+)
+{
+    const auto size {crowdingHeap_.size()};
+    while (true) {
+        auto mostCrowded {pos};
+        for (const auto child: {2 * pos + 1, 2 * pos + 2}) {
+            if (child < size && IsMoreCrowded(crowdingHeap_[child],
+                                              crowdingHeap_[mostCrowded])) {
+                mostCrowded = child;
+            }
+        }
+        if (mostCrowded == pos) {
+            break;
+        }
+        SwapInCrowdingHeap(pos, mostCrowded);
+        pos = mostCrowded;
+    }
+}
+
 TransportNetwork::Path TransportNetwork::GetFastestTravelRoute(
     const TransportNetwork::PathStopDist& stopA,
     const std::shared_ptr<TransportNetwork::GraphNode>& stationB,
@@ -813,7 +1791,8 @@ TransportNetwork::Path TransportNetwork::GetFastestTravelRoute(
         // Explore the neighborhood.
         for (const auto& neighborEdge: currStation->edges) {
             PathStop neighbor {neighborEdge->nextStop, neighborEdge};
-            if (excludedStops.find(neighbor) != excludedStops.end()) {
+            if (neighbor.node->closed ||
+                    excludedStops.find(neighbor) != excludedStops.end()) {
                 continue;
             }
 
@@ -985,12 +1964,20 @@ std::vector<TransportNetwork::Path> TransportNetwork::GetFastestTravelRoutes(
 }
 
 unsigned int TransportNetwork::GetPathCrowding(
-    const Path& path
+    const Path& path,
+    const unsigned int stopAbove
 ) const
 {
+    // When no station has a negative passenger count, the partial crowding can
+    // only grow as we walk the path, so we can stop as soon as it exceeds the
+    // caller's threshold.
+    const bool canStopEarly {nNegativeStations_ == 0};
     unsigned int totPassengerCount {0};
     for (const auto& [stop, _]: path) {
         totPassengerCount += stop.node->passengerCount;
+        if (canStopEarly && totPassengerCount > stopAbove) {
+            break;
+        }
     }
     return totPassengerCount;
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "buffer-pool.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <utility>
+
+using NetworkMonitor::BufferPool;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_BufferPool);
+
+BOOST_AUTO_TEST_CASE(acquire_empty_pool)
+{
+    BufferPool pool {};
+    auto buffer {pool.Acquire(1000)};
+    BOOST_CHECK(buffer.empty());
+    BOOST_CHECK_GE(buffer.capacity(), 1000);
+    BOOST_CHECK_EQUAL(pool.GetNAllocations(), 1);
+    BOOST_CHECK_EQUAL(pool.GetNBuffers(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(reuse)
+{
+    BufferPool pool {};
+    auto buffer {pool.Acquire(1000)};
+    buffer.assign(1000, 'a');
+    const auto* data {buffer.data()};
+    pool.Release(std::move(buffer));
+    BOOST_CHECK_EQUAL(pool.GetNBuffers(), 1);
+
+    // A smaller or equal request reuses the buffer, cleared.
+    for (const size_t size: {10, 1000}) {
+        auto reused {pool.Acquire(size)};
+        BOOST_CHECK(reused.empty());
+        BOOST_CHECK(reused.data() == data);
+        pool.Release(std::move(reused));
+    }
+    BOOST_CHECK_EQUAL(pool.GetNAllocations(), 1);
+
+    // A larger request grows it.
+    auto grown {pool.Acquire(2000)};
+    BOOST_CHECK_GE(grown.capacity(), 2000);
+    BOOST_CHECK_EQUAL(pool.GetNAllocations(), 2);
+    BOOST_CHECK_EQUAL(pool.GetNBuffers(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(release_limits)
+{
+    BufferPool pool {2, 4096};
+
+    // Buffers without heap memory are not worth keeping.
+    pool.Release(std::string {});
+    pool.Release(std::string {"short"});
+    BOOST_CHECK_EQUAL(pool.GetNBuffers(), 0);
+
+    // Neither are buffers that are too large.
+    pool.Release(std::string(8192, 'a'));
+    BOOST_CHECK_EQUAL(pool.GetNBuffers(), 0);
+
+    // The pool does not grow beyond its limit.
+    for (size_t idx {0}; idx < 3; ++idx) {
+        pool.Release(std::string(1024, 'a'));
+    }
+    BOOST_CHECK_EQUAL(pool.GetNBuffers(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_BufferPool
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
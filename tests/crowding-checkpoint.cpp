@@ -0,0 +1,92 @@
+#include "crowding-checkpoint.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using NetworkMonitor::ReadCrowdingCheckpoint;
+using NetworkMonitor::WriteCrowdingCheckpoint;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(crowding_checkpoint);
+
+BOOST_AUTO_TEST_CASE(write_and_read)
+{
+    const auto file {
+        std::filesystem::temp_directory_path() / "crowding-checkpoint.bin"
+    };
+    std::filesystem::remove(file);
+
+    const std::vector<long long int> counts {3, 0, -2, 1234567890123};
+    BOOST_REQUIRE(WriteCrowdingCheckpoint(file, 42, counts));
+    BOOST_CHECK(std::filesystem::exists(file));
+
+    std::vector<long long int> loaded {};
+    BOOST_REQUIRE(ReadCrowdingCheckpoint(file, 42, loaded));
+    BOOST_CHECK(loaded == counts);
+
+    // Overwrite an existing checkpoint.
+    const std::vector<long long int> newCounts {1, 2};
+    BOOST_REQUIRE(WriteCrowdingCheckpoint(file, 42, newCounts));
+    BOOST_REQUIRE(ReadCrowdingCheckpoint(file, 42, loaded));
+    BOOST_CHECK(loaded == newCounts);
+
+    std::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE(layout_mismatch)
+{
+    const auto file {
+        std::filesystem::temp_directory_path() / "crowding-checkpoint.bin"
+    };
+    const std::vector<long long int> counts {3, 0, -2};
+    BOOST_REQUIRE(WriteCrowdingCheckpoint(file, 42, counts));
+
+    std::vector<long long int> loaded {7};
+    BOOST_CHECK(!ReadCrowdingCheckpoint(file, 43, loaded));
+    BOOST_CHECK(loaded == std::vector<long long int> {7});
+
+    std::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE(corrupted_file)
+{
+    const auto file {
+        std::filesystem::temp_directory_path() / "crowding-checkpoint.bin"
+    };
+    const std::vector<long long int> counts {3, 0, -2};
+    BOOST_REQUIRE(WriteCrowdingCheckpoint(file, 42, counts));
+
+    // Flip a byte in the last passenger count.
+    {
+        std::fstream stream {file,
+                             std::ios::binary | std::ios::in | std::ios::out};
+        stream.seekp(-1, std::ios::end);
+        stream.put('\x55');
+    }
+    std::vector<long long int> loaded {};
+    BOOST_CHECK(!ReadCrowdingCheckpoint(file, 42, loaded));
+
+    // Truncated file.
+    std::filesystem::resize_file(file, 10);
+    BOOST_CHECK(!ReadCrowdingCheckpoint(file, 42, loaded));
+
+    std::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE(missing_file)
+{
+    std::vector<long long int> loaded {};
+    BOOST_CHECK(!ReadCrowdingCheckpoint(
+        std::filesystem::temp_directory_path() / "crowding-checkpoint-none.bin",
+        42,
+        loaded
+    ));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // crowding_checkpoint
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -0,0 +1,172 @@
+#include "crowding-time-series.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using NetworkMonitor::CrowdingSample;
+using NetworkMonitor::CrowdingTimeSeries;
+using NetworkMonitor::kInvalidStationHandle;
+using NetworkMonitor::StationHandle;
+
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_CrowdingTimeSeries);
+
+static constexpr std::int64_t kMinuteUs {60'000'000};
+
+BOOST_AUTO_TEST_CASE(record_and_range)
+{
+    CrowdingTimeSeries store {2, 1min, 24h};
+
+    // Events in the same minute overwrite each other.
+    BOOST_CHECK(store.Record(0, 0 * kMinuteUs + 10, 1));
+    BOOST_CHECK(store.Record(0, 0 * kMinuteUs + 20, 2));
+    BOOST_CHECK(store.Record(0, 1 * kMinuteUs + 5, 3));
+    BOOST_CHECK(store.Record(0, 3 * kMinuteUs, 1));
+    BOOST_CHECK(store.Record(0, 4 * kMinuteUs + 1, -2));
+
+    // Late events are folded into the latest interval.
+    BOOST_CHECK(store.Record(0, 2 * kMinuteUs, 0));
+
+    // Out-of-range station handle.
+    BOOST_CHECK(!store.Record(2, 0, 1));
+
+    std::vector<CrowdingSample> expected {
+        {0 * kMinuteUs, 2},
+        {1 * kMinuteUs, 3},
+        {3 * kMinuteUs, 1},
+        {4 * kMinuteUs, 0},
+    };
+    auto samples {store.GetRange(0, 0, 10 * kMinuteUs)};
+    BOOST_CHECK(samples == expected);
+
+    samples = store.GetRange(0, 1 * kMinuteUs, 3 * kMinuteUs);
+    BOOST_CHECK(samples == std::vector<CrowdingSample>(expected.begin() + 1,
+                                                       expected.begin() + 3));
+
+    BOOST_CHECK(store.GetRange(1, 0, 10 * kMinuteUs).empty());
+    BOOST_CHECK(store.GetRange(2, 0, 10 * kMinuteUs).empty());
+}
+
+BOOST_AUTO_TEST_CASE(many_blocks)
+{
+    CrowdingTimeSeries store {1, 1min, 72h};
+
+    // Two days of samples with irregular gaps and values span multiple
+    // blocks.
+    std::vector<CrowdingSample> expected {};
+    std::int64_t timestampUs {0};
+    long long int passengerCount {0};
+    for (size_t idx {0}; idx < 1440; ++idx) {
+        timestampUs += kMinuteUs * (1 + idx % 3);
+        passengerCount += (idx % 7 == 0) ? -50 : 3;
+        BOOST_REQUIRE(store.Record(0, timestampUs, passengerCount));
+        expected.push_back({timestampUs, passengerCount});
+    }
+    auto samples {store.GetRange(0, 0, timestampUs)};
+    BOOST_CHECK_EQUAL(samples.size(), expected.size());
+    BOOST_CHECK(samples == expected);
+
+    // The compressed history is much smaller than the raw samples.
+    BOOST_CHECK_LT(store.GetMemoryUsage(0),
+                   expected.size() * sizeof(CrowdingSample) / 2);
+}
+
+BOOST_AUTO_TEST_CASE(retention)
+{
+    CrowdingTimeSeries store {1, 1min, 1h};
+    for (std::int64_t minute {0}; minute < 6 * 60; ++minute) {
+        store.Record(0, minute * kMinuteUs, minute);
+    }
+    auto samples {store.GetRange(0, 0, 6 * 60 * kMinuteUs)};
+    BOOST_REQUIRE(!samples.empty());
+    BOOST_CHECK_EQUAL(samples.back().passengerCount, 6 * 60 - 1);
+
+    // Whole blocks are dropped, so we may keep a bit more than the retention
+    // window, but not the full history.
+    BOOST_CHECK_LT(samples.size(), 3 * 60);
+    BOOST_CHECK_GE(samples.size(), 60);
+}
+
+BOOST_AUTO_TEST_CASE(downsampled)
+{
+    CrowdingTimeSeries store {1, 1min, 24h};
+    store.Record(0, 2 * kMinuteUs, 5);
+    store.Record(0, 3 * kMinuteUs, 6);
+    store.Record(0, 7 * kMinuteUs, 2);
+
+    std::vector<CrowdingSample> expected {
+        {2 * kMinuteUs, 5},
+        {4 * kMinuteUs, 6},
+        {6 * kMinuteUs, 6},
+        {8 * kMinuteUs, 2},
+        {10 * kMinuteUs, 2},
+    };
+    auto samples {store.GetDownsampled(0, 0, 10 * kMinuteUs, 2 * kMinuteUs)};
+    BOOST_CHECK(samples == expected);
+
+    BOOST_CHECK(store.GetDownsampled(0, 0, 10 * kMinuteUs, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(network_load_at)
+{
+    const size_t nStations {100};
+    CrowdingTimeSeries store {nStations, 1min, 24h};
+    for (size_t station {0}; station < nStations; ++station) {
+        for (std::int64_t minute {0}; minute < 100; ++minute) {
+            if (minute >= static_cast<std::int64_t>(station)) {
+                store.Record(station, minute * kMinuteUs, station + minute);
+            }
+        }
+    }
+    for (size_t nThreads: {1, 4}) {
+        auto load {store.GetNetworkLoadAt(50 * kMinuteUs, nThreads)};
+        BOOST_REQUIRE_EQUAL(load.size(), nStations);
+        for (size_t station {0}; station < nStations; ++station) {
+            const long long int expected {
+                station <= 50 ? static_cast<long long int>(station) + 50 : 0
+            };
+            BOOST_CHECK_EQUAL(load[station], expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(remap)
+{
+    CrowdingTimeSeries store {3, 1min, 24h};
+    for (std::int64_t minute {0}; minute < 3; ++minute) {
+        store.Record(0, minute * kMinuteUs, 10 + minute);
+        store.Record(1, minute * kMinuteUs, 20 + minute);
+        store.Record(2, minute * kMinuteUs, 30 + minute);
+    }
+
+    // Station 0 moves to handle 2, station 1 is removed, station 2 moves to
+    // handle 0, and a new station takes handle 1.
+    const std::vector<StationHandle> newHandles {2, kInvalidStationHandle, 0};
+    store.Remap(newHandles, 4);
+    BOOST_CHECK_EQUAL(store.GetNStations(), 4);
+    std::vector<CrowdingSample> expected {
+        {0, 10}, {kMinuteUs, 11}, {2 * kMinuteUs, 12},
+    };
+    auto samples {store.GetRange(2, 0, 10 * kMinuteUs)};
+    BOOST_CHECK(samples == expected);
+    samples = store.GetRange(0, 0, 10 * kMinuteUs);
+    BOOST_REQUIRE_EQUAL(samples.size(), 3);
+    BOOST_CHECK_EQUAL(samples.back().passengerCount, 32);
+    BOOST_CHECK(store.GetRange(1, 0, 10 * kMinuteUs).empty());
+    BOOST_CHECK(store.GetRange(3, 0, 10 * kMinuteUs).empty());
+
+    // The remapped stations keep recording.
+    BOOST_CHECK(store.Record(3, 3 * kMinuteUs, 1));
+    BOOST_CHECK(store.Record(2, 3 * kMinuteUs, 13));
+    BOOST_CHECK_EQUAL(store.GetRange(2, 0, 10 * kMinuteUs).size(), 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_CrowdingTimeSeries
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
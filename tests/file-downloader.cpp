@@ -1,15 +1,35 @@
 #include "file-downloader.h"
+#include "https-file-server.h"
+
+#include <network-snapshot.h>
 
 #include <boost/asio.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <string>
 
+using NetworkMonitor::CachedDownload;
 using NetworkMonitor::DownloadFile;
+using NetworkMonitor::DownloadFileCached;
+using NetworkMonitor::HashFile;
+using NetworkMonitor::HttpsFileServer;
 using NetworkMonitor::ParseJsonFile;
 
+// Use this to set a timeout on tests that may hang.
+using timeout = boost::unit_test::timeout;
+
+static std::string ReadFile(
+    const std::filesystem::path& path
+)
+{
+    std::ifstream file {path, std::ios::binary};
+    return {std::istreambuf_iterator<char> {file}, {}};
+}
+
 BOOST_AUTO_TEST_SUITE(network_monitor);
 
 BOOST_AUTO_TEST_CASE(file_downloader)
@@ -47,6 +67,145 @@ BOOST_AUTO_TEST_CASE(file_downloader)
     std::filesystem::remove(destination);
 }
 
+BOOST_AUTO_TEST_CASE(file_downloader_gzip, *timeout {5})
+{
+    HttpsFileServer server {
+        "/network-layout.json",
+        TESTS_NETWORK_LAYOUT_JSON,
+        std::filesystem::path(TEST_DATA) / "network-layout.json.gz",
+    };
+    const auto destination {
+        std::filesystem::temp_directory_path() / "network-layout-gzip.json"
+    };
+
+    // The file is transferred compressed but saved uncompressed.
+    BOOST_REQUIRE(DownloadFile(server.GetUrl(), destination,
+                               server.GetCaCertFile()));
+    BOOST_CHECK_EQUAL(server.nGzipResponses, 1);
+    BOOST_CHECK(ReadFile(destination) == ReadFile(TESTS_NETWORK_LAYOUT_JSON));
+
+    std::filesystem::remove(destination);
+}
+
+BOOST_AUTO_TEST_CASE(file_downloader_untrusted_server, *timeout {5})
+{
+    HttpsFileServer server {
+        "/network-layout.json",
+        TESTS_NETWORK_LAYOUT_JSON,
+    };
+    const auto destination {
+        std::filesystem::temp_directory_path() / "network-layout-gzip.json"
+    };
+
+    // tests/cacert.pem alone does not trust the stand-in server.
+    BOOST_CHECK(!DownloadFile(server.GetUrl(), destination, TESTS_CACERT_PEM));
+    std::filesystem::remove(destination);
+}
+
+BOOST_AUTO_TEST_CASE(cached_download, *timeout {5})
+{
+    HttpsFileServer server {
+        "/network-layout.json",
+        TESTS_NETWORK_LAYOUT_JSON,
+        std::filesystem::path(TEST_DATA) / "network-layout.json.gz",
+    };
+    const auto cacheDirectory {
+        std::filesystem::temp_directory_path() / "file-downloader-cache"
+    };
+    std::filesystem::remove_all(cacheDirectory);
+    std::uint64_t expectedHash {0};
+    BOOST_REQUIRE(HashFile(TESTS_NETWORK_LAYOUT_JSON, expectedHash));
+
+    // The first call downloads the file.
+    CachedDownload download {};
+    BOOST_REQUIRE(DownloadFileCached(server.GetUrl(), cacheDirectory, download,
+                                     server.GetCaCertFile()));
+    BOOST_CHECK(download.downloaded);
+    BOOST_CHECK_EQUAL(download.file, cacheDirectory / "network-layout.json");
+    BOOST_CHECK_EQUAL(download.contentHash, expectedHash);
+    BOOST_CHECK(ReadFile(download.file) ==
+                ReadFile(TESTS_NETWORK_LAYOUT_JSON));
+    BOOST_CHECK_EQUAL(server.nFullResponses, 1);
+    BOOST_CHECK_EQUAL(server.nGzipResponses, 1);
+
+    // The next calls only revalidate the cached copy.
+    for (int idx {0}; idx < 2; ++idx) {
+        CachedDownload revalidated {};
+        BOOST_REQUIRE(DownloadFileCached(server.GetUrl(), cacheDirectory,
+                                         revalidated, server.GetCaCertFile()));
+        BOOST_CHECK(!revalidated.downloaded);
+        BOOST_CHECK_EQUAL(revalidated.file, download.file);
+        BOOST_CHECK_EQUAL(revalidated.contentHash, expectedHash);
+    }
+    BOOST_CHECK_EQUAL(server.nFullResponses, 1);
+    BOOST_CHECK_EQUAL(server.nNotModifiedResponses, 2);
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(cached_download_changed, *timeout {5})
+{
+    HttpsFileServer server {
+        "/network-layout.json",
+        TESTS_NETWORK_LAYOUT_JSON,
+    };
+    const auto cacheDirectory {
+        std::filesystem::temp_directory_path() / "file-downloader-cache"
+    };
+    std::filesystem::remove_all(cacheDirectory);
+    CachedDownload download {};
+    BOOST_REQUIRE(DownloadFileCached(server.GetUrl(), cacheDirectory, download,
+                                     server.GetCaCertFile()));
+
+    // A new version of the file on the server is downloaded again.
+    const auto newFile {
+        std::filesystem::path(TEST_DATA) / "from_json_1line_1route.json"
+    };
+    server.SetFile(newFile);
+    CachedDownload newDownload {};
+    BOOST_REQUIRE(DownloadFileCached(server.GetUrl(), cacheDirectory,
+                                     newDownload, server.GetCaCertFile()));
+    BOOST_CHECK(newDownload.downloaded);
+    BOOST_CHECK_NE(newDownload.contentHash, download.contentHash);
+    BOOST_CHECK(ReadFile(newDownload.file) == ReadFile(newFile));
+    BOOST_CHECK_EQUAL(server.nFullResponses, 2);
+    BOOST_CHECK_EQUAL(server.nNotModifiedResponses, 0);
+
+    // A cached copy without metadata is downloaded again.
+    std::filesystem::remove(cacheDirectory / "network-layout.json.meta");
+    BOOST_REQUIRE(DownloadFileCached(server.GetUrl(), cacheDirectory,
+                                     newDownload, server.GetCaCertFile()));
+    BOOST_CHECK(newDownload.downloaded);
+    BOOST_CHECK_EQUAL(server.nFullResponses, 3);
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(cached_download_fail, *timeout {5})
+{
+    HttpsFileServer server {
+        "/network-layout.json",
+        TESTS_NETWORK_LAYOUT_JSON,
+    };
+    const auto cacheDirectory {
+        std::filesystem::temp_directory_path() / "file-downloader-cache"
+    };
+    std::filesystem::remove_all(cacheDirectory);
+
+    // Unknown file.
+    CachedDownload download {};
+    BOOST_CHECK(!DownloadFileCached(
+        "https://" + server.GetHost() + "/other.json",
+        cacheDirectory,
+        download,
+        server.GetCaCertFile()
+    ));
+    BOOST_CHECK(!std::filesystem::exists(cacheDirectory / "other.json"));
+    BOOST_CHECK(!std::filesystem::exists(cacheDirectory / "other.json.tmp"));
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
 BOOST_AUTO_TEST_CASE(parse_file)
 {
     // Parse the file.
@@ -0,0 +1,252 @@
+#include "https-file-server.h"
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+using NetworkMonitor::HttpsFileServer;
+
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+// Static functions
+
+static std::string ReadFile(
+    const std::filesystem::path& path
+)
+{
+    std::ifstream file {path, std::ios::binary};
+    return {std::istreambuf_iterator<char> {file}, {}};
+}
+
+static std::string ToPem(
+    BIO* bio
+)
+{
+    char* data {nullptr};
+    const auto size {BIO_get_mem_data(bio, &data)};
+    std::string pem(data, size);
+    BIO_free(bio);
+    return pem;
+}
+
+// Generate a self-signed certificate for 127.0.0.1 and its private key.
+static void GenerateCertificate(
+    std::string& certPem,
+    std::string& keyPem
+)
+{
+    EVP_PKEY* key {nullptr};
+    EVP_PKEY_CTX* keyCtx {EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr)};
+    if (keyCtx == nullptr ||
+        EVP_PKEY_keygen_init(keyCtx) <= 0 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(
+            keyCtx, NID_X9_62_prime256v1
+        ) <= 0 ||
+        EVP_PKEY_keygen(keyCtx, &key) <= 0) {
+        EVP_PKEY_CTX_free(keyCtx);
+        throw std::runtime_error("Could not generate the server key");
+    }
+    EVP_PKEY_CTX_free(keyCtx);
+
+    X509* cert {X509_new()};
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name {X509_get_subject_name(cert)};
+    X509_NAME_add_entry_by_txt(
+        name, "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0
+    );
+    X509_set_issuer_name(cert, name);
+    X509_EXTENSION* altName {X509V3_EXT_conf_nid(
+        nullptr, nullptr, NID_subject_alt_name, "IP:127.0.0.1"
+    )};
+    X509_add_ext(cert, altName, -1);
+    X509_EXTENSION_free(altName);
+    X509_sign(cert, key, EVP_sha256());
+
+    BIO* certBio {BIO_new(BIO_s_mem())};
+    PEM_write_bio_X509(certBio, cert);
+    certPem = ToPem(certBio);
+    BIO* keyBio {BIO_new(BIO_s_mem())};
+    PEM_write_bio_PrivateKey(keyBio, key, nullptr, nullptr, 0, nullptr,
+                             nullptr);
+    keyPem = ToPem(keyBio);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+// HttpsFileServer — Public methods
+
+HttpsFileServer::HttpsFileServer(
+    const std::string& target,
+    const std::filesystem::path& file,
+    const std::filesystem::path& gzipFile
+) : target_ {target}
+{
+    SetFile(file, gzipFile);
+
+    std::string certPem {};
+    std::string keyPem {};
+    GenerateCertificate(certPem, keyPem);
+    ctx_.use_certificate_chain(boost::asio::buffer(certPem));
+    ctx_.use_private_key(boost::asio::buffer(keyPem),
+                         boost::asio::ssl::context::file_format::pem);
+
+    // The clients trust the usual CAs and our certificate.
+    caCertFile_ = std::filesystem::temp_directory_path() /
+                  "https-file-server-cacert.pem";
+    {
+        std::ofstream caCert {caCertFile_, std::ios::binary};
+        caCert << ReadFile(TESTS_CACERT_PEM) << "\n" << certPem;
+    }
+
+    tcp::endpoint endpoint {boost::asio::ip::make_address("127.0.0.1"), 0};
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(tcp::acceptor::reuse_address(true));
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+    thread_ = std::thread {[this]() {
+        Serve();
+    }};
+}
+
+HttpsFileServer::~HttpsFileServer()
+{
+    // Wake the blocking accept up with a dummy connection.
+    stopping_ = true;
+    boost::system::error_code ec {};
+    tcp::socket socket {ioc_};
+    socket.connect(acceptor_.local_endpoint(), ec);
+    thread_.join();
+    std::error_code fileEc {};
+    std::filesystem::remove(caCertFile_, fileEc);
+}
+
+std::string HttpsFileServer::GetUrl() const
+{
+    return "https://" + GetHost() + target_;
+}
+
+std::string HttpsFileServer::GetHost() const
+{
+    return "127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port());
+}
+
+std::filesystem::path HttpsFileServer::GetCaCertFile() const
+{
+    return caCertFile_;
+}
+
+void HttpsFileServer::SetFile(
+    const std::filesystem::path& file,
+    const std::filesystem::path& gzipFile
+)
+{
+    std::lock_guard<std::mutex> lock {fileMutex_};
+    body_ = ReadFile(file);
+    gzipBody_ = gzipFile.empty() ? "" : ReadFile(gzipFile);
+    ++version_;
+    etag_ = "\"v" + std::to_string(version_) + "\"";
+}
+
+// HttpsFileServer — Private methods
+
+void HttpsFileServer::Serve()
+{
+    while (true) {
+        tcp::socket socket {ioc_};
+        boost::system::error_code ec {};
+        acceptor_.accept(socket, ec);
+        if (stopping_) {
+            return;
+        }
+        if (!ec) {
+            HandleConnection(std::move(socket));
+        }
+    }
+}
+
+void HttpsFileServer::HandleConnection(
+    tcp::socket socket
+)
+{
+    boost::system::error_code ec {};
+    boost::beast::ssl_stream<tcp::socket> stream {std::move(socket), ctx_};
+    stream.handshake(boost::asio::ssl::stream_base::server, ec);
+    if (ec) {
+        return;
+    }
+    boost::beast::flat_buffer buffer {};
+    http::request<http::string_body> req {};
+    http::read(stream, buffer, req, ec);
+    if (ec) {
+        return;
+    }
+
+    http::response<http::string_body> res {};
+    res.version(req.version());
+    res.keep_alive(false);
+    {
+        std::lock_guard<std::mutex> lock {fileMutex_};
+        char lastModified[64] {};
+        std::snprintf(lastModified, sizeof(lastModified),
+                      "Wed, 21 Oct 2015 07:%02zu:00 GMT", version_ % 60);
+
+        // If-None-Match takes precedence over If-Modified-Since.
+        const auto ifNoneMatch {req.find(http::field::if_none_match)};
+        const auto ifModifiedSince {req.find(http::field::if_modified_since)};
+        const bool notModified {ifNoneMatch != req.end() ?
+            ifNoneMatch->value() == etag_ :
+            ifModifiedSince != req.end() &&
+            ifModifiedSince->value() == lastModified
+        };
+        const auto acceptEncoding {req.find(http::field::accept_encoding)};
+        const bool gzip {
+            !gzipBody_.empty() &&
+            acceptEncoding != req.end() &&
+            acceptEncoding->value().find("gzip") != std::string::npos
+        };
+        if (req.target() != target_) {
+            res.result(http::status::not_found);
+        } else if (notModified) {
+            res.result(http::status::not_modified);
+            ++nNotModifiedResponses;
+        } else {
+            res.result(http::status::ok);
+            res.set(http::field::content_type, "application/json");
+            if (gzip) {
+                res.set(http::field::content_encoding, "gzip");
+                res.body() = gzipBody_;
+                ++nGzipResponses;
+            } else {
+                res.body() = body_;
+            }
+            ++nFullResponses;
+        }
+        res.set(http::field::etag, etag_);
+        res.set(http::field::last_modified, lastModified);
+    }
+    res.prepare_payload();
+    http::write(stream, res, ec);
+    stream.shutdown(ec);
+}
@@ -0,0 +1,97 @@
+#ifndef NETWORK_MONITOR_TESTS_HTTPS_FILE_SERVER_H
+#define NETWORK_MONITOR_TESTS_HTTPS_FILE_SERVER_H
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace NetworkMonitor {
+
+/*! \brief Local HTTPS stand-in for the server that hosts a file.
+ *
+ *  The server listens on 127.0.0.1, on a port picked by the OS, and serves a
+ *  single file. It supports the conditional requests (`If-None-Match` and
+ *  `If-Modified-Since`) and the gzip content encoding.
+ *
+ *  The server uses a self-signed certificate for 127.0.0.1, generated on
+ *  construction. Clients must verify it with the CA bundle returned by
+ *  `GetCaCertFile`: tests/cacert.pem plus that certificate.
+ *
+ *  \note This should be used for testing purposes only.
+ */
+class HttpsFileServer {
+public:
+    /*! \brief Start serving a file.
+     *
+     *  \param target   The request target of the file, e.g. `/file.json`.
+     *  \param file     The file content.
+     *  \param gzipFile The gzip-compressed file content. If empty, the file is
+     *                  always served uncompressed.
+     */
+    HttpsFileServer(
+        const std::string& target,
+        const std::filesystem::path& file,
+        const std::filesystem::path& gzipFile = {}
+    );
+
+    /*! \brief Stop the server.
+     */
+    ~HttpsFileServer();
+
+    /*! \brief Get the URL of the file.
+     */
+    std::string GetUrl() const;
+
+    /*! \brief Get the `host:port` the server listens on.
+     */
+    std::string GetHost() const;
+
+    /*! \brief Get the CA bundle to verify the server certificate with.
+     */
+    std::filesystem::path GetCaCertFile() const;
+
+    /*! \brief Serve a new version of the file, with a new ETag.
+     */
+    void SetFile(
+        const std::filesystem::path& file,
+        const std::filesystem::path& gzipFile = {}
+    );
+
+    // Request counters.
+    std::atomic<size_t> nFullResponses {0};
+    std::atomic<size_t> nGzipResponses {0};
+    std::atomic<size_t> nNotModifiedResponses {0};
+
+private:
+    std::string target_ {};
+    std::filesystem::path caCertFile_ {};
+
+    std::mutex fileMutex_ {};
+    std::string body_ {};
+    std::string gzipBody_ {};
+    std::string etag_ {};
+    size_t version_ {0};
+
+    boost::asio::io_context ioc_ {};
+    boost::asio::ssl::context ctx_ {
+        boost::asio::ssl::context::tlsv12_server
+    };
+    boost::asio::ip::tcp::acceptor acceptor_ {ioc_};
+    std::atomic<bool> stopping_ {false};
+    std::thread thread_ {};
+
+    void Serve();
+
+    void HandleConnection(
+        boost::asio::ip::tcp::socket socket
+    );
+};
+
+} // namespace NetworkMonitor
+
+#endif // NETWORK_MONITOR_TESTS_HTTPS_FILE_SERVER_H
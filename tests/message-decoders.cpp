@@ -0,0 +1,300 @@
+#include "message-decoders.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using NetworkMonitor::DecodePassengerEventMessage;
+using NetworkMonitor::DecodeQuietRouteRequestMessage;
+using NetworkMonitor::Id;
+using NetworkMonitor::kInvalidStationHandle;
+using NetworkMonitor::ParseIso8601Timestamp;
+using NetworkMonitor::ParsePassengerEvent;
+using NetworkMonitor::ParseQuietRouteRequest;
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerEventMessage;
+using NetworkMonitor::PassengerEventRecord;
+using NetworkMonitor::QuietRouteRequestMessage;
+using NetworkMonitor::TransportNetwork;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(message_decoders);
+
+BOOST_AUTO_TEST_SUITE(passenger_event);
+
+BOOST_AUTO_TEST_CASE(decode)
+{
+    const std::string message {
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"out\",\"station_id\":\"station_227\"}"
+    };
+    PassengerEventMessage event {};
+    BOOST_REQUIRE(DecodePassengerEventMessage(message, event));
+    BOOST_CHECK_EQUAL(event.stationId, "station_227");
+    BOOST_CHECK(event.type == PassengerEvent::Type::Out);
+    BOOST_CHECK_EQUAL(event.datetime, "2021-01-03T22:08:08.813000Z");
+
+    // The decoded fields point into the original buffer.
+    BOOST_CHECK(event.stationId.data() >= message.data());
+    BOOST_CHECK(event.stationId.data() < message.data() + message.size());
+}
+
+BOOST_AUTO_TEST_CASE(decode_whitespace_and_extra_keys)
+{
+    const std::string message {
+        "  {\n  \"station_id\" : \"station_0\",\n"
+        "  \"note\": \"ignored\",\n"
+        "  \"passenger_event\": \"in\" ,\n"
+        "  \"datetime\": \"2020-11-01T07:18:50.234000Z\"\n}\n"
+    };
+    PassengerEventMessage event {};
+    BOOST_REQUIRE(DecodePassengerEventMessage(message, event));
+    BOOST_CHECK_EQUAL(event.stationId, "station_0");
+    BOOST_CHECK(event.type == PassengerEvent::Type::In);
+}
+
+BOOST_AUTO_TEST_CASE(decode_unsupported_shape)
+{
+    PassengerEventMessage event {};
+
+    // Escape sequences, non-string values and missing fields are left to the
+    // fallback parser.
+    BOOST_CHECK(!DecodePassengerEventMessage(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"out\",\"station_id\":\"station\\u005f227\"}",
+        event
+    ));
+    BOOST_CHECK(!DecodePassengerEventMessage(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"out\",\"station_id\":\"station_227\","
+        "\"count\":1}",
+        event
+    ));
+    BOOST_CHECK(!DecodePassengerEventMessage(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"out\"}",
+        event
+    ));
+    BOOST_CHECK(!DecodePassengerEventMessage(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"out\",\"station_id\":\"station_227\"",
+        event
+    ));
+    BOOST_CHECK(!DecodePassengerEventMessage("", event));
+}
+
+BOOST_AUTO_TEST_CASE(parse)
+{
+    PassengerEvent event {};
+    BOOST_REQUIRE(ParsePassengerEvent(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"out\",\"station_id\":\"station_227\"}",
+        event
+    ));
+    BOOST_CHECK_EQUAL(event.stationId, "station_227");
+    BOOST_CHECK(event.type == PassengerEvent::Type::Out);
+    BOOST_CHECK_EQUAL(
+        boost::posix_time::to_iso_extended_string(event.timestamp),
+        "2021-01-03T22:08:08.813000"
+    );
+
+    // Fallback.
+    BOOST_REQUIRE(ParsePassengerEvent(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"in\",\"station_id\":\"station\\u005f227\","
+        "\"count\":1}",
+        event
+    ));
+    BOOST_CHECK_EQUAL(event.stationId, "station_227");
+    BOOST_CHECK(event.type == PassengerEvent::Type::In);
+
+    // Invalid messages.
+    BOOST_CHECK(!ParsePassengerEvent("{\"station_id\":\"station_227\"}", event));
+    BOOST_CHECK(!ParsePassengerEvent("{\"datetime\":\"bad\","
+                                     "\"passenger_event\":\"in\","
+                                     "\"station_id\":\"station_227\"}",
+                                     event));
+    BOOST_CHECK(!ParsePassengerEvent("not json", event));
+}
+
+BOOST_AUTO_TEST_CASE(parse_same_as_json, *boost::unit_test::timeout {10})
+{
+    // The fast path must give the same result as the JSON parser for all the
+    // events in the test file.
+    std::ifstream file {
+        std::filesystem::path(TEST_DATA) / "passenger_events.json"
+    };
+    const auto events = nlohmann::json::parse(file);
+    BOOST_REQUIRE(!events.empty());
+    for (const auto& eventJson: events) {
+        PassengerEvent expected = eventJson;
+        PassengerEvent event {};
+        BOOST_REQUIRE(ParsePassengerEvent(eventJson.dump(), event));
+        BOOST_CHECK_EQUAL(event.stationId, expected.stationId);
+        BOOST_CHECK(event.type == expected.type);
+        BOOST_CHECK(event.timestamp == expected.timestamp);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parse_record)
+{
+    TransportNetwork nw {};
+    BOOST_REQUIRE(nw.AddStation({"station_0", "Station Name 0"}));
+    BOOST_REQUIRE(nw.AddStation({"station_1", "Station Name 1"}));
+
+    PassengerEventRecord event {};
+    BOOST_REQUIRE(ParsePassengerEvent(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"out\",\"station_id\":\"station_1\"}",
+        nw,
+        event
+    ));
+    BOOST_CHECK_EQUAL(event.station, 1);
+    BOOST_CHECK(event.type == PassengerEvent::Type::Out);
+    BOOST_CHECK_EQUAL(event.timestampUs, 1609711688813000);
+
+    // Fallback.
+    BOOST_REQUIRE(ParsePassengerEvent(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"in\",\"station_id\":\"station\\u005f0\","
+        "\"count\":1}",
+        nw,
+        event
+    ));
+    BOOST_CHECK_EQUAL(event.station, 0);
+    BOOST_CHECK(event.type == PassengerEvent::Type::In);
+    BOOST_CHECK_EQUAL(event.timestampUs, 1609711688813000);
+
+    // Unknown stations are parsed, but have no valid handle.
+    BOOST_REQUIRE(ParsePassengerEvent(
+        "{\"datetime\":\"2021-01-03T22:08:08.813000Z\","
+        "\"passenger_event\":\"in\",\"station_id\":\"station_42\"}",
+        nw,
+        event
+    ));
+    BOOST_CHECK_EQUAL(event.station, kInvalidStationHandle);
+
+    BOOST_CHECK(!ParsePassengerEvent("not json", nw, event));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // passenger_event
+
+BOOST_AUTO_TEST_SUITE(iso8601_timestamp);
+
+BOOST_AUTO_TEST_CASE(fixed_layout)
+{
+    std::int64_t timestampUs {0};
+    BOOST_REQUIRE(ParseIso8601Timestamp("1970-01-01T00:00:00.000000Z",
+                                        timestampUs));
+    BOOST_CHECK_EQUAL(timestampUs, 0);
+    BOOST_REQUIRE(ParseIso8601Timestamp("2020-11-01T07:18:50.234000Z",
+                                        timestampUs));
+    BOOST_CHECK_EQUAL(timestampUs, 1604215130234000);
+    BOOST_REQUIRE(ParseIso8601Timestamp("2024-02-29T23:59:59.999999Z",
+                                        timestampUs));
+    BOOST_CHECK_EQUAL(timestampUs, 1709251199999999);
+    BOOST_REQUIRE(ParseIso8601Timestamp("1969-12-31T23:59:59.000000Z",
+                                        timestampUs));
+    BOOST_CHECK_EQUAL(timestampUs, -1'000'000);
+
+    // Out-of-range fields.
+    BOOST_CHECK(!ParseIso8601Timestamp("2023-02-29T00:00:00.000000Z",
+                                       timestampUs));
+    BOOST_CHECK(!ParseIso8601Timestamp("2023-13-01T00:00:00.000000Z",
+                                       timestampUs));
+    BOOST_CHECK(!ParseIso8601Timestamp("2023-01-01T24:00:00.000000Z",
+                                       timestampUs));
+}
+
+BOOST_AUTO_TEST_CASE(same_as_boost)
+{
+    // Every timestamp in the test file takes the fast path and matches the
+    // generic parser.
+    std::ifstream file {
+        std::filesystem::path(TEST_DATA) / "passenger_events.json"
+    };
+    const auto events = nlohmann::json::parse(file);
+    const boost::posix_time::ptime epoch {boost::gregorian::date(1970, 1, 1)};
+    for (const auto& eventJson: events) {
+        PassengerEvent expected = eventJson;
+        std::int64_t timestampUs {0};
+        BOOST_REQUIRE(ParseIso8601Timestamp(
+            eventJson.at("datetime").get<std::string>(),
+            timestampUs
+        ));
+        BOOST_CHECK_EQUAL(timestampUs,
+                          (expected.timestamp - epoch).total_microseconds());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fallback)
+{
+    // Other layouts go through the generic parser.
+    std::int64_t timestampUs {0};
+    BOOST_REQUIRE(ParseIso8601Timestamp("2020-11-01T07:18:50.234Z",
+                                        timestampUs));
+    BOOST_CHECK_EQUAL(timestampUs, 1604215130234000);
+    BOOST_REQUIRE(ParseIso8601Timestamp("2020-11-01T07:18:50Z", timestampUs));
+    BOOST_CHECK_EQUAL(timestampUs, 1604215130000000);
+
+    BOOST_CHECK(!ParseIso8601Timestamp("", timestampUs));
+    BOOST_CHECK(!ParseIso8601Timestamp("yesterday", timestampUs));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // iso8601_timestamp
+
+BOOST_AUTO_TEST_SUITE(quiet_route_request);
+
+BOOST_AUTO_TEST_CASE(decode)
+{
+    QuietRouteRequestMessage request {};
+    BOOST_REQUIRE(DecodeQuietRouteRequestMessage(
+        "{\"start_station_id\":\"station_0\",\"end_station_id\":\"station_1\"}",
+        request
+    ));
+    BOOST_CHECK_EQUAL(request.startStationId, "station_0");
+    BOOST_CHECK_EQUAL(request.endStationId, "station_1");
+
+    BOOST_CHECK(!DecodeQuietRouteRequestMessage(
+        "{\"start_station_id\":\"station_0\"}",
+        request
+    ));
+}
+
+BOOST_AUTO_TEST_CASE(parse)
+{
+    Id start {};
+    Id end {};
+    BOOST_REQUIRE(ParseQuietRouteRequest(
+        "{\"start_station_id\":\"station_0\",\"end_station_id\":\"station_1\"}",
+        start,
+        end
+    ));
+    BOOST_CHECK_EQUAL(start, "station_0");
+    BOOST_CHECK_EQUAL(end, "station_1");
+
+    // Fallback.
+    BOOST_REQUIRE(ParseQuietRouteRequest(
+        "{\"start_station_id\":\"station_2\",\"end_station_id\":\"station_3\","
+        "\"options\":{}}",
+        start,
+        end
+    ));
+    BOOST_CHECK_EQUAL(start, "station_2");
+    BOOST_CHECK_EQUAL(end, "station_3");
+
+    BOOST_CHECK(!ParseQuietRouteRequest("{}", start, end));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // quiet_route_request
+
+BOOST_AUTO_TEST_SUITE_END(); // message_decoders
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -1,3 +1,4 @@
+#include "https-file-server.h"
 #include "websocket-client-mock.h"
 #include "websocket-server-mock.h"
 
@@ -13,19 +14,25 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <exception>
 #include <filesystem>
+#include <fstream>
+#include <limits>
 #include <string>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
+using NetworkMonitor::BackpressurePolicy;
 using NetworkMonitor::BoostWebSocketClient;
 using NetworkMonitor::BoostWebSocketServer;
 using NetworkMonitor::GetEnvVar;
 using NetworkMonitor::GetMockSendFrame;
 using NetworkMonitor::GetMockStompFrame;
+using NetworkMonitor::HttpsFileServer;
 using NetworkMonitor::Id;
 using NetworkMonitor::MockWebSocketClientForStomp;
 using NetworkMonitor::MockWebSocketEvent;
@@ -33,9 +40,13 @@ using NetworkMonitor::MockWebSocketServerForStomp;
 using NetworkMonitor::NetworkMonitorConfig;
 using NetworkMonitor::NetworkMonitorError;
 using NetworkMonitor::ParseJsonFile;
+using NetworkMonitor::ReadCrowdingCheckpoint;
 using NetworkMonitor::StompClient;
 using NetworkMonitor::StompClientError;
+using NetworkMonitor::TransportNetwork;
 using NetworkMonitor::TravelRoute;
+using NetworkMonitor::WriteCrowdingCheckpoint;
+using NetworkMonitor::WriteNetworkSnapshot;
 
 // Use this to set a timeout on tests that may hang or suffer from a slow
 // connection.
@@ -60,6 +71,26 @@ struct NetworkMonitorTestFixture {
     }
 };
 
+// Write a copy of the from_json_2lines_2routes.json layout with an extra
+// station, in which the stations are listed in reverse order. All the station
+// handles change.
+static void WriteReorderedNetworkLayout(
+    const std::filesystem::path& file
+)
+{
+    auto layout = ParseJsonFile(
+        std::filesystem::path(TEST_DATA) / "from_json_2lines_2routes.json"
+    );
+    nlohmann::json newStation {};
+    newStation["station_id"] = "station_2";
+    newStation["name"] = "Station 2 Name";
+    auto& stations {layout.at("stations")};
+    stations.push_back(newStation);
+    std::reverse(stations.begin(), stations.end());
+    std::ofstream out {file};
+    out << layout.dump();
+}
+
 BOOST_AUTO_TEST_SUITE(network_monitor);
 
 BOOST_AUTO_TEST_SUITE(network_monitor);
@@ -74,6 +105,8 @@ BOOST_AUTO_TEST_CASE(ostream)
     for (const auto& error: {
         NetworkMonitorError::kOk,
         NetworkMonitorError::kCouldNotConnectToStompClient,
+        NetworkMonitorError::kCouldNotOpenPassengerEventJournal,
+        NetworkMonitorError::kCouldNotParseCrowdedStationsRequest,
         NetworkMonitorError::kCouldNotParsePassengerEvent,
         NetworkMonitorError::kCouldNotParseQuietRouteRequest,
         NetworkMonitorError::kCouldNotRecordPassengerEvent,
@@ -92,6 +125,18 @@ BOOST_AUTO_TEST_CASE(ostream)
     }
 }
 
+BOOST_AUTO_TEST_CASE(formatter)
+{
+    BOOST_CHECK_EQUAL(
+        fmt::format("{}", NetworkMonitorError::kStompServerDisconnected),
+        "StompServerDisconnected"
+    );
+    BOOST_CHECK_EQUAL(
+        fmt::format("{}", static_cast<NetworkMonitorError>(1000)),
+        "UndefinedError"
+    );
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // enum_class_NetworkMonitorError
 
 BOOST_FIXTURE_TEST_SUITE(class_NetworkMonitor, NetworkMonitorTestFixture);
@@ -116,6 +161,191 @@ BOOST_AUTO_TEST_CASE(ok)
     BOOST_CHECK_EQUAL(ec, NetworkMonitorError::kOk);
 }
 
+BOOST_AUTO_TEST_CASE(ok_network_snapshot)
+{
+    const auto snapshotFile {
+        std::filesystem::temp_directory_path() / "network-layout.bin"
+    };
+    TransportNetwork network {};
+    BOOST_REQUIRE(network.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON)));
+    BOOST_REQUIRE(WriteNetworkSnapshot(snapshotFile, network, 0));
+
+    NetworkMonitorConfig config {
+        "metronetwork.tech",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        snapshotFile,
+    };
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_CHECK_EQUAL(ec, NetworkMonitorError::kOk);
+    BOOST_CHECK_EQUAL(monitor.GetNetworkRepresentation().GetNStations(),
+                      network.GetNStations());
+
+    std::filesystem::remove(snapshotFile);
+}
+
+BOOST_AUTO_TEST_CASE(ok_network_layout_cache, *timeout {5})
+{
+    HttpsFileServer server {
+        "/network-layout.json",
+        TESTS_NETWORK_LAYOUT_JSON,
+        std::filesystem::path(TEST_DATA) / "network-layout.json.gz",
+    };
+    const auto cacheDirectory {
+        std::filesystem::temp_directory_path() / "network-layout-cache"
+    };
+    std::filesystem::remove_all(cacheDirectory);
+    NetworkMonitorConfig config {
+        server.GetHost(),
+        "443",
+        "some_username",
+        "some_password_123",
+        server.GetCaCertFile(),
+        "", // Empty network layout file path. Will download
+    };
+    config.networkLayoutCacheDirectory = cacheDirectory;
+
+    // The first start downloads the layout and builds the snapshot.
+    size_t nStations {0};
+    {
+        NetworkMonitor::NetworkMonitor<
+            MockWebSocketClientForStomp,
+            MockWebSocketServerForStomp
+        > monitor {};
+        auto ec {monitor.Configure(config)};
+        BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+        nStations = monitor.GetNetworkRepresentation().GetNStations();
+    }
+    BOOST_CHECK_EQUAL(server.nFullResponses, 1);
+    BOOST_CHECK(std::filesystem::exists(
+        cacheDirectory / "network-layout.snapshot"
+    ));
+
+    // On restart, the layout is not downloaded again, nor parsed: We break
+    // the cached layout file to prove it.
+    {
+        std::ofstream file {cacheDirectory / "network-layout.json",
+                            std::ios::binary | std::ios::in};
+        file << "{{{{";
+    }
+    {
+        NetworkMonitor::NetworkMonitor<
+            MockWebSocketClientForStomp,
+            MockWebSocketServerForStomp
+        > monitor {};
+        auto ec {monitor.Configure(config)};
+        BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+        BOOST_CHECK_EQUAL(monitor.GetNetworkRepresentation().GetNStations(),
+                          nStations);
+    }
+    BOOST_CHECK_EQUAL(server.nFullResponses, 1);
+    BOOST_CHECK_EQUAL(server.nNotModifiedResponses, 1);
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(ok_network_layout_async_fetch, *timeout {5})
+{
+    HttpsFileServer server {
+        "/network-layout.json",
+        std::filesystem::path(TEST_DATA) / "from_json_1line_1route.json",
+    };
+    NetworkMonitorConfig config {
+        server.GetHost(),
+        "443",
+        "some_username",
+        "some_password_123",
+        server.GetCaCertFile(),
+        "", // Empty network layout file path. Will download
+    };
+    config.networkLayoutAsyncFetch = true;
+
+    // Setup the mock. The passenger event and the crowded-stations request
+    // wait for the network.
+    nlohmann::json event {
+        {"datetime", "2020-11-01T07:18:50.234000Z"},
+        {"passenger_event", "in"},
+        {"station_id", "station_0"},
+    };
+    MockWebSocketClientForStomp::subscriptionMessages = {
+        event.dump(),
+    };
+    MockWebSocketServerForStomp::mockEvents = std::queue<MockWebSocketEvent> {{
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kConnect,
+            // Succeeds
+        },
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kMessage,
+            {}, // Succeeds
+            GetMockStompFrame("localhost")
+        },
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kMessage,
+            {}, // Succeeds
+            GetMockSendFrame("req0", "/crowded-stations", "{}")
+        },
+    }};
+
+    // Configure returns before the network is loaded.
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+    BOOST_CHECK_EQUAL(monitor.GetNetworkRepresentation().GetNStations(), 0);
+    monitor.Run(std::chrono::milliseconds(500));
+
+    BOOST_CHECK_EQUAL(monitor.GetLastErrorCode(), NetworkMonitorError::kOk);
+    BOOST_CHECK_EQUAL(monitor.GetNetworkRepresentation().GetNStations(), 2);
+    BOOST_CHECK_EQUAL(
+        monitor.GetNetworkRepresentation().GetPassengerCount("station_0"),
+        1
+    );
+    BOOST_CHECK_EQUAL(monitor.GetLastCrowdedStations().size(), 2);
+    BOOST_CHECK_EQUAL(server.nFullResponses, 1);
+}
+
+BOOST_AUTO_TEST_CASE(network_layout_async_fetch_fail, *timeout {5})
+{
+    HttpsFileServer server {
+        "/other.json", // The layout file is not there
+        std::filesystem::path(TEST_DATA) / "from_json_1line_1route.json",
+    };
+    NetworkMonitorConfig config {
+        server.GetHost(),
+        "443",
+        "some_username",
+        "some_password_123",
+        server.GetCaCertFile(),
+        "", // Empty network layout file path. Will try to download
+    };
+    config.networkLayoutAsyncFetch = true;
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+
+    // The I/O context stops as soon as the download fails.
+    monitor.Run(std::chrono::seconds(3));
+    BOOST_CHECK_EQUAL(
+        monitor.GetLastErrorCode(),
+        NetworkMonitorError::kFailedNetworkLayoutFileDownload
+    );
+}
+
 BOOST_AUTO_TEST_CASE(ok_download_file, *timeout {3})
 {
     // Note: In this test we use a mock but we download the file for real.
@@ -461,6 +691,124 @@ BOOST_AUTO_TEST_CASE(record_1_passenger_event, *timeout {1})
         monitor.GetNetworkRepresentation().GetPassengerCount("station_1"),
         0
     );
+
+    // The event is also in the crowding history, aligned to the minute.
+    const auto handle {
+        monitor.GetNetworkRepresentation().GetStationHandle("station_0")
+    };
+    const auto samples {monitor.GetCrowdingHistory().GetRange(
+        handle, 0, std::numeric_limits<std::int64_t>::max()
+    )};
+    BOOST_REQUIRE_EQUAL(samples.size(), 1);
+    BOOST_CHECK_EQUAL(samples[0].timestampUs, 1604215080'000'000);
+    BOOST_CHECK_EQUAL(samples[0].passengerCount, 1);
+}
+
+BOOST_AUTO_TEST_CASE(crowding_checkpoint, *timeout {1})
+{
+    NetworkMonitorConfig config {
+        "metronetwork.tech",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        std::filesystem::path(TEST_DATA) / "from_json_1line_1route.json",
+    };
+    config.crowdingCheckpointFile = {
+        std::filesystem::temp_directory_path() / "network-monitor-ckpt.bin"
+    };
+
+    // Seed the checkpoint as if a previous run had recorded 5 passengers.
+    TransportNetwork network {};
+    BOOST_REQUIRE(network.FromJson(ParseJsonFile(config.networkLayoutFile)));
+    network.SetNetworkCrowding({{"station_0", 5}});
+    BOOST_REQUIRE(WriteCrowdingCheckpoint(config.crowdingCheckpointFile,
+                                          network.GetLayoutHash(),
+                                          network.GetPassengerCounts()));
+
+    // Setup the mock.
+    nlohmann::json event {
+        {"datetime", "2020-11-01T07:18:50.234000Z"},
+        {"passenger_event", "in"},
+        {"station_id", "station_0"},
+    };
+    MockWebSocketClientForStomp::subscriptionMessages = {
+        event.dump(),
+    };
+
+    // We need to set a timeout otherwise the network monitor will run forever.
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+    BOOST_CHECK_EQUAL(
+        monitor.GetNetworkRepresentation().GetPassengerCount("station_0"),
+        5
+    );
+    monitor.Run(std::chrono::milliseconds(150));
+    BOOST_CHECK_EQUAL(monitor.GetLastErrorCode(), NetworkMonitorError::kOk);
+    BOOST_CHECK_EQUAL(
+        monitor.GetNetworkRepresentation().GetPassengerCount("station_0"),
+        6
+    );
+
+    // The checkpoint is updated when the monitor stops running.
+    std::vector<long long int> passengerCounts {};
+    BOOST_REQUIRE(ReadCrowdingCheckpoint(config.crowdingCheckpointFile,
+                                         network.GetLayoutHash(),
+                                         passengerCounts));
+    BOOST_CHECK_EQUAL(
+        passengerCounts[network.GetStationHandle("station_0")],
+        6
+    );
+    std::filesystem::remove(config.crowdingCheckpointFile);
+}
+
+BOOST_AUTO_TEST_CASE(passenger_event_journal, *timeout {1})
+{
+    NetworkMonitorConfig config {
+        "metronetwork.tech",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        std::filesystem::path(TEST_DATA) / "from_json_1line_1route.json",
+    };
+    config.passengerEventJournalDirectory = {
+        std::filesystem::temp_directory_path() / "network-monitor-journal"
+    };
+    std::filesystem::remove_all(config.passengerEventJournalDirectory);
+
+    // Setup the mock.
+    nlohmann::json event {
+        {"datetime", "2020-11-01T07:18:50.234000Z"},
+        {"passenger_event", "in"},
+        {"station_id", "station_0"},
+    };
+    MockWebSocketClientForStomp::subscriptionMessages = {
+        event.dump(),
+        event.dump(),
+    };
+
+    // The first run journals the events. The second run starts from the
+    // journal, then adds its own events.
+    for (const long long int expected: {2, 4}) {
+        NetworkMonitor::NetworkMonitor<
+            MockWebSocketClientForStomp,
+            MockWebSocketServerForStomp
+        > monitor {};
+        auto ec {monitor.Configure(config)};
+        BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+        monitor.Run(std::chrono::milliseconds(150));
+        BOOST_CHECK_EQUAL(monitor.GetLastErrorCode(), NetworkMonitorError::kOk);
+        BOOST_CHECK_EQUAL(
+            monitor.GetNetworkRepresentation().GetPassengerCount("station_0"),
+            expected
+        );
+    }
+    std::filesystem::remove_all(config.passengerEventJournalDirectory);
 }
 
 BOOST_AUTO_TEST_CASE(record_2_passenger_events_same_station, *timeout {1})
@@ -601,6 +949,62 @@ BOOST_AUTO_TEST_CASE(record_passenger_events_from_file, *timeout {3})
     for (const auto& [stationId, passengerCount]: counts) {
         BOOST_CHECK_EQUAL(network.GetPassengerCount(stationId), passengerCount);
     }
+
+    // All events went through the ingestion stage.
+    const auto& metrics {monitor.GetIngestionMetrics()};
+    BOOST_CHECK_EQUAL(metrics.nEvents, events.size());
+    BOOST_CHECK_LE(metrics.nBatches, metrics.nEvents);
+    BOOST_CHECK_LE(metrics.maxBatchSize, config.ingestionMaxBatchSize);
+    BOOST_CHECK_EQUAL(metrics.queueDepth, 0);
+}
+
+BOOST_AUTO_TEST_CASE(record_passenger_events_aggregation_thread, *timeout {3})
+{
+    NetworkMonitorConfig config {
+        "ltnm.learncppthroughprojects.com",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        TESTS_NETWORK_LAYOUT_JSON,
+    };
+    config.ingestionRingCapacity = 256;
+    config.ingestionBackpressurePolicy = BackpressurePolicy::kBlock;
+
+    // Setup the mock.
+    auto events = ParseJsonFile(
+        std::filesystem::path(TEST_DATA) / "passenger_events.json"
+    ).get<std::vector<nlohmann::json>>();
+    std::vector<std::string> messages {};
+    messages.reserve(events.size());
+    for (const auto& event: events) {
+        messages.emplace_back(event.dump());
+    }
+    MockWebSocketClientForStomp::subscriptionMessages = std::move(messages);
+
+    // Load the expected results.
+    auto counts = ParseJsonFile(
+        std::filesystem::path(TEST_DATA) / "passenger_events_count.json"
+    ).get<std::unordered_map<std::string, long long int>>();
+
+    // We need to set a timeout otherwise the network monitor will run forever.
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+    monitor.Run(std::chrono::milliseconds(1000));
+
+    // When we arrive here, the aggregation thread has processed all events.
+    BOOST_CHECK_EQUAL(monitor.GetLastErrorCode(), NetworkMonitorError::kOk);
+    const auto& network {monitor.GetNetworkRepresentation()};
+    for (const auto& [stationId, passengerCount]: counts) {
+        BOOST_CHECK_EQUAL(network.GetPassengerCount(stationId), passengerCount);
+    }
+    const auto metrics {monitor.GetIngestionMetrics()};
+    BOOST_CHECK_EQUAL(metrics.nEvents, events.size());
+    BOOST_CHECK_EQUAL(metrics.nDropped, 0);
 }
 
 BOOST_AUTO_TEST_CASE(failed_incoming_connection, *timeout {1})
@@ -853,6 +1257,279 @@ BOOST_AUTO_TEST_CASE(quiet_route, *timeout {20})
     BOOST_CHECK_EQUAL(travelRoute.steps.size(), 19);
 }
 
+BOOST_AUTO_TEST_CASE(crowded_stations, *timeout {1})
+{
+    NetworkMonitorConfig config {
+        "metronetwork.tech",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        TESTS_NETWORK_LAYOUT_JSON,
+        "localhost",
+        "127.0.0.1",
+        8042,
+    };
+
+    // Setup the mock.
+    MockWebSocketServerForStomp::mockEvents = std::queue<MockWebSocketEvent> {{
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kConnect,
+            // Succeeds
+        },
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kMessage,
+            {}, // Succeeds
+            GetMockStompFrame("localhost")
+        },
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kMessage,
+            {}, // Succeeds
+            GetMockSendFrame("req0", "/crowded-stations", nlohmann::json {
+                {"n_stations", 2},
+            }.dump())
+        },
+    }};
+
+    // We need to set a timeout otherwise the network monitor will run forever.
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+    monitor.SetNetworkCrowding({
+        {"station_017", 3},
+        {"station_211", 5},
+        {"station_119", 1},
+    });
+    monitor.Run(std::chrono::milliseconds(150));
+
+    // When we arrive here, the Run() function ran out of things to do.
+    BOOST_CHECK_EQUAL(monitor.GetConnectedClients().size(), 1);
+    auto stations {monitor.GetLastCrowdedStations()};
+    BOOST_REQUIRE_EQUAL(stations.size(), 2);
+    BOOST_CHECK_EQUAL(stations[0].stationId, "station_211");
+    BOOST_CHECK_EQUAL(stations[0].passengerCount, 5);
+    BOOST_CHECK_EQUAL(stations[1].stationId, "station_017");
+    BOOST_CHECK_EQUAL(stations[1].passengerCount, 3);
+}
+
+BOOST_AUTO_TEST_CASE(reload_network_layout, *timeout {3})
+{
+    NetworkMonitorConfig config {
+        "metronetwork.tech",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        std::filesystem::temp_directory_path() / "network-monitor-reload.json",
+    };
+    std::filesystem::copy_file(
+        std::filesystem::path(TEST_DATA) / "from_json_2lines_2routes.json",
+        config.networkLayoutFile,
+        std::filesystem::copy_options::overwrite_existing
+    );
+
+    // Setup the mock.
+    nlohmann::json event {
+        {"datetime", "2020-11-01T07:18:50.234000Z"},
+        {"passenger_event", "in"},
+        {"station_id", "station_0"},
+    };
+    MockWebSocketClientForStomp::subscriptionMessages = {
+        event.dump(),
+    };
+
+    // We need to set a timeout otherwise the network monitor will run forever.
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+    monitor.SetNetworkCrowding({
+        {"station_0", 5},
+        {"station_1", 2},
+    });
+    BOOST_REQUIRE_EQUAL(
+        monitor.GetNetworkRepresentation().GetStationHandle("station_0"),
+        0
+    );
+    WriteReorderedNetworkLayout(config.networkLayoutFile);
+    monitor.ReloadNetworkLayout();
+    monitor.Run(std::chrono::milliseconds(300));
+
+    // The passenger event is recorded either before or after the reload: The
+    // result is the same.
+    BOOST_CHECK_EQUAL(monitor.GetLastErrorCode(), NetworkMonitorError::kOk);
+    BOOST_CHECK_EQUAL(monitor.GetNNetworkReloads(), 1);
+    BOOST_CHECK(monitor.GetLastNetworkReloadPause() <
+                std::chrono::milliseconds(100));
+    const auto& network {monitor.GetNetworkRepresentation()};
+    BOOST_REQUIRE_EQUAL(network.GetNStations(), 3);
+    BOOST_CHECK_EQUAL(network.GetStationHandle("station_0"), 2);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount("station_0"), 6);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount("station_1"), 2);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount("station_2"), 0);
+
+    // The crowding history follows the station to its new handle.
+    BOOST_CHECK_EQUAL(monitor.GetCrowdingHistory().GetNStations(), 3);
+    const auto samples {monitor.GetCrowdingHistory().GetRange(
+        network.GetStationHandle("station_0"),
+        0,
+        std::numeric_limits<std::int64_t>::max()
+    )};
+    BOOST_REQUIRE_EQUAL(samples.size(), 1);
+    BOOST_CHECK_EQUAL(samples[0].passengerCount, 6);
+    std::filesystem::remove(config.networkLayoutFile);
+}
+
+BOOST_AUTO_TEST_CASE(reload_network_layout_timer, *timeout {5})
+{
+    NetworkMonitorConfig config {
+        "metronetwork.tech",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        std::filesystem::temp_directory_path() / "network-monitor-reload.json",
+    };
+    config.networkLayoutReloadInterval = std::chrono::seconds(1);
+    std::filesystem::copy_file(
+        std::filesystem::path(TEST_DATA) / "from_json_2lines_2routes.json",
+        config.networkLayoutFile,
+        std::filesystem::copy_options::overwrite_existing
+    );
+
+    // We need to set a timeout otherwise the network monitor will run forever.
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+    monitor.SetNetworkCrowding({{"station_1", 2}});
+
+    // We move the modification time forward explicitly, because the file
+    // system timestamps may be coarser than the time between two writes.
+    const auto writeTime {
+        std::filesystem::last_write_time(config.networkLayoutFile)
+    };
+    WriteReorderedNetworkLayout(config.networkLayoutFile);
+    std::filesystem::last_write_time(config.networkLayoutFile,
+                                     writeTime + std::chrono::seconds(1));
+
+    // The file changed before the first check, but not before the second.
+    monitor.Run(std::chrono::milliseconds(2300));
+    BOOST_CHECK_EQUAL(monitor.GetLastErrorCode(), NetworkMonitorError::kOk);
+    BOOST_CHECK_EQUAL(monitor.GetNNetworkReloads(), 1);
+    const auto& network {monitor.GetNetworkRepresentation()};
+    BOOST_CHECK_EQUAL(network.GetNStations(), 3);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount("station_1"), 2);
+    std::filesystem::remove(config.networkLayoutFile);
+}
+
+BOOST_AUTO_TEST_CASE(reload_network_layout_fail, *timeout {3})
+{
+    NetworkMonitorConfig config {
+        "metronetwork.tech",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        std::filesystem::temp_directory_path() / "network-monitor-reload.json",
+    };
+    std::filesystem::copy_file(
+        std::filesystem::path(TEST_DATA) / "from_json_2lines_2routes.json",
+        config.networkLayoutFile,
+        std::filesystem::copy_options::overwrite_existing
+    );
+
+    // We need to set a timeout otherwise the network monitor will run forever.
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+    monitor.SetNetworkCrowding({{"station_1", 2}});
+    std::filesystem::copy_file(
+        std::filesystem::path(TEST_DATA) / "bad_json_file.json",
+        config.networkLayoutFile,
+        std::filesystem::copy_options::overwrite_existing
+    );
+    monitor.ReloadNetworkLayout();
+    monitor.Run(std::chrono::milliseconds(300));
+
+    // We keep the old network.
+    BOOST_CHECK_EQUAL(monitor.GetNNetworkReloads(), 0);
+    const auto& network {monitor.GetNetworkRepresentation()};
+    BOOST_CHECK_EQUAL(network.GetNStations(), 2);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount("station_1"), 2);
+    std::filesystem::remove(config.networkLayoutFile);
+}
+
+BOOST_AUTO_TEST_CASE(reload_network_request, *timeout {3})
+{
+    NetworkMonitorConfig config {
+        "metronetwork.tech",
+        "443",
+        "some_username",
+        "some_password_123",
+        TESTS_CACERT_PEM,
+        std::filesystem::temp_directory_path() / "network-monitor-reload.json",
+        "localhost",
+        "127.0.0.1",
+        8042,
+    };
+    std::filesystem::copy_file(
+        std::filesystem::path(TEST_DATA) / "from_json_2lines_2routes.json",
+        config.networkLayoutFile,
+        std::filesystem::copy_options::overwrite_existing
+    );
+
+    // Setup the mock.
+    MockWebSocketServerForStomp::mockEvents = std::queue<MockWebSocketEvent> {{
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kConnect,
+            // Succeeds
+        },
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kMessage,
+            {}, // Succeeds
+            GetMockStompFrame("localhost")
+        },
+        MockWebSocketEvent {
+            "connection0",
+            MockWebSocketEvent::Type::kMessage,
+            {}, // Succeeds
+            GetMockSendFrame("req0", "/reload-network", "{}")
+        },
+    }};
+
+    // We need to set a timeout otherwise the network monitor will run forever.
+    NetworkMonitor::NetworkMonitor<
+        MockWebSocketClientForStomp,
+        MockWebSocketServerForStomp
+    > monitor {};
+    auto ec {monitor.Configure(config)};
+    BOOST_REQUIRE_EQUAL(ec, NetworkMonitorError::kOk);
+    WriteReorderedNetworkLayout(config.networkLayoutFile);
+    monitor.Run(std::chrono::milliseconds(300));
+
+    // When we arrive here, the Run() function ran out of things to do.
+    BOOST_CHECK_EQUAL(monitor.GetConnectedClients().size(), 1);
+    BOOST_CHECK_EQUAL(monitor.GetNNetworkReloads(), 1);
+    BOOST_CHECK_EQUAL(monitor.GetNetworkRepresentation().GetNStations(), 3);
+    std::filesystem::remove(config.networkLayoutFile);
+}
+
 BOOST_AUTO_TEST_CASE(quiet_route_ltc_quiet2, *timeout {20})
 {
     // This test is based on the same network, passenger events, and travel
@@ -1042,17 +1719,17 @@ BOOST_AUTO_TEST_CASE(live, *timeout {20})
             &client,
             &quietRoute,
             onClose
-        ](auto ec, auto dst, auto&& msg) {
+        ](auto ec, auto&& frame) {
             BOOST_REQUIRE_EQUAL(ec, StompClientError::kOk);
             clientDidReceiveResp = true;
             spdlog::info("TestStompClient: Received /quiet-route response");
             try {
-                quietRoute = nlohmann::json::parse(msg);
+                quietRoute = nlohmann::json::parse(frame.GetBody());
             } catch (const std::exception& e) {
                 spdlog::error("TestStompClient: Failed to parse response: {}",
                               e.what());
                 spdlog::error("TestStompClient: Response content:\n{}",
-                              nlohmann::json::parse(msg));
+                              nlohmann::json::parse(frame.GetBody()));
                 BOOST_REQUIRE(false);
             }
             spdlog::info("TestStompClient: Closing the client connection");
@@ -0,0 +1,130 @@
+#include "network-snapshot.h"
+#include "transport-network.h"
+#include "file-downloader.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using NetworkMonitor::HashFile;
+using NetworkMonitor::IsNetworkSnapshot;
+using NetworkMonitor::ParseJsonFile;
+using NetworkMonitor::ReadNetworkSnapshot;
+using NetworkMonitor::TransportNetwork;
+using NetworkMonitor::WriteNetworkSnapshot;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(network_snapshot);
+
+BOOST_AUTO_TEST_CASE(write_and_read)
+{
+    const auto file {
+        std::filesystem::temp_directory_path() / "network-snapshot.bin"
+    };
+    std::filesystem::remove(file);
+
+    TransportNetwork expected {};
+    BOOST_REQUIRE(expected.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON)));
+    std::uint64_t sourceHash {0};
+    BOOST_REQUIRE(HashFile(TESTS_NETWORK_LAYOUT_JSON, sourceHash));
+    BOOST_REQUIRE(WriteNetworkSnapshot(file, expected, sourceHash));
+    BOOST_CHECK(IsNetworkSnapshot(file));
+    BOOST_CHECK(!IsNetworkSnapshot(TESTS_NETWORK_LAYOUT_JSON));
+
+    TransportNetwork nw {};
+    std::uint64_t loadedHash {0};
+    BOOST_REQUIRE(ReadNetworkSnapshot(file, nw, loadedHash));
+    BOOST_CHECK_EQUAL(loadedHash, sourceHash);
+    BOOST_CHECK_EQUAL(nw.GetNStations(), expected.GetNStations());
+    BOOST_CHECK_EQUAL(nw.GetLayoutHash(), expected.GetLayoutHash());
+    BOOST_CHECK(nw.GetStations() == expected.GetStations());
+    BOOST_CHECK(nw.GetLines() == expected.GetLines());
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_000", "station_001"),
+                      expected.GetTravelTime("station_000", "station_001"));
+    auto route {nw.GetFastestTravelRoute("station_000", "station_100")};
+    auto expectedRoute {
+        expected.GetFastestTravelRoute("station_000", "station_100")
+    };
+    BOOST_CHECK_EQUAL(route.totalTravelTime, expectedRoute.totalTravelTime);
+
+    std::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE(corrupted_file)
+{
+    const auto file {
+        std::filesystem::temp_directory_path() / "network-snapshot.bin"
+    };
+    TransportNetwork expected {};
+    BOOST_REQUIRE(expected.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON)));
+    BOOST_REQUIRE(WriteNetworkSnapshot(file, expected, 42));
+
+    // Flip a byte in the string table.
+    {
+        std::fstream stream {file,
+                             std::ios::binary | std::ios::in | std::ios::out};
+        stream.seekp(-1, std::ios::end);
+        stream.put('\x01');
+    }
+    TransportNetwork nw {};
+    std::uint64_t sourceHash {7};
+    BOOST_CHECK(IsNetworkSnapshot(file));
+    BOOST_CHECK(!ReadNetworkSnapshot(file, nw, sourceHash));
+    BOOST_CHECK_EQUAL(nw.GetNStations(), 0);
+    BOOST_CHECK_EQUAL(sourceHash, 7);
+
+    // Truncated file.
+    std::filesystem::resize_file(file, 100);
+    BOOST_CHECK(!ReadNetworkSnapshot(file, nw, sourceHash));
+
+    std::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE(not_a_snapshot)
+{
+    TransportNetwork nw {};
+    std::uint64_t sourceHash {0};
+    BOOST_CHECK(!ReadNetworkSnapshot(TESTS_NETWORK_LAYOUT_JSON, nw,
+                                     sourceHash));
+    const auto missingFile {
+        std::filesystem::temp_directory_path() / "network-snapshot-none.bin"
+    };
+    BOOST_CHECK(!IsNetworkSnapshot(missingFile));
+    BOOST_CHECK(!ReadNetworkSnapshot(missingFile, nw, sourceHash));
+}
+
+BOOST_AUTO_TEST_CASE(hash_file)
+{
+    const auto file {
+        std::filesystem::temp_directory_path() / "network-snapshot-hash.txt"
+    };
+    {
+        std::ofstream out {file};
+        out << "some content";
+    }
+    std::uint64_t hash {0};
+    BOOST_REQUIRE(HashFile(file, hash));
+    std::uint64_t sameHash {0};
+    BOOST_REQUIRE(HashFile(file, sameHash));
+    BOOST_CHECK_EQUAL(hash, sameHash);
+
+    // Any change to the content changes the hash.
+    {
+        std::ofstream out {file};
+        out << "some contenu";
+    }
+    std::uint64_t otherHash {0};
+    BOOST_REQUIRE(HashFile(file, otherHash));
+    BOOST_CHECK_NE(hash, otherHash);
+
+    std::filesystem::remove(file);
+    BOOST_CHECK(!HashFile(file, otherHash));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // network_snapshot
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -0,0 +1,106 @@
+#include "passenger-event-batcher.h"
+
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <vector>
+
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerEventBatcher;
+using NetworkMonitor::PassengerEventRecord;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_PassengerEventBatcher);
+
+// Push nEvents events from separate handlers, as the STOMP client does, and
+// return the size of the batches.
+static std::vector<size_t> RunBurst(
+    const size_t nEvents,
+    const size_t maxBatchSize,
+    const std::chrono::microseconds maxLatency,
+    NetworkMonitor::IngestionMetrics& metrics
+)
+{
+    boost::asio::io_context ioc {};
+    std::vector<size_t> batchSizes {};
+    PassengerEventBatcher batcher {
+        ioc,
+        [&batchSizes](const auto& events) {
+            batchSizes.push_back(events.size());
+        },
+        maxBatchSize,
+        maxLatency,
+    };
+    for (size_t idx {0}; idx < nEvents; ++idx) {
+        boost::asio::post(ioc, [&batcher, idx]() {
+            batcher.Push({
+                static_cast<NetworkMonitor::StationHandle>(idx),
+                PassengerEvent::Type::In,
+                0,
+            });
+        });
+    }
+    ioc.run();
+    metrics = batcher.GetMetrics();
+    return batchSizes;
+}
+
+BOOST_AUTO_TEST_CASE(one_batch_per_drain)
+{
+    NetworkMonitor::IngestionMetrics metrics {};
+    auto batchSizes {RunBurst(10, 1024, std::chrono::seconds(1), metrics)};
+    BOOST_CHECK(batchSizes == std::vector<size_t>({10}));
+    BOOST_CHECK_EQUAL(metrics.nEvents, 10);
+    BOOST_CHECK_EQUAL(metrics.nBatches, 1);
+    BOOST_CHECK_EQUAL(metrics.lastBatchSize, 10);
+    BOOST_CHECK_EQUAL(metrics.maxQueueDepth, 10);
+    BOOST_CHECK_EQUAL(metrics.queueDepth, 0);
+    BOOST_CHECK_EQUAL(metrics.GetMeanBatchSize(), 10.0);
+}
+
+BOOST_AUTO_TEST_CASE(max_batch_size)
+{
+    NetworkMonitor::IngestionMetrics metrics {};
+    auto batchSizes {RunBurst(10, 4, std::chrono::seconds(1), metrics)};
+    BOOST_CHECK(batchSizes == std::vector<size_t>({4, 4, 2}));
+    BOOST_CHECK_EQUAL(metrics.maxBatchSize, 4);
+    BOOST_CHECK_EQUAL(metrics.maxQueueDepth, 4);
+}
+
+BOOST_AUTO_TEST_CASE(max_latency)
+{
+    // With no latency budget, every event is applied on arrival.
+    NetworkMonitor::IngestionMetrics metrics {};
+    auto batchSizes {RunBurst(10, 1024, std::chrono::microseconds(0), metrics)};
+    BOOST_CHECK(batchSizes == std::vector<size_t>(10, 1));
+    BOOST_CHECK_EQUAL(metrics.nBatches, 10);
+}
+
+BOOST_AUTO_TEST_CASE(flush)
+{
+    boost::asio::io_context ioc {};
+    size_t nEvents {0};
+    PassengerEventBatcher batcher {
+        ioc,
+        [&nEvents](const auto& events) {
+            nEvents += events.size();
+        },
+    };
+    batcher.Push({0, PassengerEvent::Type::In, 0});
+    batcher.Push({1, PassengerEvent::Type::Out, 0});
+    BOOST_CHECK_EQUAL(nEvents, 0);
+    BOOST_CHECK_EQUAL(batcher.GetMetrics().queueDepth, 2);
+    batcher.Flush();
+    BOOST_CHECK_EQUAL(nEvents, 2);
+
+    // The scheduled flush has nothing left to do.
+    ioc.run();
+    BOOST_CHECK_EQUAL(nEvents, 2);
+    BOOST_CHECK_EQUAL(batcher.GetMetrics().nBatches, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_PassengerEventBatcher
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -0,0 +1,112 @@
+#include "passenger-event-journal.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerEventJournal;
+using NetworkMonitor::ReplayPassengerEventJournal;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_PassengerEventJournal);
+
+using EventType = PassengerEvent::Type;
+
+BOOST_AUTO_TEST_CASE(append_and_replay)
+{
+    const auto directory {
+        std::filesystem::temp_directory_path() / "passenger-event-journal"
+    };
+    std::filesystem::remove_all(directory);
+
+    {
+        PassengerEventJournal journal {directory};
+        BOOST_REQUIRE(journal.Open(42));
+        journal.Append({0, EventType::In, 1});
+        journal.Append({0, EventType::In, 2});
+        journal.Append({1, EventType::Out, 3});
+        journal.Append({5, EventType::In, 4});
+        journal.Close();
+        BOOST_CHECK_EQUAL(journal.GetNRecordsWritten(), 4);
+
+        // Records appended after the journal is closed are dropped.
+        journal.Append({0, EventType::In, 5});
+    }
+
+    // Re-opening the journal starts a new segment.
+    {
+        PassengerEventJournal journal {directory};
+        BOOST_REQUIRE(journal.Open(42));
+        journal.Append({1, EventType::In, 6});
+    }
+
+    // Station 5 is out of range and is skipped.
+    std::vector<long long int> passengerCounts(2, 0);
+    auto nEvents {ReplayPassengerEventJournal(directory, 42, passengerCounts)};
+    BOOST_CHECK_EQUAL(nEvents, 4);
+    BOOST_CHECK(passengerCounts == std::vector<long long int>({2, 0}));
+
+    // Segments for a different layout are skipped.
+    passengerCounts = {0, 0};
+    nEvents = ReplayPassengerEventJournal(directory, 43, passengerCounts);
+    BOOST_CHECK_EQUAL(nEvents, 0);
+    BOOST_CHECK(passengerCounts == std::vector<long long int>({0, 0}));
+
+    std::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(segments_and_group_commit)
+{
+    const auto directory {
+        std::filesystem::temp_directory_path() / "passenger-event-journal"
+    };
+    std::filesystem::remove_all(directory);
+
+    // Small segments, so that the journal rolls over a few times.
+    const size_t nRecords {10'000};
+    {
+        PassengerEventJournal journal {
+            directory,
+            16 * 1024,
+            std::chrono::milliseconds(1)
+        };
+        BOOST_REQUIRE(journal.Open(42));
+        for (size_t idx {0}; idx < nRecords; ++idx) {
+            journal.Append({
+                static_cast<NetworkMonitor::StationHandle>(idx % 3),
+                idx % 4 == 0 ? EventType::Out : EventType::In,
+                static_cast<std::int64_t>(idx),
+            });
+        }
+        journal.Close();
+        BOOST_CHECK_EQUAL(journal.GetNRecordsWritten(), nRecords);
+
+        // Records are written in groups, not one by one.
+        BOOST_CHECK_LT(journal.GetNFlushes(), nRecords);
+    }
+    size_t nSegments {0};
+    for (const auto& entry: std::filesystem::directory_iterator(directory)) {
+        ++nSegments;
+    }
+    BOOST_CHECK_GT(nSegments, 1);
+
+    std::vector<long long int> passengerCounts(3, 0);
+    auto nEvents {ReplayPassengerEventJournal(directory, 42, passengerCounts)};
+    BOOST_CHECK_EQUAL(nEvents, nRecords);
+    std::vector<long long int> expected(3, 0);
+    for (size_t idx {0}; idx < nRecords; ++idx) {
+        expected[idx % 3] += idx % 4 == 0 ? -1 : 1;
+    }
+    BOOST_CHECK(passengerCounts == expected);
+
+    std::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_PassengerEventJournal
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
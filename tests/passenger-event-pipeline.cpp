@@ -0,0 +1,145 @@
+#include "passenger-event-pipeline.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::BackpressurePolicy;
+using NetworkMonitor::PassengerEventPipeline;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(enum_class_BackpressurePolicy);
+
+BOOST_AUTO_TEST_CASE(ostream)
+{
+    std::stringstream ss {};
+    ss << BackpressurePolicy::kDropOldest;
+    BOOST_CHECK_EQUAL(ss.str(), "drop-oldest");
+}
+
+BOOST_AUTO_TEST_CASE(parse)
+{
+    BackpressurePolicy policy {BackpressurePolicy::kBlock};
+    BOOST_CHECK(NetworkMonitor::ParseBackpressurePolicy("count-and-drop",
+                                                        policy));
+    BOOST_CHECK(policy == BackpressurePolicy::kCountAndDrop);
+    BOOST_CHECK(!NetworkMonitor::ParseBackpressurePolicy("drop", policy));
+    BOOST_CHECK(policy == BackpressurePolicy::kCountAndDrop);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // enum_class_BackpressurePolicy
+
+BOOST_AUTO_TEST_SUITE(class_PassengerEventPipeline);
+
+// Push the messages "0", "1", ... before the aggregation thread starts, then
+// let the aggregation thread drain the ring.
+static void FillThenDrain(
+    PassengerEventPipeline& pipeline,
+    const size_t nMessages
+)
+{
+    for (size_t idx {0}; idx < nMessages; ++idx) {
+        pipeline.Push(std::to_string(idx));
+    }
+    pipeline.Start();
+    pipeline.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(all_messages)
+{
+    std::vector<std::string> received {};
+    PassengerEventPipeline pipeline {
+        [&received](auto& messages) {
+            received.insert(received.end(), messages.begin(), messages.end());
+        },
+        1024,
+        BackpressurePolicy::kCountAndDrop,
+        64,
+    };
+    pipeline.Start();
+    for (size_t idx {0}; idx < 1000; ++idx) {
+        BOOST_CHECK(pipeline.Push(std::to_string(idx)));
+    }
+    pipeline.Stop();
+
+    BOOST_REQUIRE_EQUAL(received.size(), 1000);
+    for (size_t idx {0}; idx < 1000; ++idx) {
+        BOOST_CHECK_EQUAL(received[idx], std::to_string(idx));
+    }
+    const auto metrics {pipeline.GetMetrics()};
+    BOOST_CHECK_EQUAL(metrics.nEvents, 1000);
+    BOOST_CHECK_LE(metrics.maxBatchSize, 64);
+    BOOST_CHECK_EQUAL(metrics.nDropped, 0);
+    BOOST_CHECK_EQUAL(metrics.queueDepth, 0);
+}
+
+BOOST_AUTO_TEST_CASE(count_and_drop)
+{
+    std::vector<std::string> received {};
+    PassengerEventPipeline pipeline {
+        [&received](auto& messages) {
+            received.insert(received.end(), messages.begin(), messages.end());
+        },
+        4,
+        BackpressurePolicy::kCountAndDrop,
+    };
+
+    // The aggregation thread is not running yet, so the ring fills up and the
+    // newest messages are dropped.
+    FillThenDrain(pipeline, 10);
+    std::vector<std::string> expected {"0", "1", "2", "3"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(received.begin(), received.end(),
+                                  expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(pipeline.GetMetrics().nDropped, 6);
+}
+
+BOOST_AUTO_TEST_CASE(drop_oldest)
+{
+    std::vector<std::string> received {};
+    PassengerEventPipeline pipeline {
+        [&received](auto& messages) {
+            received.insert(received.end(), messages.begin(), messages.end());
+        },
+        4,
+        BackpressurePolicy::kDropOldest,
+    };
+    FillThenDrain(pipeline, 10);
+    std::vector<std::string> expected {"6", "7", "8", "9"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(received.begin(), received.end(),
+                                  expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(pipeline.GetMetrics().nDropped, 6);
+}
+
+BOOST_AUTO_TEST_CASE(block)
+{
+    // A slow consumer forces the producer to wait for room in the ring.
+    std::vector<std::string> received {};
+    PassengerEventPipeline pipeline {
+        [&received](auto& messages) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            received.insert(received.end(), messages.begin(), messages.end());
+        },
+        2,
+        BackpressurePolicy::kBlock,
+    };
+    pipeline.Start();
+    for (size_t idx {0}; idx < 50; ++idx) {
+        BOOST_CHECK(pipeline.Push(std::to_string(idx)));
+    }
+    pipeline.Stop();
+
+    BOOST_REQUIRE_EQUAL(received.size(), 50);
+    for (size_t idx {0}; idx < 50; ++idx) {
+        BOOST_CHECK_EQUAL(received[idx], std::to_string(idx));
+    }
+    BOOST_CHECK_EQUAL(pipeline.GetMetrics().nDropped, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_PassengerEventPipeline
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
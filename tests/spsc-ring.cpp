@@ -0,0 +1,81 @@
+#include "spsc-ring.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <thread>
+
+using NetworkMonitor::SpscRing;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_SpscRing);
+
+BOOST_AUTO_TEST_CASE(capacity)
+{
+    BOOST_CHECK_EQUAL(SpscRing<int> {0}.GetCapacity(), 1);
+    BOOST_CHECK_EQUAL(SpscRing<int> {1}.GetCapacity(), 1);
+    BOOST_CHECK_EQUAL(SpscRing<int> {5}.GetCapacity(), 8);
+    BOOST_CHECK_EQUAL(SpscRing<int> {64}.GetCapacity(), 64);
+}
+
+BOOST_AUTO_TEST_CASE(push_pop)
+{
+    SpscRing<std::string> ring {4};
+    BOOST_CHECK_EQUAL(ring.GetSize(), 0);
+
+    // Fill the ring.
+    for (int idx {0}; idx < 4; ++idx) {
+        BOOST_CHECK(ring.TryPush(std::to_string(idx)));
+    }
+    BOOST_CHECK_EQUAL(ring.GetSize(), 4);
+    std::string rejected {"4"};
+    BOOST_CHECK(!ring.TryPush(std::move(rejected)));
+    BOOST_CHECK_EQUAL(rejected, "4");
+
+    // Elements come out in order, also after wrapping around.
+    std::string element {};
+    BOOST_REQUIRE(ring.TryPop(element));
+    BOOST_CHECK_EQUAL(element, "0");
+    BOOST_CHECK(ring.TryPush(std::move(rejected)));
+    for (int idx {1}; idx < 5; ++idx) {
+        BOOST_REQUIRE(ring.TryPop(element));
+        BOOST_CHECK_EQUAL(element, std::to_string(idx));
+    }
+    BOOST_CHECK(!ring.TryPop(element));
+    BOOST_CHECK_EQUAL(ring.GetSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(two_threads)
+{
+    constexpr size_t nElements {1'000'000};
+    SpscRing<size_t> ring {64};
+    std::thread producer {[&ring]() {
+        for (size_t idx {0}; idx < nElements; ++idx) {
+            auto value {idx};
+            while (!ring.TryPush(std::move(value))) {
+                std::this_thread::yield();
+            }
+        }
+    }};
+
+    // The consumer must see every element exactly once, in order.
+    size_t expected {0};
+    size_t nOutOfOrder {0};
+    size_t value {0};
+    while (expected < nElements) {
+        if (!ring.TryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        nOutOfOrder += value != expected ? 1 : 0;
+        ++expected;
+    }
+    producer.join();
+    BOOST_CHECK_EQUAL(nOutOfOrder, 0);
+    BOOST_CHECK(!ring.TryPop(value));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_SpscRing
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -21,6 +21,7 @@ using NetworkMonitor::StompClientError;
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompHeader;
 
 using namespace std::string_literals;
 
@@ -74,6 +75,16 @@ BOOST_AUTO_TEST_CASE(ostream)
     }
 }
 
+BOOST_AUTO_TEST_CASE(formatter)
+{
+    BOOST_CHECK_EQUAL(
+        fmt::format("{}", StompClientError::kWebSocketServerDisconnected),
+        "WebSocketServerDisconnected"
+    );
+    BOOST_CHECK_EQUAL(fmt::format("{}", static_cast<StompClientError>(1000)),
+                      "UndefinedError");
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // enum_class_StompClientError
 
 BOOST_FIXTURE_TEST_SUITE(class_StompClient, StompClientTestFixture);
@@ -339,7 +350,7 @@ BOOST_AUTO_TEST_CASE(subscribe, *timeout {1})
         BOOST_CHECK(id != "");
         client.Close([](auto ec) {});
     }};
-    auto onMessage {[](auto ec, auto&& msg) {
+    auto onMessage {[](auto ec, auto&& frame) {
     }};
     auto onConnect {[&client, &onSubscribe, &onMessage](auto ec) {
         BOOST_REQUIRE_EQUAL(ec, StompClientError::kOk);
@@ -378,7 +389,7 @@ BOOST_AUTO_TEST_CASE(subscribe_onSubscribe_nullptr, *timeout {1})
         ctx
     };
     bool subscribed {false};
-    auto onMessage {[&subscribed, &client](auto ec, auto&& msg) {
+    auto onMessage {[&subscribed, &client](auto ec, auto&& frame) {
         BOOST_CHECK_EQUAL(ec, StompClientError::kOk);
         subscribed = true;
         client.Close([](auto ec) {});
@@ -452,7 +463,7 @@ BOOST_AUTO_TEST_CASE(subscribe_get_message, *timeout {1})
         ctx
     };
     bool messageReceived {false};
-    auto onMessage {[&messageReceived, &client](auto ec, auto&& msg) {
+    auto onMessage {[&messageReceived, &client](auto ec, auto&& frame) {
         messageReceived = true;
         BOOST_CHECK_EQUAL(ec, StompClientError::kOk);
         client.Close([](auto ec) {});
@@ -492,7 +503,7 @@ BOOST_AUTO_TEST_CASE(subscribe_before_connect, *timeout {1})
         BOOST_CHECK_EQUAL(id, "");
         client.Close([](auto ec) {});
     }};
-    auto onMessage {[](auto ec, auto&& msg) {
+    auto onMessage {[](auto ec, auto&& frame) {
         // We should never get here.
         BOOST_CHECK(false);
     }};
@@ -674,11 +685,14 @@ BOOST_AUTO_TEST_CASE(receive_message, *timeout {1})
         &destination,
         &message,
         &client
-    ](auto ec, auto&& dst, auto&& msg) {
+    ](auto ec, auto&& frame) {
         calledOnMessage = true;
         BOOST_CHECK_EQUAL(ec, StompClientError::kOk);
-        BOOST_CHECK_EQUAL(dst, destination);
-        BOOST_CHECK_EQUAL(msg, message.dump());
+        BOOST_CHECK_EQUAL(
+            frame.GetHeaderValue(StompHeader::kDestination),
+            destination
+        );
+        BOOST_CHECK_EQUAL(frame.GetBody(), message.dump());
         client.Close();
     }};
     auto onConnect {[&destination, &message](auto ec) {
@@ -787,7 +801,7 @@ BOOST_AUTO_TEST_CASE(live, *timeout {3})
     // Receiving messages from the live service is not guaranteed, as it depends
     // on the time of the day. If we do receive a message, we check that it is
     // valid.
-    auto onMessage {[](auto ec, auto&& msg) {
+    auto onMessage {[](auto ec, auto&& frame) {
         BOOST_CHECK_EQUAL(ec, StompClientError::kOk);
     }};
 
@@ -0,0 +1,228 @@
+#include "stomp-decoder.h"
+#include "stomp-frame.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompDecoder;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompHeader;
+
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_StompDecoder);
+
+static const std::string connectFrame {
+    "CONNECT\n"
+    "accept-version:42\n"
+    "host:host.com\n"
+    "\n"
+    "Frame body\0"s
+};
+
+static const std::string sendFrame {
+    "SEND\n"
+    "destination:/queue/a\n"
+    "content-length:10\n"
+    "\n"
+    "Frame\0body\0"s
+};
+
+BOOST_AUTO_TEST_CASE(single_frame)
+{
+    StompDecoder decoder {};
+    std::pmr::vector<StompFrame> frames {};
+    auto error {decoder.Decode(std::string_view {connectFrame}, frames)};
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_REQUIRE_EQUAL(frames.size(), 1);
+    BOOST_CHECK_EQUAL(frames[0].GetCommand(), StompCommand::kConnect);
+    BOOST_CHECK_EQUAL(frames[0].GetBody(), "Frame body");
+    BOOST_CHECK(!decoder.HasPartialFrame());
+}
+
+BOOST_AUTO_TEST_CASE(single_frame_rvalue)
+{
+    StompDecoder decoder {};
+    std::pmr::vector<StompFrame> frames {};
+    auto error {decoder.Decode(connectFrame + "\n\n", frames)};
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_REQUIRE_EQUAL(frames.size(), 1);
+    BOOST_CHECK_EQUAL(frames[0].GetCommand(), StompCommand::kConnect);
+    BOOST_CHECK_EQUAL(frames[0].GetBody(), "Frame body");
+
+    // A chunk with several frames cannot be handed over to a single frame.
+    frames.clear();
+    error = decoder.Decode(connectFrame + sendFrame, frames);
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_REQUIRE_EQUAL(frames.size(), 2);
+    BOOST_CHECK_EQUAL(frames[1].GetBody(), "Frame\0body"s);
+}
+
+BOOST_AUTO_TEST_CASE(arena_output)
+{
+    // The frames vector must not need memory beyond the arena buffer.
+    std::array<std::byte, 4096> buffer {};
+    std::pmr::monotonic_buffer_resource arena {
+        buffer.data(),
+        buffer.size(),
+        std::pmr::null_memory_resource()
+    };
+    std::pmr::vector<StompFrame> frames {&arena};
+    frames.reserve(4);
+    StompDecoder decoder {};
+    auto error {decoder.Decode(connectFrame + sendFrame, frames)};
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frames.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(multiple_frames_heart_beats)
+{
+    StompDecoder decoder {};
+    std::pmr::vector<StompFrame> frames {};
+    auto chunk {"\n"s + connectFrame + "\n\n" + sendFrame + "\n" +
+                connectFrame};
+    auto error {decoder.Decode(std::string_view {chunk}, frames)};
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_REQUIRE_EQUAL(frames.size(), 3);
+    BOOST_CHECK_EQUAL(frames[0].GetCommand(), StompCommand::kConnect);
+    BOOST_CHECK_EQUAL(frames[1].GetCommand(), StompCommand::kSend);
+    BOOST_CHECK_EQUAL(frames[1].GetBody(), "Frame\0body"s);
+    BOOST_CHECK_EQUAL(frames[2].GetCommand(), StompCommand::kConnect);
+    BOOST_CHECK(!decoder.HasPartialFrame());
+}
+
+BOOST_AUTO_TEST_CASE(split_at_every_position)
+{
+    const auto stream {connectFrame + "\n" + sendFrame + sendFrame};
+    for (size_t split {0}; split <= stream.size(); ++split) {
+        StompDecoder decoder {};
+        std::pmr::vector<StompFrame> frames {};
+        auto error {decoder.Decode(stream.substr(0, split), frames)};
+        BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+        error = decoder.Decode(stream.substr(split), frames);
+        BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+        BOOST_REQUIRE_EQUAL(frames.size(), 3);
+        BOOST_CHECK_EQUAL(frames[0].GetBody(), "Frame body");
+        BOOST_CHECK_EQUAL(frames[1].GetBody(), "Frame\0body"s);
+        BOOST_CHECK_EQUAL(frames[2].GetBody(), "Frame\0body"s);
+        BOOST_CHECK(!decoder.HasPartialFrame());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(byte_by_byte)
+{
+    const auto stream {sendFrame + "\n" + connectFrame};
+    StompDecoder decoder {};
+    std::pmr::vector<StompFrame> frames {};
+    for (const auto byte: stream) {
+        auto error {decoder.Decode(std::string_view {&byte, 1}, frames)};
+        BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    }
+    BOOST_REQUIRE_EQUAL(frames.size(), 2);
+    BOOST_CHECK_EQUAL(frames[0].GetCommand(), StompCommand::kSend);
+    BOOST_CHECK_EQUAL(frames[0].GetHeaderValue(StompHeader::kDestination),
+                      "/queue/a");
+    BOOST_CHECK_EQUAL(frames[0].GetBody(), "Frame\0body"s);
+    BOOST_CHECK_EQUAL(frames[1].GetCommand(), StompCommand::kConnect);
+    BOOST_CHECK(!decoder.HasPartialFrame());
+}
+
+BOOST_AUTO_TEST_CASE(partial_frame)
+{
+    StompDecoder decoder {};
+    std::pmr::vector<StompFrame> frames {};
+    auto error {decoder.Decode(sendFrame.substr(0, 30), frames)};
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_CHECK(frames.empty());
+    BOOST_CHECK(decoder.HasPartialFrame());
+
+    decoder.Reset();
+    BOOST_CHECK(!decoder.HasPartialFrame());
+    error = decoder.Decode(std::string_view {connectFrame}, frames);
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frames.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(frame_too_large)
+{
+    // Without content-length, we only know when the buffer is too large.
+    {
+        StompDecoder decoder {64};
+        std::pmr::vector<StompFrame> frames {};
+        auto error {decoder.Decode("SEND\n\n"s, frames)};
+        BOOST_CHECK_EQUAL(error, StompError::kOk);
+        error = decoder.Decode(std::string(100, 'a'), frames);
+        BOOST_CHECK_EQUAL(error, StompError::kParsingFrameTooLarge);
+        BOOST_CHECK(frames.empty());
+    }
+
+    // With content-length, we know as soon as we read the headers.
+    {
+        StompDecoder decoder {64};
+        std::pmr::vector<StompFrame> frames {};
+        auto error {decoder.Decode("SEND\ncontent-length:100\n\n"s, frames)};
+        BOOST_CHECK_EQUAL(error, StompError::kParsingFrameTooLarge);
+    }
+
+    // A complete frame is also rejected.
+    {
+        StompDecoder decoder {16};
+        std::pmr::vector<StompFrame> frames {};
+        auto error {decoder.Decode(std::string_view {connectFrame}, frames)};
+        BOOST_CHECK_EQUAL(error, StompError::kParsingFrameTooLarge);
+        BOOST_CHECK(frames.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(invalid_content_length)
+{
+    StompDecoder decoder {};
+    std::pmr::vector<StompFrame> frames {};
+    auto error {decoder.Decode(
+        "SEND\ncontent-length:abc\n\nFrame body\0"s,
+        frames
+    )};
+    BOOST_CHECK_EQUAL(error, StompError::kParsingInvalidContentLength);
+    BOOST_CHECK(frames.empty());
+}
+
+BOOST_AUTO_TEST_CASE(invalid_frame)
+{
+    StompDecoder decoder {};
+    std::pmr::vector<StompFrame> frames {};
+    auto error {decoder.Decode(
+        std::string_view {connectFrame + "NOTACOMMAND\n\n\0"s},
+        frames
+    )};
+    BOOST_CHECK_EQUAL(error, StompError::kParsingUnrecognizedCommand);
+    BOOST_CHECK_EQUAL(frames.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(sticky_error)
+{
+    StompDecoder decoder {};
+    std::pmr::vector<StompFrame> frames {};
+    auto error {decoder.Decode("NOTACOMMAND\n\n\0"s, frames)};
+    BOOST_CHECK_EQUAL(error, StompError::kParsingUnrecognizedCommand);
+    error = decoder.Decode(std::string_view {connectFrame}, frames);
+    BOOST_CHECK_EQUAL(error, StompError::kParsingUnrecognizedCommand);
+    BOOST_CHECK(frames.empty());
+
+    decoder.Reset();
+    error = decoder.Decode(std::string_view {connectFrame}, frames);
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frames.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompDecoder
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
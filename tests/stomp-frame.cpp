@@ -8,7 +8,11 @@
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFrameBuilder;
+using NetworkMonitor::StompFrameTemplate;
 using NetworkMonitor::StompHeader;
+using NetworkMonitor::SharedStompFrame;
+using NetworkMonitor::MakeSharedStompFrame;
 
 using namespace std::string_literals;
 
@@ -46,6 +50,13 @@ BOOST_AUTO_TEST_CASE(ostream)
     }
 }
 
+BOOST_AUTO_TEST_CASE(formatter)
+{
+    BOOST_CHECK_EQUAL(fmt::format("{}", StompCommand::kSend), "SEND");
+    BOOST_CHECK_EQUAL(fmt::format("{}", StompCommand::kInvalid),
+                      NetworkMonitor::ToString(StompCommand::kInvalid));
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // enum_class_StompCommand
 
 BOOST_AUTO_TEST_SUITE(enum_class_StompHeader);
@@ -82,6 +93,14 @@ BOOST_AUTO_TEST_CASE(ostream)
     }
 }
 
+BOOST_AUTO_TEST_CASE(formatter)
+{
+    BOOST_CHECK_EQUAL(fmt::format("{}", StompHeader::kContentLength),
+                      "content-length");
+    BOOST_CHECK_EQUAL(fmt::format("{}", StompHeader::kInvalid),
+                      NetworkMonitor::ToString(StompHeader::kInvalid));
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // enum_class_StompHeader
 
 BOOST_AUTO_TEST_SUITE(enum_class_StompError);
@@ -95,6 +114,7 @@ BOOST_AUTO_TEST_CASE(ostream)
         StompError::kOk,
         StompError::kParsingEmptyHeaderValue,
         StompError::kParsingContentLengthExceedsFrameLength,
+        StompError::kParsingFrameTooLarge,
         StompError::kParsingInvalidContentLength,
         StompError::kParsingJunkAfterBody,
         StompError::kParsingMissingBlankLineAfterHeaders,
@@ -115,6 +135,20 @@ BOOST_AUTO_TEST_CASE(ostream)
     }
 }
 
+BOOST_AUTO_TEST_CASE(formatter)
+{
+    BOOST_CHECK_EQUAL(fmt::format("{}", StompError::kParsingFrameTooLarge),
+                      "ParsingFrameTooLarge");
+    BOOST_CHECK_EQUAL(
+        fmt::format("{}", StompError::kParsingMissingBlankLineAfterHeaders),
+        "ParsingMissingBlankLineAfterHeaders"
+    );
+
+    // Values out of the enum range are undefined errors.
+    BOOST_CHECK_EQUAL(fmt::format("{}", static_cast<StompError>(1000)),
+                      "UndefinedError");
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // enum_class_StompError
 
 BOOST_AUTO_TEST_SUITE(class_StompFrame);
@@ -560,6 +594,120 @@ BOOST_AUTO_TEST_CASE(parse_required_headers)
     }
 }
 
+BOOST_AUTO_TEST_CASE(parse_truncated_header_value)
+{
+    std::string plain {
+        "CONNECT\n"
+        "host:"
+    };
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_CHECK_EQUAL(error, StompError::kParsingMissingEolAfterHeaderValue);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kInvalid);
+}
+
+// The parser scans the frame in blocks: We move the delimiters across the
+// block boundaries.
+BOOST_AUTO_TEST_CASE(parse_block_boundaries)
+{
+    for (size_t bodyLength {0}; bodyLength < 300; ++bodyLength) {
+        const std::string body(bodyLength, 'b');
+        for (const bool withContentLength: {false, true}) {
+            std::string headers {"SEND\ndestination:/" + body + "\n"};
+            if (withContentLength) {
+                headers += "content-length:" + std::to_string(bodyLength) +
+                           "\n";
+            }
+            const auto plain {headers + "\n" + body + "\0"s};
+            {
+                StompError error;
+                StompFrame frame {error, plain + "\n\n"};
+                BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+                BOOST_CHECK_EQUAL(frame.GetBody(), body);
+                BOOST_CHECK_EQUAL(
+                    frame.GetHeaderValue(StompHeader::kDestination),
+                    "/" + body
+                );
+            }
+            {
+                StompError error;
+                StompFrame frame {error, plain + std::string(bodyLength, '\n')
+                                         + "x"};
+                BOOST_CHECK_EQUAL(error, StompError::kParsingJunkAfterBody);
+            }
+            {
+                StompError error;
+                StompFrame frame {error, headers + "\n" + body};
+                BOOST_CHECK_EQUAL(error, StompError::kParsingMissingNullInBody);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parse_all_commands)
+{
+    for (auto command: {
+        StompCommand::kAbort, StompCommand::kAck, StompCommand::kBegin,
+        StompCommand::kCommit, StompCommand::kConnect,
+        StompCommand::kConnected, StompCommand::kDisconnect,
+        StompCommand::kError, StompCommand::kMessage, StompCommand::kNack,
+        StompCommand::kReceipt, StompCommand::kSend, StompCommand::kStomp,
+        StompCommand::kSubscribe, StompCommand::kUnsubscribe,
+    }) {
+        std::string plain {NetworkMonitor::ToString(command)};
+        plain += "\n\n\0"s;
+        StompError error;
+        StompFrame frame {error, std::move(plain)};
+        BOOST_CHECK_EQUAL(frame.GetCommand(), command);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parse_all_headers)
+{
+    std::string plain {"ERROR\n"};
+    for (size_t idx {1}; idx < StompFrame::kNHeaders; ++idx) {
+        auto header {static_cast<StompHeader>(idx)};
+        if (header == StompHeader::kContentLength) {
+            plain += "content-length:4\n";
+        } else {
+            plain += NetworkMonitor::ToString(header);
+            plain += ":value" + std::to_string(idx) + "\n";
+        }
+    }
+    plain += "\nbody\0"s;
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kError);
+    for (size_t idx {1}; idx < StompFrame::kNHeaders; ++idx) {
+        auto header {static_cast<StompHeader>(idx)};
+        BOOST_CHECK(frame.HasHeader(header));
+        if (header != StompHeader::kContentLength) {
+            BOOST_CHECK_EQUAL(frame.GetHeaderValue(header),
+                              "value" + std::to_string(idx));
+        }
+    }
+    BOOST_CHECK(!frame.HasHeader(StompHeader::kInvalid));
+    BOOST_CHECK_EQUAL(frame.GetBody(), "body");
+}
+
+BOOST_AUTO_TEST_CASE(parse_near_miss_keywords)
+{
+    // Same length and first character as a valid keyword.
+    for (auto command: {"SUBSCRIBX", "NOCK", "CONNECTEE", "Send", ""}) {
+        std::string plain {std::string(command) + "\n\n\0"s};
+        StompError error;
+        StompFrame frame {error, std::move(plain)};
+        BOOST_CHECK_EQUAL(error, StompError::kParsingUnrecognizedCommand);
+    }
+    for (auto header: {"ix", "content-lengtx", "receipt-ix", "Host", ":"}) {
+        std::string plain {"ERROR\n" + std::string(header) + ":42\n\n\0"s};
+        StompError error;
+        StompFrame frame {error, std::move(plain)};
+        BOOST_CHECK_EQUAL(error, StompError::kParsingUnrecognizedHeader);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(constructors)
 {
     std::string plain {
@@ -721,8 +869,399 @@ BOOST_AUTO_TEST_CASE(to_string)
     BOOST_CHECK_EQUAL(plain, frame.ToString());
 }
 
+BOOST_AUTO_TEST_CASE(to_string_rvalue)
+{
+    const std::string plain {
+        "CONNECT\n"
+        "accept-version:42\n"
+        "host:host.com\n"
+        "\n"
+        "Frame body\0"s
+    };
+    StompError error;
+    StompFrame frame {error, plain};
+    BOOST_REQUIRE(error == StompError::kOk);
+    BOOST_CHECK_EQUAL(plain, std::move(frame).ToString());
+}
+
+BOOST_AUTO_TEST_CASE(take_body)
+{
+    // Content after the NULL octet must not end up in the body.
+    StompError error;
+    auto plain {
+        "SEND\n"
+        "destination:/quiet-route\n"
+        "content-length:10\n"
+        "\n"
+        "Frame\0body\0\n\n"s
+    };
+    const auto* data {plain.data()};
+    StompFrame frame {error, std::move(plain)};
+    BOOST_REQUIRE(error == StompError::kOk);
+    auto body {std::move(frame).TakeBody()};
+    BOOST_CHECK_EQUAL(body, "Frame\0body"s);
+    BOOST_CHECK(body.data() == data);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kInvalid);
+    BOOST_CHECK_EQUAL(frame.GetBody(), "");
+}
+
+BOOST_AUTO_TEST_CASE(move_short_frame)
+{
+    // Short enough to fit in the inline buffer of a std::string.
+    StompError error;
+    StompFrame frame {error, "ACK\nid:42\n\nb\0"s};
+    BOOST_REQUIRE(error == StompError::kOk);
+    StompFrame moved {std::move(frame)};
+    BOOST_CHECK_EQUAL(moved.GetCommand(), StompCommand::kAck);
+    BOOST_CHECK_EQUAL(moved.GetHeaderValue(StompHeader::kId), "42");
+    BOOST_CHECK_EQUAL(moved.GetBody(), "b");
+    StompFrame assigned {};
+    assigned = std::move(moved);
+    BOOST_CHECK_EQUAL(assigned.GetHeaderValue(StompHeader::kId), "42");
+    BOOST_CHECK_EQUAL(assigned.GetBody(), "b");
+}
+
+BOOST_AUTO_TEST_CASE(copy_outlives_original)
+{
+    const auto plain {
+        "MESSAGE\n"
+        "destination:/passengers\n"
+        "message-id:42\n"
+        "subscription:43\n"
+        "\n"
+        "Frame body\0"s
+    };
+    StompFrame copied {};
+    StompFrame assigned {};
+    {
+        StompError error;
+        StompFrame frame {error, plain};
+        BOOST_REQUIRE(error == StompError::kOk);
+        copied = StompFrame {frame};
+        assigned = frame;
+    }
+    for (const auto& frame: {copied, assigned}) {
+        BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kMessage);
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kMessageId), "42");
+        BOOST_CHECK_EQUAL(frame.GetBody(), "Frame body");
+        BOOST_CHECK_EQUAL(frame.AsString(), plain);
+
+        // The views point into the frame's own buffer.
+        const auto& buffer {frame.AsString()};
+        BOOST_CHECK(frame.GetBody().data() >= buffer.data());
+        BOOST_CHECK(frame.GetBody().data() < buffer.data() + buffer.size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(moved_from_frame_is_empty)
+{
+    StompError error;
+    StompFrame frame {error, "ACK\nid:42\n\nbody\0"s};
+    BOOST_REQUIRE(error == StompError::kOk);
+    StompFrame moved {std::move(frame)};
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kInvalid);
+    BOOST_CHECK(!frame.HasHeader(StompHeader::kId));
+    BOOST_CHECK_EQUAL(frame.GetBody(), "");
+    BOOST_CHECK_EQUAL(moved.GetBody(), "body");
+}
+
+BOOST_AUTO_TEST_CASE(shared_frame)
+{
+    StompError error;
+    StompFrame frame {error, "ACK\nid:42\n\nbody\0"s};
+    BOOST_REQUIRE(error == StompError::kOk);
+    const auto* buffer {frame.AsString().data()};
+    SharedStompFrame shared {MakeSharedStompFrame(std::move(frame))};
+    auto copy {shared};
+    BOOST_CHECK_EQUAL(shared.use_count(), 2);
+    BOOST_CHECK_EQUAL(copy->GetHeaderValue(StompHeader::kId), "42");
+    BOOST_CHECK_EQUAL(copy->GetBody(), "body");
+
+    // No copy of the frame string, unless it was short enough to live in the
+    // string object itself.
+    if (copy->AsString().capacity() > 15) {
+        BOOST_CHECK(copy->AsString().data() == buffer);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // class_StompFrame
 
+BOOST_AUTO_TEST_SUITE(class_StompFrameBuilder);
+
+BOOST_AUTO_TEST_CASE(build)
+{
+    const std::string body {"{\"key\": 42}"};
+    StompError error;
+    auto frame {StompFrameBuilder {StompCommand::kSend}
+        .AddHeader(StompHeader::kId, "request-id")
+        .AddHeader(StompHeader::kDestination, "/quiet-route")
+        .AddHeader(StompHeader::kContentType, "application/json")
+        .AddHeader(StompHeader::kContentLength, body.size())
+        .SetBody(body)
+        .Build(error)
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kSend);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kId), "request-id");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kDestination),
+                      "/quiet-route");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kContentType),
+                      "application/json");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kContentLength),
+                      "11");
+    BOOST_CHECK_EQUAL(frame.GetBody(), body);
+
+    // The headers are written in order, and the frame parses back to the
+    // same content.
+    const std::string expected {
+        "SEND\n"
+        "id:request-id\n"
+        "destination:/quiet-route\n"
+        "content-type:application/json\n"
+        "content-length:11\n"
+        "\n"
+        "{\"key\": 42}\0"s
+    };
+    BOOST_CHECK_EQUAL(frame.ToString(), expected);
+    StompFrame parsed {error, frame.ToString()};
+    BOOST_CHECK_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(parsed.GetBody(), body);
+}
+
+BOOST_AUTO_TEST_CASE(build_short_frame)
+{
+    StompError error;
+    auto frame {StompFrameBuilder {StompCommand::kDisconnect}.Build(error)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kDisconnect);
+    BOOST_CHECK_EQUAL(frame.GetBody(), "");
+    BOOST_CHECK_EQUAL(frame.ToString(), "DISCONNECT\n\n\0"s);
+}
+
+BOOST_AUTO_TEST_CASE(build_repeated_header)
+{
+    StompError error;
+    auto frame {StompFrameBuilder {StompCommand::kAck}
+        .AddHeader(StompHeader::kId, "42")
+        .AddHeader(StompHeader::kId, "43")
+        .Build(error)
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kId), "42");
+    BOOST_CHECK_EQUAL(frame.ToString(), "ACK\nid:42\n\n\0"s);
+}
+
+BOOST_AUTO_TEST_CASE(build_errors)
+{
+    StompError error;
+    auto frame {StompFrameBuilder {StompCommand::kInvalid}.Build(error)};
+    BOOST_CHECK_EQUAL(error, StompError::kValidationInvalidCommand);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kInvalid);
+
+    frame = StompFrameBuilder {StompCommand::kAck}
+        .AddHeader(StompHeader::kId, "")
+        .Build(error);
+    BOOST_CHECK_EQUAL(error, StompError::kParsingEmptyHeaderValue);
+
+    frame = StompFrameBuilder {StompCommand::kAck}
+        .AddHeader(StompHeader::kId, "4\n2")
+        .Build(error);
+    BOOST_CHECK_EQUAL(error, StompError::kParsingMissingColonInHeader);
+
+    frame = StompFrameBuilder {StompCommand::kAck}
+        .AddHeader(StompHeader::kInvalid, "42")
+        .Build(error);
+    BOOST_CHECK_EQUAL(error, StompError::kParsingUnrecognizedHeader);
+
+    frame = StompFrameBuilder {StompCommand::kAck}.Build(error);
+    BOOST_CHECK_EQUAL(error, StompError::kValidationMissingHeader);
+
+    frame = StompFrameBuilder {StompCommand::kAck}
+        .AddHeader(StompHeader::kId, "42")
+        .AddHeader(StompHeader::kContentLength, size_t {3})
+        .SetBody("body")
+        .Build(error);
+    BOOST_CHECK_EQUAL(error, StompError::kValidationContentLengthMismatch);
+
+    frame = StompFrameBuilder {StompCommand::kAck}
+        .AddHeader(StompHeader::kId, "42")
+        .SetBody("bo\0dy"s)
+        .Build(error);
+    BOOST_CHECK_EQUAL(error, StompError::kParsingJunkAfterBody);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kInvalid);
+}
+
+BOOST_AUTO_TEST_CASE(build_null_in_body_content_length)
+{
+    const auto body {"bo\0dy"s};
+    StompError error;
+    auto frame {StompFrameBuilder {StompCommand::kAck}
+        .AddHeader(StompHeader::kId, "42")
+        .AddHeader(StompHeader::kContentLength, body.size())
+        .SetBody(body)
+        .Build(error)
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetBody(), body);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompFrameBuilder
+
+BOOST_AUTO_TEST_SUITE(class_StompFrameTemplate);
+
+BOOST_AUTO_TEST_CASE(render)
+{
+    StompError error;
+    StompFrameTemplate sendTemplate {
+        error,
+        StompCommand::kSend,
+        {
+            {StompHeader::kContentType, "application/json"},
+        },
+        {
+            StompHeader::kId,
+            StompHeader::kDestination,
+            StompHeader::kContentLength,
+        }
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+
+    // The template must write the same frame as the builder.
+    const std::string body {"{\"key\": 42}"};
+    for (const auto& id: {"1", "a-longer-request-id"}) {
+        auto frame {sendTemplate.Render(error, {id, "/quiet-route"}, body)};
+        BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+        auto expected {StompFrameBuilder {StompCommand::kSend}
+            .AddHeader(StompHeader::kContentType, "application/json")
+            .AddHeader(StompHeader::kId, id)
+            .AddHeader(StompHeader::kDestination, "/quiet-route")
+            .AddHeader(StompHeader::kContentLength, body.size())
+            .SetBody(body)
+            .Build(error)
+        };
+        BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+        BOOST_CHECK_EQUAL(frame.ToString(), expected.ToString());
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kId), id);
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kDestination),
+                          "/quiet-route");
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kContentType),
+                          "application/json");
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kContentLength),
+                          "11");
+        BOOST_CHECK_EQUAL(frame.GetBody(), body);
+
+        // The result must parse to the same frame.
+        StompFrame parsed {error, frame.ToString()};
+        BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+        BOOST_CHECK_EQUAL(parsed.GetHeaderValue(StompHeader::kId), id);
+        BOOST_CHECK_EQUAL(parsed.GetBody(), body);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(render_constant_frame)
+{
+    StompError error;
+    StompFrameTemplate connectedTemplate {
+        error,
+        StompCommand::kConnected,
+        {
+            {StompHeader::kVersion, "1.2"},
+        }
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    auto frame {connectedTemplate.Render(error)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.ToString(), "CONNECTED\nversion:1.2\n\n\0"s);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kVersion), "1.2");
+}
+
+BOOST_AUTO_TEST_CASE(render_null_in_body_content_length)
+{
+    StompError error;
+    StompFrameTemplate ackTemplate {
+        error,
+        StompCommand::kAck,
+        {},
+        {StompHeader::kId, StompHeader::kContentLength}
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    const auto body {"bo\0dy"s};
+    auto frame {ackTemplate.Render(error, {"42"}, body)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetBody(), body);
+}
+
+BOOST_AUTO_TEST_CASE(template_errors)
+{
+    StompError error;
+    StompFrameTemplate invalidCommand {
+        error,
+        StompCommand::kInvalid,
+        {}
+    };
+    BOOST_CHECK_EQUAL(error, StompError::kValidationInvalidCommand);
+    auto frame {invalidCommand.Render(error)};
+    BOOST_CHECK_EQUAL(error, StompError::kValidationInvalidCommand);
+
+    StompFrameTemplate emptyValue {
+        error,
+        StompCommand::kAck,
+        {
+            {StompHeader::kId, ""},
+        }
+    };
+    BOOST_CHECK_EQUAL(error, StompError::kParsingEmptyHeaderValue);
+
+    StompFrameTemplate invalidHeader {
+        error,
+        StompCommand::kAck,
+        {},
+        {StompHeader::kInvalid}
+    };
+    BOOST_CHECK_EQUAL(error, StompError::kParsingUnrecognizedHeader);
+
+    StompFrameTemplate invalidFrame {};
+    frame = invalidFrame.Render(error);
+    BOOST_CHECK_EQUAL(error, StompError::kValidationInvalidCommand);
+}
+
+BOOST_AUTO_TEST_CASE(render_errors)
+{
+    StompError error;
+    StompFrameTemplate ackTemplate {
+        error,
+        StompCommand::kAck,
+        {},
+        {StompHeader::kId}
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+
+    auto frame {ackTemplate.Render(error)};
+    BOOST_CHECK_EQUAL(error, StompError::kValidationMissingHeader);
+
+    frame = ackTemplate.Render(error, {""});
+    BOOST_CHECK_EQUAL(error, StompError::kParsingEmptyHeaderValue);
+
+    frame = ackTemplate.Render(error, {"4\n2"});
+    BOOST_CHECK_EQUAL(error, StompError::kParsingMissingColonInHeader);
+
+    frame = ackTemplate.Render(error, {"42"}, "bo\0dy"s);
+    BOOST_CHECK_EQUAL(error, StompError::kParsingJunkAfterBody);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kInvalid);
+
+    StompFrameTemplate sendTemplate {
+        error,
+        StompCommand::kSend,
+        {},
+        {StompHeader::kId}
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    frame = sendTemplate.Render(error, {"42"});
+    BOOST_CHECK_EQUAL(error, StompError::kValidationMissingHeader);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompFrameTemplate
+
 BOOST_AUTO_TEST_SUITE_END(); // stomp_frame
 
 BOOST_AUTO_TEST_SUITE_END(); // network_monitor
\ No newline at end of file
@@ -31,6 +31,7 @@ using NetworkMonitor::StompClientError;
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompHeader;
 using NetworkMonitor::StompServer;
 using NetworkMonitor::StompServerError;
 
@@ -81,6 +82,16 @@ BOOST_AUTO_TEST_CASE(ostream)
     }
 }
 
+BOOST_AUTO_TEST_CASE(formatter)
+{
+    BOOST_CHECK_EQUAL(
+        fmt::format("{}", StompServerError::kWebSocketServerDisconnected),
+        "WebSocketServerDisconnected"
+    );
+    BOOST_CHECK_EQUAL(fmt::format("{}", static_cast<StompServerError>(1000)),
+                      "UndefinedError");
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // enum_class_StompServerError
 
 BOOST_FIXTURE_TEST_SUITE(class_StompServer, StompServerTestFixture);
@@ -297,7 +308,7 @@ BOOST_AUTO_TEST_CASE(run_connection_disconnect, *timeout {1})
     auto onClientConnect = [](auto, auto) {
         BOOST_CHECK(false);
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     auto onClientDisconnect = [](auto, auto) {
@@ -373,7 +384,7 @@ BOOST_AUTO_TEST_CASE(run_connection_stomp, *timeout {1})
         // This test assumes that Stop works.
         server.Stop();
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     auto onClientDisconnect = [](auto, auto) {
@@ -439,7 +450,7 @@ BOOST_AUTO_TEST_CASE(run_connection_stomp_disconnect, *timeout {1})
         BOOST_CHECK(id.size() > 0);
         clientDidConnect = true;
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     bool clientDidDisconnect {false};
@@ -513,7 +524,7 @@ BOOST_AUTO_TEST_CASE(run_disconnect_server, *timeout {1})
         // Trigger the server disconnection.
         MockWebSocketServerForStomp::triggerDisconnection = true;
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     auto onClientDisconnect = [](auto, auto) {
@@ -594,12 +605,15 @@ BOOST_AUTO_TEST_CASE(on_client_message, *timeout {1})
         &destination,
         &message,
         &server
-    ](auto ec, auto id, auto dst, auto reqId, auto&& msg) {
+    ](auto ec, auto id, auto&& frame) {
         BOOST_CHECK_EQUAL(ec, StompServerError::kOk);
         BOOST_CHECK(id.size() > 0);
-        BOOST_CHECK_EQUAL(dst, destination);
-        BOOST_CHECK_EQUAL(reqId, "msg0");
-        BOOST_CHECK_EQUAL(msg, message.dump());
+        BOOST_CHECK_EQUAL(
+            frame.GetHeaderValue(StompHeader::kDestination),
+            destination
+        );
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kId), "msg0");
+        BOOST_CHECK_EQUAL(frame.GetBody(), message.dump());
         messageReceived = true;
 
         // This test assumes that Stop works.
@@ -666,7 +680,7 @@ BOOST_AUTO_TEST_CASE(on_client_message_before_connect, *timeout {1})
     auto onClientConnect = [](auto, auto) {
         BOOST_CHECK(false);
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         // We are especially interested in not receiving this callback since
         // the client is only connected through WebSockets and not STOMP.
         BOOST_CHECK(false);
@@ -765,7 +779,7 @@ BOOST_AUTO_TEST_CASE(send, *timeout {1})
         auto reqId {server.Send(id, destination, message.dump(), onSend)};
         BOOST_CHECK(reqId.size() > 0);
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     auto onClientDisconnect = [](auto, auto) {
@@ -858,7 +872,7 @@ BOOST_AUTO_TEST_CASE(send_custom_req_id, *timeout {1})
         BOOST_REQUIRE(reqId.size() > 0);
         BOOST_CHECK_EQUAL(reqId, customReqId);
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     auto onClientDisconnect = [](auto ec, auto id) {
@@ -945,7 +959,7 @@ BOOST_AUTO_TEST_CASE(send_fail, *timeout {1})
         auto reqId {server.Send(id, destination, message.dump(), onSend)};
         BOOST_CHECK(reqId.size() > 0);
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     auto onClientDisconnect = [](auto, auto) {
@@ -1023,7 +1037,7 @@ BOOST_AUTO_TEST_CASE(send_disconnected_connection, *timeout {1})
         BOOST_CHECK(id.size() > 0);
         clientDidConnect = true;
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     bool clientDidDisconnect {false};
@@ -1120,7 +1134,7 @@ BOOST_AUTO_TEST_CASE(close, *timeout {1})
         connectionId = id;
         server.Close(id, onClientClose);
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     auto onClientDisconnect = [](auto, auto) {
@@ -1216,7 +1230,7 @@ BOOST_AUTO_TEST_CASE(close_then_send, *timeout {1})
         connectionId = id;
         server.Close(id, onClientClose);
     };
-    auto onClientMessage = [](auto, auto, auto, auto, auto&&) {
+    auto onClientMessage = [](auto, auto, auto&&) {
         BOOST_CHECK(false);
     };
     auto onClientDisconnect = [](auto, auto) {
@@ -1329,10 +1343,10 @@ BOOST_AUTO_TEST_CASE(three_connections, *timeout {1})
     auto onClientMessage = [
         &receivedMessages,
         &message
-    ](auto ec, auto id, auto dst, auto reqId, auto&& msg) {
+    ](auto ec, auto id, auto&& frame) {
         BOOST_CHECK_EQUAL(ec, StompServerError::kOk);
         BOOST_CHECK(id.size() > 0);
-        BOOST_CHECK_EQUAL(msg, message.dump());
+        BOOST_CHECK_EQUAL(frame.GetBody(), message.dump());
         ++receivedMessages;
     };
     size_t disconnectedClients {0};
@@ -1401,7 +1415,7 @@ BOOST_AUTO_TEST_CASE(connect, *timeout {2})
             }
         };
         auto onClientMessage {
-            [](auto ec, auto id, auto dst, auto reqId, auto&& msg) {
+            [](auto ec, auto id, auto&& frame) {
                 BOOST_CHECK(false);
             }
         };
@@ -1436,7 +1450,7 @@ BOOST_AUTO_TEST_CASE(connect, *timeout {2})
             BOOST_CHECK_EQUAL(ec, StompClientError::kOk);
             clientDidConnect = true;
         }};
-        auto onMessage {[](auto, auto&&, auto&&) {
+        auto onMessage {[](auto, auto&&) {
             BOOST_CHECK(false);
         }};
         auto onDisconnect {[&clientDidDisconnect](auto ec) {
@@ -1494,9 +1508,9 @@ BOOST_AUTO_TEST_CASE(exchange_messages, *timeout {2})
                 &message,
                 &serverReceivedMsg,
                 &server
-            ](auto ec, auto id, auto dst, auto reqId, auto&& msg) {
+            ](auto ec, auto id, auto&& frame) {
                 BOOST_CHECK_EQUAL(ec, StompServerError::kOk);
-                BOOST_CHECK_EQUAL(msg, message.dump());
+                BOOST_CHECK_EQUAL(frame.GetBody(), message.dump());
                 serverReceivedMsg = true;
 
                 // Reply to the client.
@@ -1553,10 +1567,13 @@ BOOST_AUTO_TEST_CASE(exchange_messages, *timeout {2})
             &destination,
             &message,
             &clientReceivedMsg
-        ](auto ec, auto&& dst, auto&& msg) {
+        ](auto ec, auto&& frame) {
             BOOST_REQUIRE_EQUAL(ec, StompClientError::kOk);
-            BOOST_CHECK_EQUAL(dst, destination);
-            BOOST_CHECK_EQUAL(msg, message.dump());
+            BOOST_CHECK_EQUAL(
+                frame.GetHeaderValue(StompHeader::kDestination),
+                destination
+            );
+            BOOST_CHECK_EQUAL(frame.GetBody(), message.dump());
             clientReceivedMsg = true;
         }};
         auto onDisconnect {[&clientDidDisconnect](auto ec) {
@@ -1617,9 +1634,9 @@ BOOST_AUTO_TEST_CASE(three_connections, *timeout {2})
         [
             &message,
             &receivedMessages
-        ](auto ec, auto id, auto dst, auto reqId, auto&& msg) {
+        ](auto ec, auto id, auto&& frame) {
             BOOST_CHECK_EQUAL(ec, StompServerError::kOk);
-            BOOST_CHECK_EQUAL(msg, message.dump());
+            BOOST_CHECK_EQUAL(frame.GetBody(), message.dump());
             ++receivedMessages;
         }
     };
@@ -1669,7 +1686,7 @@ BOOST_AUTO_TEST_CASE(three_connections, *timeout {2})
             client->Send(destination, message.dump());
             client->Close();
         }};
-        auto onMessage {[](auto, auto&&, auto&&) {
+        auto onMessage {[](auto, auto&&) {
             BOOST_CHECK(false);
         }};
         auto onDisconnect {[](auto ec) {
@@ -107,17 +107,17 @@ int main()
         &client,
         &quietRoute,
         onClose
-    ](auto ec, auto dst, auto&& msg) {
+    ](auto ec, auto&& frame) {
         CheckEqual(ec, StompClientError::kOk);
         clientDidReceiveResp = true;
         spdlog::info("TestStompClient: Received /quiet-route response");
         try {
-            quietRoute = nlohmann::json::parse(msg);
+            quietRoute = nlohmann::json::parse(frame.GetBody());
         } catch (const std::exception& e) {
             spdlog::error("TestStompClient: Failed to parse response: {}",
                           e.what());
             spdlog::error("TestStompClient: Response content:\n{}",
-                          nlohmann::json::parse(msg));
+                          nlohmann::json::parse(frame.GetBody()));
             Check(false);
         }
         spdlog::info("TestStompClient: Closing the client connection");
@@ -7,16 +7,22 @@
 #include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 using NetworkMonitor::Id;
 using NetworkMonitor::Line;
+using NetworkMonitor::NetworkLayoutChanges;
+using NetworkMonitor::NetworkLayoutDelta;
 using NetworkMonitor::ParseJsonFile;
 using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerEventRecord;
 using NetworkMonitor::Route;
 using NetworkMonitor::Station;
+using NetworkMonitor::StationHandle;
 using NetworkMonitor::TransportNetwork;
 using NetworkMonitor::TravelRoute;
 
@@ -59,6 +65,49 @@ BOOST_AUTO_TEST_CASE(duplicate_id)
     BOOST_CHECK(!ok);
 }
 
+BOOST_AUTO_TEST_CASE(station_handles)
+{
+    TransportNetwork nw {};
+    bool ok {false};
+
+    // Handles are assigned densely, in insertion order.
+    Station station0 {
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1 {
+        "station_001",
+        "Station Name 1",
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetNStations(), 2);
+    BOOST_CHECK_EQUAL(nw.GetStationHandle(station0.id), 0);
+    BOOST_CHECK_EQUAL(nw.GetStationHandle(station1.id), 1);
+    BOOST_CHECK_THROW(nw.GetStationHandle("station_002"), std::runtime_error);
+    BOOST_CHECK_EQUAL(nw.FindStationHandle(station1.id), 1);
+    BOOST_CHECK_EQUAL(nw.FindStationHandle("station_002"),
+                      NetworkMonitor::kInvalidStationHandle);
+
+    // Record events by handle.
+    using EventType = PassengerEvent::Type;
+    BOOST_CHECK(nw.RecordPassengerEvent(
+        PassengerEventRecord {1, EventType::In, 0}
+    ));
+    BOOST_CHECK(nw.RecordPassengerEvent(
+        PassengerEventRecord {1, EventType::In, 0}
+    ));
+    BOOST_CHECK(!nw.RecordPassengerEvent(
+        PassengerEventRecord {2, EventType::In, 0}
+    ));
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station1.id), 2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(StationHandle {1}), 2);
+    BOOST_CHECK_THROW(nw.GetPassengerCount(StationHandle {2}),
+                      std::runtime_error);
+}
+
 BOOST_AUTO_TEST_CASE(duplicate_name)
 {
     TransportNetwork nw {};
@@ -293,6 +342,193 @@ BOOST_AUTO_TEST_CASE(basic)
     BOOST_CHECK_EQUAL(nw.GetPassengerCount(station2.id), -1);
 }
 
+BOOST_AUTO_TEST_CASE(route_and_line_aggregates)
+{
+    TransportNetwork nw {};
+    bool ok {false};
+
+    // Define a line with 2 routes going through some shared stations, and a
+    // second line with 1 route.
+    // line0/route0: 0 ---> 1 ---> 2
+    // line0/route1: 3 ---> 1 ---> 2
+    // line1/route2: 2 ---> 4
+    Station station0 {"station_000", "Station Name 0"};
+    Station station1 {"station_001", "Station Name 1"};
+    Station station2 {"station_002", "Station Name 2"};
+    Station station3 {"station_003", "Station Name 3"};
+    Station station4 {"station_004", "Station Name 4"};
+    Route route0 {
+        "route_000",
+        "inbound",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    Route route1 {
+        "route_001",
+        "inbound",
+        "line_000",
+        "station_003",
+        "station_002",
+        {"station_003", "station_001", "station_002"},
+    };
+    Route route2 {
+        "route_002",
+        "inbound",
+        "line_001",
+        "station_002",
+        "station_004",
+        {"station_002", "station_004"},
+    };
+    Line line0 {"line_000", "Line Name 0", {route0, route1}};
+    Line line1 {"line_001", "Line Name 1", {route2}};
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    ok &= nw.AddStation(station2);
+    ok &= nw.AddStation(station3);
+    ok &= nw.AddStation(station4);
+    BOOST_REQUIRE(ok);
+
+    // Passengers recorded before a line is added still count towards it.
+    using EventType = PassengerEvent::Type;
+    ok = nw.RecordPassengerEvent({station4.id, EventType::In});
+    BOOST_REQUIRE(ok);
+    ok = true;
+    ok &= nw.AddLine(line0);
+    ok &= nw.AddLine(line1);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line0.id, route0.id), 0);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line0.id, route1.id), 0);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line1.id, route2.id), 1);
+    BOOST_CHECK_EQUAL(nw.GetLinePassengerCount(line0.id), 0);
+    BOOST_CHECK_EQUAL(nw.GetLinePassengerCount(line1.id), 1);
+
+    // A shared station updates all the routes serving it, but only counts once
+    // towards its line.
+    ok = nw.RecordPassengerEvent({station1.id, EventType::In});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line0.id, route0.id), 1);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line0.id, route1.id), 1);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line1.id, route2.id), 1);
+    BOOST_CHECK_EQUAL(nw.GetLinePassengerCount(line0.id), 1);
+    BOOST_CHECK_EQUAL(nw.GetLinePassengerCount(line1.id), 1);
+
+    // The end station of a route has no departing edge for it, but it still
+    // counts towards the route.
+    ok = nw.RecordPassengerEvent({station2.id, EventType::In});
+    BOOST_REQUIRE(ok);
+    ok = nw.RecordPassengerEvent({station2.id, EventType::In});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line0.id, route0.id), 3);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line0.id, route1.id), 3);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line1.id, route2.id), 3);
+    BOOST_CHECK_EQUAL(nw.GetLinePassengerCount(line0.id), 3);
+    BOOST_CHECK_EQUAL(nw.GetLinePassengerCount(line1.id), 3);
+
+    ok = nw.RecordPassengerEvent({station3.id, EventType::Out});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line0.id, route0.id), 3);
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount(line0.id, route1.id), 2);
+    BOOST_CHECK_EQUAL(nw.GetLinePassengerCount(line0.id), 2);
+
+    // Unknown lines and routes throw.
+    BOOST_CHECK_THROW(nw.GetRoutePassengerCount(line0.id, route2.id),
+                      std::runtime_error);
+    BOOST_CHECK_THROW(nw.GetLinePassengerCount("line_42"),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(most_crowded_stations)
+{
+    TransportNetwork nw {};
+    bool ok {false};
+
+    // We only need stations to rank them.
+    std::vector<Id> stationIds {};
+    for (size_t idx {0}; idx < 50; ++idx) {
+        auto id {"station_" + std::to_string(idx)};
+        ok = nw.AddStation({id, "Station Name"});
+        BOOST_REQUIRE(ok);
+        stationIds.push_back(id);
+    }
+
+    // Ties are broken by insertion order.
+    auto stations {nw.GetMostCrowdedStations(3)};
+    BOOST_REQUIRE_EQUAL(stations.size(), 3);
+    BOOST_CHECK_EQUAL(stations[0].stationId, "station_0");
+    BOOST_CHECK_EQUAL(stations[1].stationId, "station_1");
+    BOOST_CHECK_EQUAL(stations[2].stationId, "station_2");
+    BOOST_CHECK_EQUAL(nw.GetMostCrowdedStations(0).size(), 0);
+    BOOST_CHECK_EQUAL(nw.GetMostCrowdedStations(100).size(), 50);
+
+    // Give station N a passenger count of (N % 7) - 2, then compare the
+    // incremental ranking with a full sort.
+    using EventType = PassengerEvent::Type;
+    std::vector<std::pair<long long int, size_t>> expected {};
+    for (size_t idx {0}; idx < stationIds.size(); ++idx) {
+        long long int count {static_cast<long long int>(idx % 7) - 2};
+        // Go up and down a few times to exercise both heap directions.
+        for (size_t _ {0}; _ < 3; ++_) {
+            ok &= nw.RecordPassengerEvent({stationIds[idx], EventType::In});
+        }
+        for (size_t _ {0}; _ < 3; ++_) {
+            ok &= nw.RecordPassengerEvent({stationIds[idx], EventType::Out});
+        }
+        auto type {count > 0 ? EventType::In : EventType::Out};
+        for (long long int _ {0}; _ < std::abs(count); ++_) {
+            ok &= nw.RecordPassengerEvent({stationIds[idx], type});
+        }
+        expected.push_back({-count, idx});
+    }
+    BOOST_REQUIRE(ok);
+    std::sort(expected.begin(), expected.end());
+    stations = nw.GetMostCrowdedStations(20);
+    BOOST_REQUIRE_EQUAL(stations.size(), 20);
+    for (size_t idx {0}; idx < stations.size(); ++idx) {
+        BOOST_CHECK_EQUAL(stations[idx].stationId,
+                          stationIds[expected[idx].second]);
+        BOOST_CHECK_EQUAL(stations[idx].passengerCount,
+                          -expected[idx].first);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(passenger_counts_snapshot)
+{
+    auto testFilePath {
+        std::filesystem::path(TEST_DATA) / "from_json_1line_1route.json"
+    };
+    auto src = ParseJsonFile(testFilePath);
+    TransportNetwork nw {};
+    BOOST_REQUIRE(nw.FromJson(std::move(src)));
+    nw.SetNetworkCrowding({{"station_0", 2}, {"station_1", -1}});
+
+    // Save the counts, then restore them in a network with the same layout.
+    auto counts {nw.GetPassengerCounts()};
+    BOOST_REQUIRE_EQUAL(counts.size(), 2);
+    BOOST_CHECK_EQUAL(counts[nw.GetStationHandle("station_0")], 2);
+    BOOST_CHECK_EQUAL(counts[nw.GetStationHandle("station_1")], -1);
+
+    TransportNetwork other {};
+    BOOST_REQUIRE(other.FromJson(ParseJsonFile(testFilePath)));
+    BOOST_CHECK_EQUAL(other.GetLayoutHash(), nw.GetLayoutHash());
+    BOOST_REQUIRE(other.SetPassengerCounts(counts));
+    BOOST_CHECK_EQUAL(other.GetPassengerCount("station_0"), 2);
+    BOOST_CHECK_EQUAL(other.GetPassengerCount("station_1"), -1);
+    BOOST_CHECK_EQUAL(other.GetLinePassengerCount("line_0"), 1);
+    BOOST_CHECK_EQUAL(other.GetMostCrowdedStations(1)[0].stationId,
+                      "station_0");
+
+    // Vectors of the wrong size are rejected.
+    BOOST_CHECK(!other.SetPassengerCounts({1, 2, 3}));
+    BOOST_CHECK_EQUAL(other.GetPassengerCount("station_0"), 2);
+
+    // A different layout has a different hash.
+    TransportNetwork empty {};
+    BOOST_CHECK_NE(empty.GetLayoutHash(), nw.GetLayoutHash());
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // PassengerEvents
 
 BOOST_AUTO_TEST_SUITE(GetRoutesServingStation);
@@ -678,6 +914,334 @@ BOOST_AUTO_TEST_CASE(fail_on_bad_travel_times)
 
 BOOST_AUTO_TEST_SUITE_END(); // FromJson
 
+BOOST_AUTO_TEST_SUITE(FromJsonStream);
+
+BOOST_AUTO_TEST_CASE(from_json_travel_times)
+{
+    std::ifstream file {
+        std::filesystem::path(TEST_DATA) / "from_json_travel_times.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJsonStream(file)};
+    BOOST_REQUIRE(ok);
+
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_1"), 1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_1", "station_0"), 1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_1", "station_2"), 2);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_0", "route_0", "station_0", "station_2"), 1 + 2
+    );
+}
+
+BOOST_AUTO_TEST_CASE(same_as_from_json)
+{
+    // The test layout has its lines before its stations.
+    TransportNetwork expected {};
+    BOOST_REQUIRE(expected.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON)));
+    std::ifstream file {TESTS_NETWORK_LAYOUT_JSON};
+    TransportNetwork nw {};
+    BOOST_REQUIRE(nw.FromJsonStream(file));
+
+    BOOST_CHECK_EQUAL(nw.GetNStations(), expected.GetNStations());
+    BOOST_CHECK_EQUAL(nw.GetLayoutHash(), expected.GetLayoutHash());
+    auto routes {nw.GetRoutesServingStation("station_000")};
+    auto expectedRoutes {expected.GetRoutesServingStation("station_000")};
+    std::sort(routes.begin(), routes.end());
+    std::sort(expectedRoutes.begin(), expectedRoutes.end());
+    BOOST_CHECK(routes == expectedRoutes);
+    auto route {nw.GetFastestTravelRoute("station_000", "station_100")};
+    auto expectedRoute {
+        expected.GetFastestTravelRoute("station_000", "station_100")
+    };
+    BOOST_CHECK_EQUAL(route.totalTravelTime, expectedRoute.totalTravelTime);
+}
+
+BOOST_AUTO_TEST_CASE(sections_in_any_order)
+{
+    // Travel times first, then lines, then stations. Unknown keys are skipped.
+    std::stringstream src {R"({
+        "travel_times": [
+            {"start_station_id": "station_0", "end_station_id": "station_1",
+             "travel_time": 3}
+        ],
+        "version": {"major": 1, "tags": ["a", {"b": null}]},
+        "lines": [
+            {
+                "line_id": "line_0",
+                "name": "Line 0",
+                "routes": [
+                    {
+                        "route_id": "route_0",
+                        "direction": "inbound",
+                        "line_id": "line_0",
+                        "start_station_id": "station_0",
+                        "end_station_id": "station_1",
+                        "route_stops": ["station_0", "station_1"],
+                        "travel_time": 100
+                    }
+                ]
+            }
+        ],
+        "stations": [
+            {"station_id": "station_0", "name": "Station 0", "zone": 1},
+            {"station_id": "station_1", "name": "Station 1"}
+        ]
+    })"};
+    TransportNetwork nw {};
+    BOOST_REQUIRE(nw.FromJsonStream(src));
+    BOOST_CHECK_EQUAL(nw.GetNStations(), 2);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_1"), 3);
+    auto routes {nw.GetRoutesServingStation("station_1")};
+    BOOST_REQUIRE_EQUAL(routes.size(), 1);
+    BOOST_CHECK_EQUAL(routes[0], "route_0");
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_bad_json)
+{
+    std::stringstream src {R"({"lines": [], "travel_times": [])"};
+    TransportNetwork nw {};
+    BOOST_CHECK_THROW(nw.FromJsonStream(src), nlohmann::json::parse_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_missing_section)
+{
+    // Missing "stations"!
+    std::stringstream src {R"({"lines": [], "travel_times": []})"};
+    TransportNetwork nw {};
+    BOOST_CHECK_THROW(nw.FromJsonStream(src), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_incomplete_item)
+{
+    // Missing station name!
+    std::stringstream src {R"({
+        "stations": [{"station_id": "station_0"}],
+        "lines": [],
+        "travel_times": []
+    })"};
+    TransportNetwork nw {};
+    BOOST_CHECK_THROW(nw.FromJsonStream(src), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_good_json_bad_items)
+{
+    std::stringstream src {R"({
+        "stations": [
+            {"station_id": "station_0", "name": "Station 0 Name"},
+            {"station_id": "station_0", "name": "Station 0 Name"}
+        ],
+        "lines": [],
+        "travel_times": []
+    })"};
+    TransportNetwork nw {};
+    BOOST_CHECK_THROW(nw.FromJsonStream(src), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_bad_travel_times)
+{
+    std::ifstream file {
+        std::filesystem::path(TEST_DATA) / "from_json_bad_travel_times.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJsonStream(file)};
+    BOOST_REQUIRE(!ok);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // FromJsonStream
+
+BOOST_AUTO_TEST_SUITE(ApplyDelta);
+
+// 3 stations on 1 route: station_0 -(1)- station_1 -(2)- station_2
+static TransportNetwork GetDeltaTestNetwork()
+{
+    TransportNetwork nw {};
+    BOOST_REQUIRE(nw.FromJson(ParseJsonFile(
+        std::filesystem::path(TEST_DATA) / "from_json_travel_times.json"
+    )));
+    return nw;
+}
+
+BOOST_AUTO_TEST_CASE(travel_times)
+{
+    auto nw {GetDeltaTestNetwork()};
+    NetworkLayoutDelta delta {};
+    delta.travelTimes = {
+        {"station_1", "station_0", 5},
+        {"station_1", "station_2", 2}, // Unchanged
+    };
+    NetworkLayoutChanges changes {};
+    BOOST_REQUIRE(nw.ApplyDelta(delta, changes));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_1"), 5);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_1", "station_2"), 2);
+    BOOST_CHECK(changes.stations == std::vector<Id>({
+        "station_0", "station_1"
+    }));
+    BOOST_CHECK(changes.routes == std::vector<Id>({"route_0"}));
+    auto route {nw.GetFastestTravelRoute("station_0", "station_2")};
+    BOOST_CHECK_EQUAL(route.totalTravelTime, 5 + 2);
+}
+
+BOOST_AUTO_TEST_CASE(new_station_and_route)
+{
+    auto nw {GetDeltaTestNetwork()};
+    NetworkLayoutDelta delta {};
+    delta.addedStations = {{"station_3", "Station 3 Name"}};
+    delta.addedRoutes = {{
+        "route_1", "inbound", "line_0", "station_2", "station_3",
+        {"station_2", "station_3"},
+    }};
+    delta.travelTimes = {{"station_2", "station_3", 4}};
+    NetworkLayoutChanges changes {};
+    BOOST_REQUIRE(nw.ApplyDelta(delta, changes));
+    BOOST_CHECK_EQUAL(nw.GetNStations(), 4);
+    BOOST_CHECK_EQUAL(nw.GetStationHandle("station_3"), 3);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_2", "station_3"), 4);
+    BOOST_CHECK(changes.stations == std::vector<Id>({
+        "station_2", "station_3"
+    }));
+    BOOST_CHECK(changes.routes == std::vector<Id>({"route_1"}));
+
+    // The new route is part of the line and its crowding aggregates.
+    auto routes {nw.GetRoutesServingStation("station_3")};
+    BOOST_CHECK(routes == std::vector<Id>({"route_1"}));
+    BOOST_REQUIRE(nw.RecordPassengerEvent({"station_3",
+                                           PassengerEvent::Type::In}));
+    BOOST_CHECK_EQUAL(nw.GetRoutePassengerCount("line_0", "route_1"), 1);
+    BOOST_CHECK_EQUAL(nw.GetLinePassengerCount("line_0"), 1);
+    auto route {nw.GetFastestTravelRoute("station_0", "station_3")};
+    BOOST_REQUIRE_EQUAL(route.steps.size(), 3);
+    BOOST_CHECK_EQUAL(route.steps.back().routeId, "route_1");
+}
+
+BOOST_AUTO_TEST_CASE(new_line)
+{
+    auto nw {GetDeltaTestNetwork()};
+    NetworkLayoutDelta delta {};
+    delta.addedLines = {{
+        "line_1", "Line 1 Name", {{
+            "route_2", "inbound", "line_1", "station_2", "station_0",
+            {"station_2", "station_0"},
+        }},
+    }};
+    NetworkLayoutChanges changes {};
+    BOOST_REQUIRE(nw.ApplyDelta(delta, changes));
+    BOOST_CHECK(changes.stations == std::vector<Id>({
+        "station_0", "station_2"
+    }));
+    BOOST_CHECK(changes.routes == std::vector<Id>({"route_2"}));
+    auto route {nw.GetFastestTravelRoute("station_2", "station_0")};
+    BOOST_REQUIRE_EQUAL(route.steps.size(), 1);
+    BOOST_CHECK_EQUAL(route.steps[0].lineId, "line_1");
+}
+
+BOOST_AUTO_TEST_CASE(closed_stations)
+{
+    auto nw {GetDeltaTestNetwork()};
+    NetworkLayoutDelta delta {};
+    delta.closedStations = {"station_1"};
+    NetworkLayoutChanges changes {};
+    BOOST_REQUIRE(nw.ApplyDelta(delta, changes));
+    BOOST_CHECK(nw.IsStationClosed("station_1"));
+    BOOST_CHECK(!nw.IsStationClosed("station_0"));
+    BOOST_CHECK(changes.stations == std::vector<Id>({"station_1"}));
+    BOOST_CHECK(changes.routes == std::vector<Id>({"route_0"}));
+
+    // No path goes through, from, or to a closed station.
+    BOOST_CHECK(nw.GetFastestTravelRoute("station_0", "station_2").steps
+                .empty());
+    BOOST_CHECK(nw.GetFastestTravelRoute("station_1", "station_2").steps
+                .empty());
+    BOOST_CHECK(nw.GetQuietTravelRoute("station_0", "station_2", 0.1, 0.1)
+                .steps.empty());
+
+    // Closing a closed station changes nothing.
+    BOOST_REQUIRE(nw.ApplyDelta(delta, changes));
+    BOOST_CHECK(changes.stations.empty());
+    BOOST_CHECK(changes.routes.empty());
+
+    NetworkLayoutDelta reopen {};
+    reopen.reopenedStations = {"station_1"};
+    BOOST_REQUIRE(nw.ApplyDelta(reopen, changes));
+    BOOST_CHECK(!nw.IsStationClosed("station_1"));
+    BOOST_CHECK(changes.stations == std::vector<Id>({"station_1"}));
+    BOOST_CHECK_EQUAL(
+        nw.GetFastestTravelRoute("station_0", "station_2").steps.size(), 2
+    );
+}
+
+BOOST_AUTO_TEST_CASE(invalid_delta)
+{
+    auto nw {GetDeltaTestNetwork()};
+
+    // Each delta has a valid travel time, which must not be applied.
+    std::vector<NetworkLayoutDelta> deltas(6);
+    deltas[0].addedStations = {{"station_0", "Duplicate"}};
+    deltas[1].addedRoutes = {{
+        "route_1", "inbound", "line_0", "station_2", "station_9",
+        {"station_2", "station_9"},
+    }};
+    deltas[2].addedRoutes = {{
+        "route_0", "inbound", "line_0", "station_2", "station_0",
+        {"station_2", "station_0"},
+    }};
+    deltas[3].addedRoutes = {{
+        "route_1", "inbound", "line_0", "station_2", "station_2",
+        {"station_2"},
+    }};
+    deltas[4].travelTimes = {{"station_0", "station_2", 3}};
+    deltas[5].closedStations = {"station_9"};
+    for (auto& delta: deltas) {
+        delta.travelTimes.push_back({"station_0", "station_1", 7});
+        NetworkLayoutChanges changes {};
+        BOOST_CHECK(!nw.ApplyDelta(delta, changes));
+    }
+    BOOST_CHECK_EQUAL(nw.GetNStations(), 3);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_1"), 1);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_2").size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(from_json)
+{
+    auto nw {GetDeltaTestNetwork()};
+    auto delta = nlohmann::json::parse(R"({
+        "stations": [
+            {"station_id": "station_3", "name": "Station 3 Name"}
+        ],
+        "routes": [
+            {
+                "line_id": "line_0",
+                "route_id": "route_1",
+                "direction": "outbound",
+                "start_station_id": "station_3",
+                "end_station_id": "station_0",
+                "route_stops": ["station_3", "station_0"]
+            }
+        ],
+        "travel_times": [
+            {
+                "start_station_id": "station_3",
+                "end_station_id": "station_0",
+                "travel_time": 6
+            }
+        ],
+        "closed_stations": ["station_2"]
+    })").get<NetworkLayoutDelta>();
+    BOOST_CHECK_EQUAL(delta.addedStations.size(), 1);
+    BOOST_CHECK_EQUAL(delta.addedLines.size(), 0);
+    BOOST_CHECK_EQUAL(delta.addedRoutes.size(), 1);
+    BOOST_CHECK_EQUAL(delta.reopenedStations.size(), 0);
+    NetworkLayoutChanges changes {};
+    BOOST_REQUIRE(nw.ApplyDelta(delta, changes));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_3"), 6);
+    BOOST_CHECK(nw.IsStationClosed("station_2"));
+    BOOST_CHECK(changes.stations == std::vector<Id>({
+        "station_0", "station_2", "station_3"
+    }));
+    BOOST_CHECK(changes.routes == std::vector<Id>({"route_0", "route_1"}));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // ApplyDelta
+
 BOOST_AUTO_TEST_SUITE(Routes);
 
 static std::pair<TransportNetwork, TravelRoute> GetTestNetwork(
@@ -113,6 +113,12 @@ void MockWebSocketClient::Send(
     }
 }
 
+void MockWebSocketClient::ReleaseBuffer(
+    std::string&& buffer
+)
+{
+}
+
 void MockWebSocketClient::Close(
     std::function<void (boost::system::error_code)> onClose
 )
@@ -226,8 +232,10 @@ std::string MockWebSocketClientForStomp::GetMockSendFrame(
         messageContent
     };
     if (error != StompError::kOk) {
-        throw std::runtime_error("Unexpected: Invalid mock STOMP frame: " +
-                                 ToString(error));
+        throw std::runtime_error(fmt::format(
+            "Unexpected: Invalid mock STOMP frame: {}",
+            error
+        ));
     }
     return frame.ToString();
 }
@@ -246,8 +254,10 @@ StompFrame MockWebSocketClientForStomp::MakeConnectedFrame()
         }
     };
     if (error != StompError::kOk) {
-        throw std::runtime_error("Unexpected: Invalid mock STOMP frame: " +
-                                 ToString(error));
+        throw std::runtime_error(fmt::format(
+            "Unexpected: Invalid mock STOMP frame: {}",
+            error
+        ));
     }
     return frame;
 }
@@ -265,8 +275,10 @@ StompFrame MockWebSocketClientForStomp::MakeReceiptFrame(
         }
     };
     if (error != StompError::kOk) {
-        throw std::runtime_error("Unexpected: Invalid mock STOMP frame: " +
-                                 ToString(error));
+        throw std::runtime_error(fmt::format(
+            "Unexpected: Invalid mock STOMP frame: {}",
+            error
+        ));
     }
     return frame;
 }
@@ -287,8 +299,10 @@ StompFrame MockWebSocketClientForStomp::MakeErrorFrame(
         msg
     };
     if (error != StompError::kOk) {
-        throw std::runtime_error("Unexpected: Invalid mock STOMP frame: " +
-                                 ToString(error));
+        throw std::runtime_error(fmt::format(
+            "Unexpected: Invalid mock STOMP frame: {}",
+            error
+        ));
     }
     return frame;
 }
@@ -316,8 +330,10 @@ StompFrame MockWebSocketClientForStomp::MakeMessageFrame(
         message
     };
     if (error != StompError::kOk) {
-        throw std::runtime_error("Unexpected: Invalid mock STOMP frame: " +
-                                 ToString(error));
+        throw std::runtime_error(fmt::format(
+            "Unexpected: Invalid mock STOMP frame: {}",
+            error
+        ));
     }
     return frame;
 }
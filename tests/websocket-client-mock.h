@@ -62,6 +62,12 @@ public:
         std::function<void (boost::system::error_code)> onSend = nullptr
     );
 
+    /*! \brief Mock buffer release. The buffer is dropped.
+     */
+    void ReleaseBuffer(
+        std::string&& buffer
+    );
+
     /*! \brief Mock close.
      */
     void Close(
@@ -39,8 +39,10 @@ std::string NetworkMonitor::GetMockStompFrame(
         }
     };
     if (error != StompError::kOk) {
-        throw std::runtime_error("Unexpected: Invalid mock STOMP frame: " +
-                                 ToString(error));
+        throw std::runtime_error(fmt::format(
+            "Unexpected: Invalid mock STOMP frame: {}",
+            error
+        ));
     }
     return frame.ToString();
 }
@@ -64,8 +66,10 @@ std::string NetworkMonitor::GetMockSendFrame(
         payload
     };
     if (error != StompError::kOk) {
-        throw std::runtime_error("Unexpected: Invalid mock STOMP frame: " +
-                                 ToString(error));
+        throw std::runtime_error(fmt::format(
+            "Unexpected: Invalid mock STOMP frame: {}",
+            error
+        ));
     }
     return frame.ToString();
 }
@@ -100,6 +104,12 @@ void MockWebSocketSession::Send(
     }
 }
 
+void MockWebSocketSession::ReleaseBuffer(
+    std::string&& buffer
+)
+{
+}
+
 void MockWebSocketSession::Close(
     std::function<void (boost::system::error_code)> onClose
 )